@@ -46,6 +46,10 @@ void ConfigParameters::Initialize()
     emptyReadoutLengthADC = 64;
     emptyReadoutLengthADCDual = 40;
 
+    usbReadTransfers = 8;
+    usbReadTransferSize = 16384;
+    rpcProfiling = 0;
+
     dacParametersFileName  = "defaultDACParameters.dat";
     tbmParametersFileName  = "defaultTBMParameters.dat";
     tbParametersFileName   = "defaultTBParameters.dat";
@@ -134,6 +138,11 @@ bool ConfigParameters::ReadConfigParameterFile(const char * _file)
         else if (0 == _name.compare("tbmEnable")) { tbmEnable                 = _ivalue; }
         else if (0 == _name.compare("tbmEmulator")) { tbmEmulator             = _ivalue; }
         else if (0 == _name.compare("tbmChannel")) { tbmChannel                = _ivalue; }
+        else if (0 == _name.compare("usbReadTransfers")) { usbReadTransfers          = _ivalue; }
+        else if (0 == _name.compare("usbReadTransferSize")) { usbReadTransferSize       = _ivalue; }
+        else if (0 == _name.compare("rpcProfiling")) { rpcProfiling              = _ivalue; }
+        else if (0 == _name.compare("rpcRecordFile")) { SetRpcRecordFileName(_value); }
+        else if (0 == _name.compare("rpcCallIdCache")) { SetRpcCallIdCacheFileName(_value); }
 
         else if (0 == _name.compare("ia")) { ia = .001 * _ivalue; }
         else if (0 == _name.compare("id")) { id = .001 * _ivalue; }
@@ -209,6 +218,17 @@ void ConfigParameters::SetMaskFileName(const std::string &_file)
     maskFileName.assign(directory).append("/").append(_file);
 }
 
+void ConfigParameters::SetRpcRecordFileName(const std::string &_file)
+{
+    rpcRecordFileName.assign(directory).append("/").append(_file);
+}
+
+void ConfigParameters::SetRpcCallIdCacheFileName(const std::string &_file)
+{
+    if (_file == "off") rpcCallIdCacheFileName.clear();
+    else rpcCallIdCacheFileName.assign(directory).append("/").append(_file);
+}
+
 bool ConfigParameters::WriteConfigParameterFile()
 {
     char filename[1000];
@@ -265,6 +285,16 @@ bool ConfigParameters::WriteConfigParameterFile()
     fprintf(file, "emptyReadoutLengthADC %i\n", emptyReadoutLengthADC);
     fprintf(file, "emptyReadoutLengthADCDual %i\n", emptyReadoutLengthADCDual);
 
+    fprintf(file, "\n-- usb read engine\n\n");
+
+    fprintf(file, "usbReadTransfers %i\n", usbReadTransfers);
+    fprintf(file, "usbReadTransferSize %i\n", usbReadTransferSize);
+    fprintf(file, "rpcProfiling %i\n", rpcProfiling);
+    if (!rpcRecordFileName.empty())
+        fprintf(file, "rpcRecordFile %s\n", &rpcRecordFileName[strlen(directory) + 1]);
+    if (!rpcCallIdCacheFileName.empty())
+        fprintf(file, "rpcCallIdCache %s\n", &rpcCallIdCacheFileName[strlen(directory) + 1]);
+
     fclose(file);
     return true;
 }
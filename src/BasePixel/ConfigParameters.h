@@ -19,6 +19,8 @@ public:
     int nRocs, nModules, hubId, dataTriggerLevel, halfModule;
     int customModule;
     int emptyReadoutLength, emptyReadoutLengthADC, emptyReadoutLengthADCDual, tbmChannel;
+    int usbReadTransfers, usbReadTransferSize;
+    int rpcProfiling;
     double ia, id, va, vd;
     float rocZeroAnalogCurrent;
     std::string roc_type;
@@ -36,6 +38,8 @@ public:
     const char * GetFlashFileName();
     const char * GetLogFileName();
     const char * GetMaskFileName();
+    const char * GetRpcRecordFileName();
+    const char * GetRpcCallIdCacheFileName();
 
     const std::string GetDebugFileName();
 
@@ -49,6 +53,8 @@ public:
     void SetLogFileName(const std::string &filename);
     void SetDebugFileName(const std::string &filename);
     void SetMaskFileName(const std::string &filename);
+    void SetRpcRecordFileName(const std::string &filename);
+    void SetRpcCallIdCacheFileName(const std::string &filename);
 
 
     // == file input / output ===================================================
@@ -66,6 +72,8 @@ private:
     std::string debugFileName;
     std::string testParametersFileName;
     std::string maskFileName;
+    std::string rpcRecordFileName; // empty: no recording
+    std::string rpcCallIdCacheFileName; // empty: no cache
     std::string flashFileName;
 
     static ConfigParameters * instance;
@@ -80,6 +88,8 @@ inline const char * ConfigParameters::GetRootFileName() { return rootFileName.c_
 inline const char * ConfigParameters::GetFlashFileName() { return flashFileName.c_str(); }
 inline const char * ConfigParameters::GetLogFileName() { return logFileName.c_str(); }
 inline const char * ConfigParameters::GetMaskFileName() { return maskFileName.c_str(); }
+inline const char * ConfigParameters::GetRpcRecordFileName() { return rpcRecordFileName.c_str(); }
+inline const char * ConfigParameters::GetRpcCallIdCacheFileName() { return rpcCallIdCacheFileName.c_str(); }
 
 inline const std::string ConfigParameters::GetDebugFileName() { return debugFileName; }
 
@@ -118,7 +118,7 @@ void DACParameters::SetParameter(int reg, int value, bool correction)
     else correctValue = value;
 
     parameters[reg] = correctValue;
-    roc->RocSetDAC(reg, correctValue);
+    if (!roc->RocSetDAC(reg, correctValue)) return; // unchanged, nothing to wait for
 
     if (reg == 254)  // WBC needs a reset to get active
     {
@@ -0,0 +1,117 @@
+#include "DaqDrain.h"
+#include "pixel_dtb.h"
+
+#include <chrono>
+
+
+CDaqDrain::CDaqDrain(CTestboard & _tb, uint16_t _blockSize, unsigned int _idleWait)
+    : tb(_tb), blockSize(_blockSize), idleWait(_idleWait),
+      stop(false), overflow(false), samples(0), failed(false)
+{
+}
+
+
+CDaqDrain::~CDaqDrain()
+{
+    if (!Running()) return;
+    stop = true;
+    thread.join();
+}
+
+
+void CDaqDrain::Start()
+{
+    if (Running()) return;
+    stop = false;
+    overflow = false;
+    samples = 0;
+    failed = false;
+    data.clear();
+    thread = std::thread(&CDaqDrain::Run, this);
+}
+
+
+void CDaqDrain::Stop()
+{
+    if (!Running()) return;
+    stop = true;
+    thread.join();
+
+    // whatever arrived after the last poll
+    std::vector<uint16_t> block;
+    uint32_t avail;
+    size_t n;
+    do
+    {
+        n = Read(block, avail);
+        Deliver(block, n);
+    } while (avail > 0 && n > 0);
+}
+
+
+// block is only a buffer, reused without clearing; returns the samples read
+size_t CDaqDrain::Read(std::vector<uint16_t> & block, uint32_t & avail)
+{
+    size_t n = 0;
+    avail = 0;
+    if (tb.Daq_ReadAppend(block, n, blockSize, avail) != 0) overflow = true;
+    return n;
+}
+
+
+void CDaqDrain::Deliver(const std::vector<uint16_t> & block, size_t n)
+{
+    if (n == 0) return;
+    std::lock_guard<std::mutex> lock(dataMutex);
+    samples += n;
+    data.insert(data.end(), block.begin(), block.begin() + n);
+    dataReady.notify_all();
+}
+
+
+void CDaqDrain::Run()
+{
+    std::vector<uint16_t> block(blockSize);
+    while (!stop)
+    {
+        uint32_t avail;
+        size_t n;
+        try
+        {
+            n = Read(block, avail);
+        }
+        catch (CRpcError & e)
+        {
+            std::lock_guard<std::mutex> lock(dataMutex);
+            failed = true;
+            error = e;
+            dataReady.notify_all();
+            return;
+        }
+        Deliver(block, n);
+        if (avail == 0) std::this_thread::sleep_for(std::chrono::microseconds(idleWait));
+    }
+}
+
+
+size_t CDaqDrain::Take(std::vector<uint16_t> & _data)
+{
+    std::lock_guard<std::mutex> lock(dataMutex);
+    if (failed)
+    {
+        failed = false;
+        throw error;
+    }
+    _data.clear();
+    _data.swap(data);
+    return _data.size();
+}
+
+
+size_t CDaqDrain::WaitFor(size_t n, unsigned int timeout)
+{
+    std::unique_lock<std::mutex> lock(dataMutex);
+    dataReady.wait_for(lock, std::chrono::milliseconds(timeout),
+                       [&] { return data.size() >= n || failed; });
+    return data.size();
+}
@@ -0,0 +1,71 @@
+// Background reader emptying the DTB DAQ buffer while another thread keeps
+// programming the ROCs through the same CTestboard.
+//
+//   tb->Daq_Open(size); tb->Daq_Start();
+//   CDaqDrain drain(*tb);
+//   drain.Start();
+//   for (...) { tb->roc_SetDAC(...); tb->Pg_Single(); ... drain.Take(data); decode(data); }
+//   tb->Daq_Stop();
+//   drain.Stop();      // reads what is left on the board
+//   drain.Take(data);
+//   tb->Daq_Close();
+//
+// The RPC calls of both threads are serialized by CTestboard (RPC_MULTITHREADING),
+// each reply goes to the thread that sent the call. Open/Close/Daq_Open must not
+// be called while the drain is running.
+
+#ifndef DAQDRAIN_H
+#define DAQDRAIN_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+
+#include "interface/rpc_error.h"
+
+class CTestboard;
+
+class CDaqDrain
+{
+public:
+    CDaqDrain(CTestboard & tb, uint16_t blockSize = 32767, unsigned int idleWait = 200);
+    ~CDaqDrain();
+
+    void Start();
+    void Stop();        // ends the thread and reads the rest of the DAQ buffer
+    bool Running() { return thread.joinable(); }
+
+    // moves the collected samples to data (replacing its contents),
+    // returns the number of samples; rethrows a read error of the thread
+    size_t Take(std::vector<uint16_t> & data);
+    // waits until at least n samples are collected or timeout ms passed
+    size_t WaitFor(size_t n, unsigned int timeout);
+
+    bool Overflow() { return overflow; } // the DTB dropped data
+    uint64_t GetSamples() { return samples; }
+
+private:
+    void Run();
+    size_t Read(std::vector<uint16_t> & block, uint32_t & avail);
+    void Deliver(const std::vector<uint16_t> & block, size_t n);
+
+    CTestboard & tb;
+    uint16_t blockSize;
+    unsigned int idleWait;  // us between polls of an empty buffer
+
+    std::thread thread;
+    std::atomic<bool> stop;
+    std::atomic<bool> overflow;
+    std::atomic<uint64_t> samples;
+
+    std::mutex dataMutex;
+    std::condition_variable dataReady;
+    std::vector<uint16_t> data;
+    bool failed;
+    CRpcError error;
+};
+
+#endif
@@ -77,6 +77,12 @@ bool Pixel::IsAlive()
 }
 
 
+bool Pixel::IsMasked()
+{
+    return masked;
+}
+
+
 int Pixel::GetColumn()
 {
     return column;
@@ -25,6 +25,7 @@ public:
     void SetTrim(int trimBit);
     int GetTrim();
     bool IsAlive();
+    bool IsMasked();
     int GetColumn();
     int GetRow();
     void SetAlive(bool aBoolean);
@@ -14,6 +14,8 @@ Roc::Roc(TBInterface * const aTBInterface, const int aChipId, const int aHubId,
         doubleColumn[i] = new DoubleColumn(this, i);
     }
     dacParameters = new DACParameters(this);
+    pixelConfigEpoch = tbInterface->PixelConfigEpoch();
+    for (int i = 0; i < ROCNUMCOLS * ROCNUMROWS; i++) pixelConfig[i] = PixelUnknown;
 
     /* Chip properties */
     analog_readout = false;
@@ -368,9 +370,15 @@ int Roc::RecvRoCnt()
 // -- Disables all double columns and pixels
 void Roc::Mask()
 {
-    for (int i = 0; i < ROCNUMDCOLS; i++)
+    SetChip();
+    GetTBInterface()->RocChipMask();
+    tbInterface->CDelay(50);
+    for (int i = 0; i < ROCNUMCOLS; i++)
     {
-        doubleColumn[i]->Mask();
+        for (int k = 0; k < ROCNUMROWS; k++)
+        {
+            PixelConfig(i, k) = PixelMasked;
+        }
     }
 }
 
@@ -419,15 +427,28 @@ void Roc::EnablePixel(int col, int row)
 }
 
 
+// -- Enables all pixels which are not masked completely. The ROC is addressed
+//    once and only the trims that differ from the chip are sent.
 void Roc::EnableAllPixels()
 {
+    SetChip();
+    for (int i = 0; i < ROCNUMDCOLS; i++)
+    {
+        GetTBInterface()->RocColEnable(i * 2, 1);
+    }
     for (int i = 0; i < ROCNUMCOLS; i++)
     {
         for (int k = 0; k < ROCNUMROWS; k++)
         {
-            EnablePixel(i, k);
+            Pixel * pixel = GetPixel(i, k);
+            if (pixel->IsMasked()) continue;
+            unsigned char & config = PixelConfig(i, k);
+            if (config == pixel->GetTrim()) continue;
+            GetTBInterface()->RocPixTrim(i, k, pixel->GetTrim());
+            config = pixel->GetTrim();
         }
     }
+    tbInterface->CDelay(50);
 }
 
 
@@ -487,6 +508,7 @@ void Roc::PixTrim(int col, int row, int value)
     SetChip();
     GetTBInterface()->RocPixTrim(col, row, value);
     tbInterface->CDelay(50);
+    PixelConfig(col, row) = value;
 }
 
 
@@ -495,6 +517,19 @@ void Roc::PixMask(int col, int row)
     SetChip();
     GetTBInterface()->RocPixMask(col, row);
     tbInterface->CDelay(50);
+    PixelConfig(col, row) = PixelMasked;
+}
+
+
+unsigned char & Roc::PixelConfig(int col, int row)
+{
+    // a scan on the testboard may have changed any pixel
+    if (pixelConfigEpoch != tbInterface->PixelConfigEpoch())
+    {
+        for (int i = 0; i < ROCNUMCOLS * ROCNUMROWS; i++) pixelConfig[i] = PixelUnknown;
+        pixelConfigEpoch = tbInterface->PixelConfigEpoch();
+    }
+    return pixelConfig[col * ROCNUMROWS + row];
 }
 
 
@@ -509,15 +544,14 @@ void Roc::PixCal(int col, int row, int sensorcal)
 void Roc::ColEnable(int col, int on)
 {
     SetChip();
-    GetTBInterface()->RocColEnable(col, on);
-    tbInterface->CDelay(50);
+    if (GetTBInterface()->RocColEnable(col, on)) tbInterface->CDelay(50);
 }
 
 
-void Roc::RocSetDAC(int reg, int value)
+bool Roc::RocSetDAC(int reg, int value)
 {
     SetChip();
-    GetTBInterface()->RocSetDAC(reg, value);
+    return GetTBInterface()->RocSetDAC(reg, value);
 }
 
 
@@ -539,6 +573,18 @@ int Roc::ChipThreshold(int start, int step, int thrLevel, int nTrig, int dacReg,
 }
 
 
+int Roc::ChipThresholdParallel(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int data[])
+{
+    SetChip();
+    Flush();
+    int trim[ROCNUMROWS * ROCNUMCOLS];
+    GetTrimValues(trim);
+    int n = GetTBInterface()->ChipThresholdParallel(start, step, thrLevel, nTrig, dacReg, xtalk, cals, trim, data);
+    RocSetDAC(dacReg, GetDAC(dacReg)); // the sweep leaves the DAC at its last value
+    return n;
+}
+
+
 
 int Roc::PixelThreshold(int col, int row, int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim)
 {
@@ -585,11 +631,11 @@ int Roc::AoutLevelPartOfChip(int position, int nTriggers, int res[], bool pxlFla
 
 
 
-void Roc::DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[])
+void Roc::DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[], double ph[])
 {
     SetChip();
     Flush();
-    GetTBInterface()->DacDac(dac1, dacRange1, dac2, dacRange2, nTrig, result);
+    GetTBInterface()->DacDac(dac1, dacRange1, dac2, dacRange2, nTrig, result, ph);
 }
 
 
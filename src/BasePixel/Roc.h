@@ -73,12 +73,13 @@ public:
     void SetTrim(int trim);
     void DoubleColumnADCData(int doubleColumn, short data[], int readoutStop[]);
     int ChipThreshold(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int data[]);
+    int ChipThresholdParallel(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int data[]);
     int ChipEfficiency(int nTriggers, double res[]);
     int MaskTest(short nTriggers, short res[]);
     int PixelThreshold(int col, int row, int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim);
     int AoutLevelChip(int position, int nTriggers, int res[]);
     int AoutLevelPartOfChip(int position, int nTriggers, int res[], bool pxlFlags[]);
-    void DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[]);
+    void DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[], double ph[] = 0);
     void AddressLevelsTest(int result[]);
     void TrimAboveNoise(short nTrigs, short thr, short mode, short result[]);
 
@@ -89,7 +90,7 @@ public:
     void PixMask(int col, int row);
     void PixCal(int col, int row, int sensorcal);
     void ColEnable(int col, int on);
-    void RocSetDAC(int reg, int value);
+    bool RocSetDAC(int reg, int value); // false if the ROC already had the value
 
     // == DoubleColumn actions ==============================
 
@@ -121,6 +122,13 @@ protected:
     bool row_address_inverted;      /**< Flag that specifies whether the row address is inverted in the readout or not */
     int threshold_autoset_value;    /**< Value used for auto set the threshold, e.g. in the pretest */
 
+    /* Trim or PixelMasked per pixel as last written by PixTrim/PixMask,
+       PixelUnknown after a pixel scan on the testboard */
+    static const unsigned char PixelMasked = 0x80, PixelUnknown = 0xff;
+    unsigned char pixelConfig[ROCNUMCOLS * ROCNUMROWS];
+    unsigned int pixelConfigEpoch;
+    unsigned char & PixelConfig(int col, int row);
+
 };
 
 
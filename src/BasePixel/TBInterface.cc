@@ -2,6 +2,11 @@
 #include <string.h>
 #include <iomanip>
 #include <math.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 #include "BasePixel/TBInterface.h"
 //#include "BasePixel/settings.h"
@@ -12,6 +17,7 @@
 #include "interface/Log.h"
 #include "interface/USBInterface.h"
 #include "interface/Delay.h"
+#include "interface/MtbFile.h"
 
 
 TBInterface::TBInterface()
@@ -19,6 +25,8 @@ TBInterface::TBInterface()
     ChipId = 0;
     TBMpresent = 0;
     HUBaddress = 0;
+    pixelConfigEpoch = 0;
+    currentRoc = 0;
 }
 
 TBInterface::TBInterface(ConfigParameters * configParameters)
@@ -26,6 +34,8 @@ TBInterface::TBInterface(ConfigParameters * configParameters)
     ChipId = 0;
     TBMpresent = 0;
     HUBaddress = 0;
+    pixelConfigEpoch = 0;
+    currentRoc = 0;
 
     Initialize(configParameters);
 }
@@ -47,6 +57,11 @@ void TBInterface::Execute(SysCommand &command)
     else if (command.Keyword("usb")) ShowUSB();
     else if (command.Keyword("upgrade")) UpgradeDTB();
     else if (command.Keyword("clear")) ClearUSB();
+    else if (command.Keyword("profile")) cTestboard->ShowRpcProfile();
+    else if (command.Keyword("profile", "on")) cTestboard->SetRpcProfiling(true);
+    else if (command.Keyword("profile", "off")) cTestboard->SetRpcProfiling(false);
+    else if (command.Keyword("profile", "reset")) cTestboard->ResetRpcProfile();
+    else if (command.Keyword("record", "off")) cTestboard->StopRecording();
     else if (command.Keyword("loop"))   {Intern(rctk_flag);}
     else if (command.Keyword("stop"))   {Single(0);}
     else if (command.Keyword("single")) {Single(rctk_flag);}
@@ -174,6 +189,10 @@ void TBInterface::Initialize(ConfigParameters * configParameters)
     cTestboard = new CTestboard();
     usbId = configParameters->testboardName;
     if (usbId == "*") cTestboard->FindDTB(usbId);
+    cTestboard->SetUsbReadQueue(configParameters->usbReadTransfers, configParameters->usbReadTransferSize);
+    cTestboard->SetRpcProfiling(configParameters->rpcProfiling != 0);
+    cTestboard->SetRecordFile(configParameters->GetRpcRecordFileName());
+    cTestboard->SetCallIdCacheFile(configParameters->GetRpcCallIdCacheFileName());
     if (cTestboard->Open(usbId)) {
       printf("\nDTB %s opened\n", usbId.c_str());
       string info;
@@ -234,6 +253,7 @@ void TBInterface::Initialize(ConfigParameters * configParameters)
     cTestboard->ResetOff();
     cTestboard->Flush();
     cTestboard->Init_Reset();
+    InvalidateShadow();
 
     ReadTBParameterFile(configParameters->GetTbParametersFileName());    //only after power on
 
@@ -340,6 +360,7 @@ int TBInterface::Present()
 void TBInterface::I2cAddr(int id)
 {
     cTestboard->I2cAddr(id);
+    currentRoc = 0;
 }
 
 
@@ -487,6 +508,7 @@ void  TBInterface::Pon()
 {
     cTestboard->Pon();
     cTestboard->Flush();
+    InvalidateShadow();
 }
 
 
@@ -494,6 +516,7 @@ void TBInterface::Poff()
 {
     cTestboard->Poff();
     cTestboard->Flush();
+    InvalidateShadow();
 }
 
 
@@ -540,7 +563,7 @@ void TBInterface::Intern(int mask)
 void TBInterface::Deser160PhaseScan() {
 
   cTestboard->Daq_Open(1000);
-  cTestboard->Pg_SetCmd(0, PG_TOK);
+  cTestboard->Pg_SetSequence(vector<uint16_t>(1, PG_TOK));
 
   vector<uint16_t> data;
 
@@ -621,12 +644,14 @@ void TBInterface::Tbmenable(int on)
 void TBInterface::ModAddr(int hub)
 {
     cTestboard->mod_Addr(hub);
+    currentRoc = 0;
 }
 
 
 void TBInterface::TbmAddr(int hub, int port)
 {
     cTestboard->tbm_Addr(hub, port);
+    currentRoc = 0;
 }
 
 
@@ -666,11 +691,38 @@ bool TBInterface::GetTBMReg(int reg, int &value)
 // == ROC functions ======================================================
 
 
+TBInterface::RocShadow::RocShadow()
+{
+    for (int i = 0; i < 256; i++) dac[i] = -1;
+    for (int i = 0; i < ROCNUMDCOLS; i++) doubleColumn[i] = -1;
+}
+
+
+void TBInterface::InvalidateRegisterShadow()
+{
+    rocShadow.clear();
+    currentRoc = 0;
+}
+
+
+void TBInterface::InvalidateShadow()
+{
+    InvalidateRegisterShadow();
+    pixelConfigEpoch++;
+}
+
+
 void TBInterface::SetChip(int chipId, int hubId, int portId, int aoutChipPosition)
 {
+    int address = (hubId << 16) | (portId << 8) | chipId;
+    if (currentRoc && address == currentAddress && aoutChipPosition == currentAout) return;
+
     cTestboard->tbm_Addr(hubId, portId);
     cTestboard->roc_I2cAddr(chipId);
     cTestboard->SetAoutChipPosition(aoutChipPosition);
+    currentRoc = &rocShadow[address];
+    currentAddress = address;
+    currentAout = aoutChipPosition;
 }
 
 void TBInterface::RocClrCal()
@@ -679,9 +731,16 @@ void TBInterface::RocClrCal()
 }
 
 
-void TBInterface::RocSetDAC(int reg, int value)
+bool TBInterface::RocSetDAC(int reg, int value)
 {
+    if (currentRoc)
+    {
+        short & dac = currentRoc->dac[reg & 0xff];
+        if (dac == (value & 0xff)) return false;
+        dac = value & 0xff;
+    }
     cTestboard->roc_SetDAC(reg, value);
+    return true;
 }
 
 
@@ -703,9 +762,23 @@ void TBInterface::RocPixCal(int col, int row, int sensorcal)
 }
 
 
-void TBInterface::RocColEnable(int col, int on)
+bool TBInterface::RocColEnable(int col, int on)
 {
+    if (currentRoc && col >= 0 && col < ROCNUMCOLS)
+    {
+        signed char & enabled = currentRoc->doubleColumn[col / 2];
+        if (enabled == (on != 0)) return false;
+        enabled = (on != 0);
+    }
     cTestboard->roc_Col_Enable(col, on);
+    return true;
+}
+
+
+void TBInterface::RocChipMask()
+{
+    cTestboard->roc_Chip_Mask(); // also disables all columns
+    if (currentRoc) for (int i = 0; i < ROCNUMDCOLS; i++) currentRoc->doubleColumn[i] = 0;
 }
 
 
@@ -1091,6 +1164,7 @@ double TBInterface::GetID()
 void TBInterface::ResetOn()
 {
     cTestboard->ResetOn();
+    InvalidateShadow();
 }
 
 
@@ -1147,6 +1221,150 @@ bool TBInterface::Mem_ReadOut(FILE * f, unsigned int addr, unsigned int size) {
     cTestboard->MemRead(start, rest, buffer);
     fwrite(buffer, rest, 1, f);
     Clear();
+    return true;
+}
+
+
+// Writes the blocks of Mem_ReadOutAsync on its own thread, to a file or
+// a container. The written blocks are handed back for the next MemRead, so
+// no memory is allocated once all buffers are in use.
+class CMemWriter
+{
+    FILE * m_file;
+    CMtbWriter * m_mtb;
+    unsigned int m_maxQueued;
+    std::deque< vector<unsigned char> > m_queue, m_free;
+    unsigned int m_written;
+    bool m_done, m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::thread m_thread;
+
+    void Run()
+    {
+        vector<unsigned char> block;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!block.empty())
+                {
+                    m_written += block.size();
+                    block.clear();
+                    m_free.push_back(vector<unsigned char>());
+                    m_free.back().swap(block);
+                }
+                m_changed.wait(lock, [this] { return m_done || !m_queue.empty(); });
+                if (m_queue.empty()) break;
+                block.swap(m_queue.front());
+                m_queue.pop_front();
+                m_changed.notify_all();
+            }
+            if (m_mtb) m_mtb->Write(&block[0], block.size());
+            else if (!m_error && fwrite(&block[0], block.size(), 1, m_file) != 1) m_error = true;
+        }
+    }
+public:
+    // nBuffers counts the block being read as well
+    CMemWriter(FILE * file, CMtbWriter * mtb, int nBuffers)
+        : m_file(file), m_mtb(mtb), m_maxQueued(nBuffers > 2 ? nBuffers - 1 : 1), m_written(0),
+          m_done(false), m_error(false), m_thread(&CMemWriter::Run, this) {}
+    ~CMemWriter() { Finish(); }
+
+    // an empty block, with the memory of a written one if there is any
+    void GetBlock(vector<unsigned char> &block)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty()) return;
+        block.swap(m_free.front());
+        m_free.pop_front();
+    }
+
+    // hands block over to the thread, leaves it empty
+    void Push(vector<unsigned char> &block)
+    {
+        if (block.empty()) return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this] { return m_queue.size() < m_maxQueued; });
+        m_queue.push_back(vector<unsigned char>());
+        m_queue.back().swap(block);
+        m_changed.notify_all();
+    }
+
+    unsigned int Written()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    // writes the rest and ends the thread, false after a write error
+    bool Finish()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done = true;
+                m_changed.notify_all();
+            }
+            m_thread.join();
+        }
+        return !m_error;
+    }
+};
+
+
+// ----------------------------------------------------------------------
+bool TBInterface::Mem_ReadOutAsync(FILE * f, unsigned int addr, unsigned int size,
+                                   unsigned short blockSize, int nBuffers,
+                                   MemReadOutProgress progress, void * user)
+{
+    CMemWriter writer(f, 0, nBuffers);
+    return MemReadBlocks(writer, addr, size, blockSize, progress, user);
+}
+
+
+bool TBInterface::Mem_ReadOutAsync(CMtbWriter & mtb, unsigned int addr, unsigned int size,
+                                   unsigned short blockSize, int nBuffers,
+                                   MemReadOutProgress progress, void * user)
+{
+    CMemWriter writer(0, &mtb, nBuffers);
+    return MemReadBlocks(writer, addr, size, blockSize, progress, user);
+}
+
+
+bool TBInterface::MemReadBlocks(CMemWriter & writer, unsigned int addr, unsigned int size,
+                                unsigned short blockSize,
+                                MemReadOutProgress progress, void * user)
+{
+    typedef std::chrono::steady_clock clock;
+
+    if (blockSize == 0) blockSize = 50000;
+    unsigned int bytes = 2 * size;
+
+    Flush();
+    Clear();
+    vector<unsigned char> block;
+    clock::time_point lastProgress = clock::now();
+    for (unsigned int done = 0; done < bytes; )
+    {
+        unsigned short n = bytes - done < blockSize ? bytes - done : blockSize;
+        writer.GetBlock(block);
+        block.resize(n);
+        cTestboard->MemRead(addr + done, n, &block[0]);
+        writer.Push(block);
+        done += n;
+
+        if (progress && clock::now() - lastProgress >= std::chrono::milliseconds(500))
+        {
+            progress(writer.Written(), bytes, user);
+            lastProgress = clock::now();
+        }
+    }
+    bool ok = writer.Finish();
+    Clear();
+    if (progress) progress(writer.Written(), bytes, user);
+    return ok;
 }
 
 
@@ -1220,20 +1438,33 @@ void TBInterface::DoubleColumnADCData(int doubleColumn, short data[], int readou
 int TBInterface::ChipThreshold(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim[], int res[])
 {
     DataEnable(false);
+    InvalidateShadow();
     int n =  cTestboard->ChipThreshold(start, step, thrLevel, nTrig, dacReg, xtalk, cals, trim, res);
     DataEnable(true);
     return n;
 }
 
 
+int TBInterface::ChipThresholdParallel(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim[], int res[])
+{
+    DataEnable(false);
+    InvalidateShadow();
+    int n =  cTestboard->ChipThresholdParallel(start, step, thrLevel, nTrig, dacReg, xtalk, cals, trim, res);
+    DataEnable(true);
+    return n;
+}
+
+
 int TBInterface::AoutLevelChip(int position, int nTriggers, int trims[], int res[])
 {
+    InvalidateShadow();
     return cTestboard->AoutLevelChip(position, nTriggers, trims, res);
 }
 
 
 int TBInterface::AoutLevelPartOfChip(int position, int nTriggers, int trims[], int res[], bool pxlFlags[])
 {
+    InvalidateShadow();
     return cTestboard->AoutLevelPartOfChip(position, nTriggers, trims, res, pxlFlags);
 }
 
@@ -1241,15 +1472,27 @@ int TBInterface::AoutLevelPartOfChip(int position, int nTriggers, int trims[], i
 int TBInterface::ChipEfficiency(int nTriggers, int trim[], double res[])
 {
     DataEnable(false);
+    InvalidateShadow();
     int n = cTestboard->ChipEfficiency(nTriggers, trim, res);
     DataEnable(true);
     return n;
 }
 
 
+int TBInterface::ModuleEfficiency(int nTriggers, int nRocs, int chipId[], int trim[], double res[], double ph[])
+{
+    DataEnable(false);
+    InvalidateShadow();
+    int n = cTestboard->ModuleEfficiency(nTriggers, nRocs, chipId, trim, res, ph);
+    DataEnable(true);
+    return n;
+}
+
+
 int TBInterface::MaskTest(short nTriggers, short res[])
 {
     DataEnable(false);
+    InvalidateShadow();
     int n = cTestboard->MaskTest(nTriggers, res);
     DataEnable(true);
     return n;
@@ -1260,6 +1503,7 @@ int TBInterface::MaskTest(short nTriggers, short res[])
 int TBInterface::PixelThreshold(int col, int row, int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim)
 {
     DataEnable(false);
+    InvalidateShadow();
     int n = cTestboard->PixelThreshold(col, row, start, step, thrLevel, nTrig, dacReg, xtalk, cals, trim);
     DataEnable(true);
     return n;
@@ -1269,16 +1513,18 @@ int TBInterface::PixelThreshold(int col, int row, int start, int step, int thrLe
 int TBInterface::SCurve(int nTrig, int dacReg, int threshold, int res[])
 {
     DataEnable(false);
+    InvalidateRegisterShadow();
     int n = cTestboard->SCurve(nTrig, dacReg, threshold, res);
     DataEnable(true);
     return n;
 }
 
 
-int TBInterface::SCurveColumn(int column, int nTrig, int dacReg, int thr[], int trims[], int chipId[], int res[])
+int TBInterface::SCurveColumn(int column, int nTrig, int dacReg, int nRocs, int thr[], int trims[], int chipId[], int res[])
 {
     DataEnable(false);
-    int n = cTestboard->SCurveColumn(column, nTrig, dacReg, thr, trims, chipId, res);
+    InvalidateShadow();
+    int n = cTestboard->SCurveColumn(column, nTrig, dacReg, nRocs, thr, trims, chipId, res);
     DataEnable(true);
     return n;
 }
@@ -1346,25 +1592,29 @@ void TBInterface::ADCRead_digital(short buffer[], unsigned short &bitsread, shor
 }
 
 
-void TBInterface::DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[])
+void TBInterface::DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[], double ph[])
 {
     DataEnable(false);
-    cTestboard->DacDac(dac1, dacRange1, dac2, dacRange2, nTrig, result);
+    InvalidateRegisterShadow();
+    cTestboard->DacDac(dac1, dacRange1, dac2, dacRange2, nTrig, result, ph);
     DataEnable(true);
 }
 
 int TBInterface::PH(int col, int row, int trim, int nTrig)
 {
+    InvalidateShadow();
     return cTestboard->PH(col, row, trim, nTrig);
 }
 
 void TBInterface::PHDac(int dac, int dacRange, int nTrig, int position, short result[])
 {
+    InvalidateRegisterShadow();
     cTestboard->PHDac(dac, dacRange, nTrig, position, result);
 }
 
 bool TBInterface::test_pixel_address(int col, int row)
 {
+    InvalidateShadow();
     return cTestboard->test_pixel_address(col, row);
 }
 
@@ -1383,6 +1633,7 @@ void TBInterface::TBMAddressLevels(int result[])
 void TBInterface::TrimAboveNoise(short nTrigs, short thr, short mode, short result[])
 {
     DataEnable(false);
+    InvalidateShadow();
     cTestboard->TrimAboveNoise(nTrigs, thr, mode, result);
     DataEnable(true);
 }
@@ -1405,6 +1656,7 @@ void TBInterface::ScanAdac(unsigned short chip, unsigned char dac,
                                  unsigned char rep, unsigned int usDelay, unsigned char res[])
 {
     DataEnable(false);
+    InvalidateRegisterShadow();
     cTestboard->ScanAdac(chip, dac, min, max, step, rep, usDelay, res);
     DataEnable(true);
 }
@@ -1413,6 +1665,7 @@ void TBInterface::CdVc(unsigned short chip, unsigned char wbcmin, unsigned char
                              unsigned char cdinit, unsigned short &lres, unsigned short res[])
 {
     DataEnable(false);
+    InvalidateRegisterShadow();
     cTestboard->CdVc(chip, wbcmin, wbcmax, vcalstep, cdinit, lres, res);
     DataEnable(true);
 }
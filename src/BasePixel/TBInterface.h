@@ -4,10 +4,16 @@
 #ifndef TBINTERFACE
 #define TBINTERFACE
 
+#include <map>
+
 #include "SysCommand.h"
 #include "TBParameters.h"
 #include "BasePixel/ConfigParameters.h"
 #include "BasePixel/pixel_dtb.h"
+#include "BasePixel/GlobalConstants.h"
+
+class CMtbWriter;
+class CMemWriter;
 
 class TBInterface
 {
@@ -114,6 +120,17 @@ public:
     int CountADCReadouts(int count);
 
     bool Mem_ReadOut(FILE * file, unsigned int addr, unsigned int size);
+    // Mem_ReadOut with nBuffers blocks in flight, a writer thread does the
+    // file I/O while the next block is read. progress gets the bytes written
+    // and the total, at most every half second and once at the end.
+    typedef void (*MemReadOutProgress)(unsigned int done, unsigned int total, void * user);
+    bool Mem_ReadOutAsync(FILE * file, unsigned int addr, unsigned int size,
+                          unsigned short blockSize = 50000, int nBuffers = 3,
+                          MemReadOutProgress progress = 0, void * user = 0);
+    // the same into a compressed container (interface/MtbFile.h)
+    bool Mem_ReadOutAsync(CMtbWriter & mtb, unsigned int addr, unsigned int size,
+                          unsigned short blockSize = 50000, int nBuffers = 3,
+                          MemReadOutProgress progress = 0, void * user = 0);
 
     void SetReg41();
 
@@ -135,13 +152,23 @@ public:
 
     // == ROC functions ======================================================
 
+    // SetChip, RocSetDAC and RocColEnable leave out what the addressed ROC
+    // was already told, the latter two return false for a skipped write
     void SetChip(int chipId, int hubId, int portId, int aoutChipPosition);
     void RocClrCal();
-    void RocSetDAC(int reg, int value);
+    bool RocSetDAC(int reg, int value);
     void RocPixTrim(int col, int row, int value);
     void RocPixMask(int col, int row);
     void RocPixCal(int col, int row, int sensorcal);
-    void RocColEnable(int col, int on);
+    bool RocColEnable(int col, int on);
+    void RocChipMask();
+
+    // counts the scans that program pixels on the testboard, the trims
+    // and masks Roc remembers are void when it has changed
+    unsigned int PixelConfigEpoch() { return pixelConfigEpoch; }
+    // forgets the address, DACs, column enables and pixel configuration
+    // sent so far, after a power cycle, a reset or direct use of the testboard
+    void InvalidateShadow();
 
 
     // == High Level functions ================================================
@@ -149,13 +176,17 @@ public:
     int AoutLevelChip(int position, int nTriggers, int trims[], int res[]);
     int AoutLevelPartOfChip(int position, int nTriggers, int trims[], int res[], bool pxlFlags[]);
     int ChipEfficiency(int nTriggers, int trim[], double res[]);
+    // nRocs readout positions, chipId[], trim, res and ph by readout position
+    int ModuleEfficiency(int nTriggers, int nRocs, int chipId[], int trim[], double res[], double ph[]);
     int MaskTest(short nTriggers, short res[]);
     void DoubleColumnADCData(int doubleColumn, short data[], int readoutStop[]);
     int ChipThreshold(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim[], int res[]);
+    int ChipThresholdParallel(int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim[], int res[]);
     int PixelThreshold(int col, int row, int start, int step, int thrLevel, int nTrig, int dacReg, int xtalk, int cals, int trim);
     int SCurve(int nTrig, int dacReg, int threshold, int res[]);
-    int SCurveColumn(int column, int nTrig, int dacReg, int thr[], int trims[], int chipId[], int res[]);
-    void DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[]);
+    // nRocs readout positions, chipId[], thr, trims and res by readout position
+    int SCurveColumn(int column, int nTrig, int dacReg, int nRocs, int thr[], int trims[], int chipId[], int res[]);
+    void DacDac(int dac1, int dacRange1, int dac2, int dacRange2, int nTrig, int result[], double ph[] = 0);
     int PH(int col, int row, int trim, int nTrig);
     void PHDac(int dac, int dacRange, int nTrig, int position, short result[]);
     bool test_pixel_address(int col, int row);
@@ -184,6 +215,19 @@ protected:
     int ChipId;
     int TBMpresent;
     int HUBaddress;
+    unsigned int pixelConfigEpoch;
+
+    // registers as last written per ROC, -1 if unknown
+    struct RocShadow
+    {
+        short dac[256];
+        signed char doubleColumn[ROCNUMDCOLS];
+        RocShadow();
+    };
+    std::map<int, RocShadow> rocShadow; // by hub, port and chip id
+    RocShadow * currentRoc;             // addressed by SetChip, 0 if unknown
+    int currentAddress, currentAout;
+    void InvalidateRegisterShadow();    // for scans that leave the pixels alone
 
     TBParameters * tbParameters;
     TBParameters * savedTBParameters;
@@ -204,6 +248,8 @@ private:
     int dataBuffer[bufferSize];
     int signalCounter, readPosition, writePosition;
     void ReadBackData();
+    bool MemReadBlocks(CMemWriter & writer, unsigned int addr, unsigned int size,
+                       unsigned short blockSize, MemReadOutProgress progress, void * user);
 
     int triggerSource;  // 0 = local, 1 = extern
 
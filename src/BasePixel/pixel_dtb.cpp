@@ -1,7 +1,15 @@
 // psi46_tb.cpp
 #include "pixel_dtb.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include "interface/analyzer.h"
+#include "interface/rpc_cache.h"
 #ifndef _WIN32
 #include <unistd.h>
 #include <iostream>
@@ -107,21 +115,196 @@ bool CTestboard::FindDTB(string &usbId)
 bool CTestboard::Open(string &usbId, bool init)
 {
 	rpc_Clear();
-	if (!usb.Open(&(usbId[0]))) return false;
+	if (usbId.compare(0, 8, "emulator") == 0)
+	{
+		rpc_io = link = &emulator;
+		if (!emulator.Open(usbId.c_str())) return false;
+	}
+	else if (usbId.compare(0, 7, "replay:") == 0)
+	{
+		rpc_io = link = &replay;
+		if (!replay.Open(usbId.c_str() + 7)) return false;
+	}
+	else
+	{
+		rpc_io = link = &usb;
+		if (!usb.Open(&(usbId[0]))) return false;
+	}
+
+	if (!recordFile.empty())
+	{
+		if (recorder.Start(recordFile.c_str(), *link, usbId.c_str())) rpc_io = &recorder;
+		else printf("RPC recording: %s\n", recorder.GetErrorMsg());
+	}
+
+	try
+	{
+		ResolveRpcCalls();
+	}
+	catch (CRpcError &e)
+	{
+		// left to the calls themselves
+		e.What();
+		printf("RPC call ids could not be resolved at connect\n");
+		rpc_Clear();
+	}
 
 	if (init) Init();
 	return true;
 }
 
 
+// Sends one GetRpcCallId request per command without waiting, all
+// replies come back in a single round trip.
+void CTestboard::ResolveRpcCallIds(const vector<uint16_t> &cmd)
+{
+	vector< rpcFuture<int32_t> > id(cmd.size());
+	for (unsigned int i = 0; i < cmd.size(); i++)
+	{
+		string name(rpc_cmdName[cmd[i]]);
+		id[i] = GetRpcCallId_Async(name);
+	}
+	for (unsigned int i = 0; i < cmd.size(); i++)
+	{
+		int32_t x = id[i].Get();
+		rpc_cmdId[cmd[i]] = x >= 0 ? x : RPC_CMD_MISSING;
+	}
+}
+
+
+// Fills the call id table before the first command. Ids of known firmware
+// come from the cache file, keyed by firmware version and RPC timestamp,
+// the rest is resolved in one batch. The cache is not used with the
+// emulator, nor while recording or replaying, so that a session file
+// always holds the complete exchange.
+void CTestboard::ResolveRpcCalls()
+{
+	static const uint16_t cmdTimestamp = rpc_CmdIndex("GetRpcTimestamp$v4c");
+	static const uint16_t cmdFWVersion = rpc_CmdIndex("GetFWVersion$S");
+
+	CRpcCallIdCache cache;
+	string timestamp;
+	uint16_t fwVersion = 0;
+	bool cached = !callIdCacheFile.empty() && rpc_io == &usb;
+	if (cached)
+	{
+		vector<uint16_t> key;
+		key.push_back(cmdTimestamp);
+		key.push_back(cmdFWVersion);
+		ResolveRpcCallIds(key);
+		cached = rpc_cmdId[cmdTimestamp] >= 0 && rpc_cmdId[cmdFWVersion] >= 0;
+	}
+	if (cached)
+	{
+		GetRpcTimestamp_Async(timestamp);
+		fwVersion = GetFWVersion();
+		for (unsigned int i = 0; i < timestamp.size(); i++)
+			if ((unsigned char)(timestamp[i]) < ' ') timestamp[i] = ' ';
+		cached = !timestamp.empty();
+	}
+
+	vector<uint16_t> cmd;
+	if (cached) cache.Load(callIdCacheFile.c_str());
+	for (uint16_t i = 2; i < rpc_cmdListSize; i++)
+	{
+		if (rpc_cmdId[i] != -1) continue;
+		int32_t id;
+		if (cached && cache.Get(fwVersion, timestamp, rpc_cmdName[i], id))
+			rpc_cmdId[i] = id >= 0 ? id : RPC_CMD_MISSING;
+		else cmd.push_back(i);
+	}
+	ResolveRpcCallIds(cmd);
+
+	unsigned int nMissing = 0;
+	for (uint16_t i = 0; i < rpc_cmdListSize; i++)
+	{
+		if (cached) cache.Put(fwVersion, timestamp, rpc_cmdName[i],
+			rpc_cmdId[i] == RPC_CMD_MISSING ? -1 : rpc_cmdId[i]);
+		if (rpc_cmdId[i] != RPC_CMD_MISSING) continue;
+		if (nMissing++ == 0)
+			printf("WARNING: the DTB firmware doesn't provide the following calls, please update it:\n");
+		string name(rpc_cmdName[i]), pretty;
+		rpc_TranslateCallName(name, pretty);
+		printf("  %s\n", pretty.c_str());
+	}
+	if (cached && !cache.Save())
+		printf("RPC call id cache %s could not be written\n", callIdCacheFile.c_str());
+}
+
+
 void CTestboard::Close()
 {
 //	if (usb.Connected()) Daq_Close();
-	usb.Close();
+	recorder.Stop();
+	link->Close();
+	rpc_io = link = &usb;
 	rpc_Clear();
 }
 
 
+bool CTestboard::IsConnected()
+{
+	if (link == &emulator) return emulator.Connected();
+	if (link == &replay) return replay.Connected();
+	return usb.Connected();
+}
+
+
+const char * CTestboard::ConnectionError()
+{
+	if (link == &emulator) return emulator.GetErrorMsg();
+	if (link == &replay) return replay.GetErrorMsg();
+	return usb.GetErrorMsg(usb.GetLastError());
+}
+
+
+bool CTestboard::ShowUSB()
+{
+	if (recorder.Recording()) printf("recording RPC session\n");
+	if (link == &emulator) return emulator.Show();
+	if (link == &replay) return replay.Show();
+	return usb.Show();
+}
+
+
+void CTestboard::StopRecording()
+{
+	if (rpc_io != &recorder) return;
+	rpc_Sync();
+	recorder.Stop();
+	rpc_io = link;
+}
+
+
+// the Daq_Read$C2SS0I stub from rpc_calls.cpp receiving into data[size] and up
+uint8_t CTestboard::Daq_ReadAppend(vector<uint16_t> &data, size_t &size, uint16_t blocksize, uint32_t &availsize)
+{
+	if (data.size() < size + blocksize)
+		data.resize(std::max(size + blocksize, 2*data.size()));
+	static const uint16_t cmd = rpc_CmdIndex("Daq_Read$C2SS0I");
+	RPC_PROFILING(cmd, true)
+	uint8_t status;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(cmd);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT16(blocksize);
+	msg.Put_UINT32(availsize);
+	msg.Send(*rpc_io);
+	rpc_Sync();
+	msg.Receive(*rpc_io);
+	msg.Check(rpc_clientCallId,5);
+	status = msg.Get_UINT8();
+	availsize = msg.Get_UINT32();
+	size += rpc_Receive(*rpc_io, &data[size], data.size() - size);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { e.SetFunction(cmd); throw; };
+	return status;
+}
+
+
+// the lock is only held for the flush, not while sleeping
 void CTestboard::mDelay(uint16_t ms)
 {
 	Flush();
@@ -213,120 +396,313 @@ int32_t CTestboard::MaskTest(int16_t nTriggers, int16_t res[])
 
 // --- analyze data --------------------------------------------------------
     // for each col, for each row, (masked pixel, unmasked pixel)
-    PixelReadoutData pix;
-    int pos = 0;
+    PixelHitList hits;
+    DecodeReadouts(data, hits);
     cout << "analyze mask test" << endl;
-    try
+    // one readout per pixel in the order of res, must be empty
+    unsigned int nPixels = ROC_NUMCOLS*ROC_NUMROWS;
+    for (unsigned int i = 0; i < hits.Events() && i < nPixels; i++) res[i] = 0;
+    for (unsigned int h = 0; h < hits.Hits(); h++)
+        if (hits.event[h] < nPixels) res[hits.event[h]]++;
+    return 1;
+}
+
+// DAQ reads queued behind the commands that produce their data. A reply is
+// taken maxPending reads later, the board goes on with the following
+// commands meanwhile. The replies in flight have to fit in the USB read
+// buffer.
+class CDaqReadQueue
+{
+    CTestboard &m_tb;
+    unsigned int m_maxPending;
+    std::deque< vector<uint16_t> > m_block;
+    std::deque<uint32_t> m_avail;
+    std::deque< rpcFuture<uint8_t> > m_read;
+
+    void Take(vector<uint16_t> &data)
+    {
+        m_read.front().Get();
+        data.insert(data.end(), m_block.front().begin(), m_block.front().end());
+        m_read.pop_front(); m_block.pop_front(); m_avail.pop_front();
+    }
+public:
+    static const uint16_t blockSize = 32767;
+
+    CDaqReadQueue(CTestboard &tb, unsigned int maxPending) : m_tb(tb), m_maxPending(maxPending) {}
+
+    // queues n reads, appends the replies beyond maxPending to data
+    void Read(unsigned int n, vector<uint16_t> &data)
     {
-        for (col=0; col<ROC_NUMCOLS; col++)
+        for (unsigned int i = 0; i < n; i++)
+        {
+            m_block.push_back(vector<uint16_t>());
+            m_avail.push_back(0);
+            m_read.push_back(m_tb.Daq_Read_Async(m_block.back(), blockSize, m_avail.back()));
+        }
+        m_tb.Flush();
+        while (m_read.size() > m_maxPending) Take(data);
+    }
+
+    // appends the outstanding replies and what is left in the DAQ buffer
+    void Finish(vector<uint16_t> &data)
+    {
+        while (!m_read.empty()) Take(data);
+        uint32_t n = 0;
+        size_t size = data.size();
+        do m_tb.Daq_ReadAppend(data, size, blockSize, n); while (n > 0);
+        data.resize(size);
+    }
+};
+
+// Decodes the data of a scan on a thread of its own while the caller goes
+// on reading. Push waits while maxQueued chunks are undecoded, that bounds
+// the memory of long scans. decode gets the undecoded data and removes what
+// it has used, complete is set for the last call.
+class CDecodeWorker
+{
+    std::function<void(vector<uint16_t>&, bool)> m_decode;
+    unsigned int m_maxQueued;
+    std::deque< vector<uint16_t> > m_queue;
+    bool m_done;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::thread m_thread;
+
+    void Run()
+    {
+        vector<uint16_t> data, chunk;
+        while (true)
         {
-            for (row=0; row<ROC_NUMROWS; row++)
             {
-                // must be empty readout
-                DecodePixel(data, pos, pix);
-                res[(int)row+((int)col*(int)ROC_NUMROWS)]=pix.n;
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this] { return m_done || !m_queue.empty(); });
+                if (m_queue.empty()) break;
+                chunk.swap(m_queue.front());
+                m_queue.pop_front();
+                m_changed.notify_all();
             }
+            data.insert(data.end(), chunk.begin(), chunk.end());
+            chunk.clear();
+            m_decode(data, false);
         }
-    } catch (int) {}
-    return 1;
+        m_decode(data, true);
+    }
+public:
+    CDecodeWorker(std::function<void(vector<uint16_t>&, bool)> decode, unsigned int maxQueued)
+        : m_decode(decode), m_maxQueued(maxQueued), m_done(false), m_thread(&CDecodeWorker::Run, this) {}
+    ~CDecodeWorker() { Finish(); }
+
+    // hands data over to the thread, leaves it empty
+    void Push(vector<uint16_t> &data)
+    {
+        if (data.empty()) return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this] { return m_queue.size() < m_maxQueued; });
+        m_queue.push_back(vector<uint16_t>());
+        m_queue.back().swap(data);
+        m_changed.notify_all();
+    }
+
+    // decodes the rest and ends the thread
+    void Finish()
+    {
+        if (!m_thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+            m_changed.notify_all();
+        }
+        m_thread.join();
+    }
+};
+
+// Counts the hits of the armed pixel in the readouts of data and removes the
+// decoded samples from it. Readout e is trigger e of the scan, it belongs to
+// pixel e / nTriggers in col*ROC_NUMROWS+row order. With more than one chip
+// nHits holds the counts of each readout position one after the other.
+static void CountArmedPixelHits(vector<uint16_t> &data, bool complete, int16_t nTriggers, int nChips,
+    PixelHitList &hits, uint32_t &events, vector<int> &nHits, vector<int> &phSum)
+{
+    const uint32_t nPixels = ROC_NUMCOLS*ROC_NUMROWS;
+    hits.Clear();
+    size_t n = data.empty() ? 0 : DecodeReadouts(&data[0], data.size(), hits, complete);
+    data.erase(data.begin(), data.begin() + n);
+
+    vector<uint32_t> lastEvent(nChips, ~0u);
+    for (unsigned int h = 0; h < hits.Hits(); h++)
+    {
+        uint32_t event = events + hits.event[h];
+        uint32_t pixel = event / nTriggers;
+        int k = nChips > 1 ? hits.roc[h] : 0;
+        if (pixel >= nPixels || k >= nChips || event == lastEvent[k] || hits.flags[h]
+            || hits.col[h] != pixel / ROC_NUMROWS || hits.row[h] != pixel % ROC_NUMROWS) continue;
+        nHits[k*nPixels + pixel]++;
+        phSum[k*nPixels + pixel] += hits.ph[h];
+        lastEvent[k] = event;
+    }
+    events += hits.Events();
 }
 
 int32_t CTestboard::ChipEfficiency(int16_t nTriggers, int32_t trim[], double res[])
 { 
+    return PixelEfficiency(nTriggers, 1, 0, trim, res, 0);
+}
+
+int32_t CTestboard::ModuleEfficiency(int16_t nTriggers, int32_t nChips, int32_t chipId[], int32_t trim[], double res[], double ph[])
+{
+    return PixelEfficiency(nTriggers, nChips, chipId, trim, res, ph);
+}
+
+// Efficiency and mean pulse height of every pixel of nChips ROCs. The same
+// pixel is armed on all of them and read out with the same triggers, the
+// hits are told apart by the position of their ROC header in the readout.
+// chipId: the ROC at each readout position, -1 for one not tested. Without
+// chipId the addressed ROC is tested alone and its position doesn't matter.
+// trim, res, ph: ROC_NUMCOLS*ROC_NUMROWS values per position, ph may be 0.
+int32_t CTestboard::PixelEfficiency(int16_t nTriggers, int32_t nChips, int32_t chipId[],
+    int32_t trim[], double res[], double ph[])
+{
+    // One DAQ session for the whole scan. The reads of a column are queued
+    // behind its triggers, its data is decoded while the testboard pulses
+    // the next column. Data the blocks don't hold is picked up by the next
+    // reads, the board buffer holds about two columns.
+    const int nPixels = ROC_NUMCOLS*ROC_NUMROWS;
+    const int nReads = 1 + ROC_NUMROWS*nTriggers*3*nChips / CDaqReadQueue::blockSize; // a header and a hit per ROC
+    CDaqReadQueue queue(*this, nReads);
+    vector<uint16_t> data;
+    PixelHitList hits;
+    vector<int> nHits(nChips*nPixels, 0), phSum(nChips*nPixels, 0);
+    uint32_t events = 0;
+
+    Daq_Open(500000);
+    Daq_Select_Deser160(deserAdjust);
+    Daq_Start();
+
     // --- scan all pixel ------------------------------------------------------
-    int col, row;
-    PixelReadoutData pix;
-    int nHits = 0;
+    int col, row, k;
     cout << "analyze chip efficiency" << endl;
     for (col=0; col<ROC_NUMCOLS; col++)
     {
-        int pos = 0;
-        Daq_Open(500000);
-        Daq_Select_Deser160(deserAdjust);
-        Daq_Start();
-        roc_Col_Enable(col, true);
+        for (k=0; k<nChips; k++)
+        {
+            if (chipId && chipId[k] < 0) continue;
+            if (chipId) SetChip(chipId[k]);
+            roc_Col_Enable(col, true);
+        }
         for (row=0; row<ROC_NUMROWS; row++)
         {   
-            //roc_Pix_Trim(col, row, 15);
-            roc_Pix_Trim(col, row, trim[(int)row+((int)col*(int)ROC_NUMROWS)]);
-            roc_Pix_Cal(col, row, false);
+            for (k=0; k<nChips; k++)
+            {
+                if (chipId && chipId[k] < 0) continue;
+                if (chipId) SetChip(chipId[k]);
+                //roc_Pix_Trim(col, row, 15);
+                roc_Pix_Trim(col, row, trim[k*nPixels+(int)row+((int)col*(int)ROC_NUMROWS)]);
+                roc_Pix_Cal(col, row, false);
+            }
 			uDelay(20);
-            for (int16_t i=0; i < nTriggers; i++)
+            Pg_Triggers(nTriggers, nChips);
+            for (k=0; k<nChips; k++)
             {
-			    Pg_Single();
+                if (chipId && chipId[k] < 0) continue;
+                if (chipId) SetChip(chipId[k]);
+                roc_Pix_Mask(col, row);
+                roc_ClrCal();
             }
-            roc_Pix_Mask(col, row);
-			roc_ClrCal();
         }
-        roc_Col_Enable(col, false);
-        Daq_Stop();
-
-        vector<uint16_t> data;
-        Daq_Read(data,500000);
-        Daq_Close();
-        try
+        for (k=0; k<nChips; k++)
         {
-            for (row=0; row<ROC_NUMROWS; row++)
-            {
-                // must be nTriggers
-                nHits = 0;
-                for (int16_t i=0; i < nTriggers; i++)
-                {
-                    DecodePixel(data, pos, pix);
-                    if (pix.n > 0) nHits++;
-                }
-                // for each col, for each row, count number of hits and divide by triggers
-                res[(int)row+((int)col*(int)ROC_NUMROWS)]=(double)nHits/nTriggers;
-                //cout << "Pix (" << col << "," << row << "): " << res[(int)row+((int)col*(int)ROC_NUMROWS)] << endl;
-            }
-        } catch (int) {}
+            if (chipId && chipId[k] < 0) continue;
+            if (chipId) SetChip(chipId[k]);
+            roc_Col_Enable(col, false);
+        }
+        // takes the previous column
+        queue.Read(nReads, data);
+        CountArmedPixelHits(data, false, nTriggers, nChips, hits, events, nHits, phSum);
+    }
+    Daq_Stop();
+    queue.Finish(data);
+    Daq_Close();
+    CountArmedPixelHits(data, true, nTriggers, nChips, hits, events, nHits, phSum);
+
+    // for each col, for each row, count number of hits and divide by triggers
+    for (int i = 0; i < nChips*nPixels; i++)
+    {
+        if (chipId && chipId[i / nPixels] < 0) continue;
+        res[i] = (double)nHits[i]/nTriggers;
+        if (ph) ph[i] = nHits[i] ? (double)phSum[i]/nHits[i] : 0;
     }
 
     //roc_SetDAC(CtrlReg,0);
     return 1;
 }
 
-void CTestboard::DacDac(int32_t dac1, int32_t dacRange1, int32_t dac2, int32_t dacRange2, int32_t nTrig, int32_t res[])
+// Counts the readouts with a valid hit per DAC point and removes the
+// decoded samples from data. Readout e belongs to point e / nTrig.
+static void CountDacDacHits(vector<uint16_t> &data, bool complete, int32_t nTrig, uint32_t nPoints,
+    PixelHitList &hits, uint32_t &events, vector<int32_t> &nHits, vector<int32_t> &phSum)
 {
-    Daq_Open(1000000);
+    hits.Clear();
+    size_t n = data.empty() ? 0 : DecodeReadouts(&data[0], data.size(), hits, complete);
+    data.erase(data.begin(), data.begin() + n);
+
+    uint32_t lastEvent = ~0u;
+    for (unsigned int h = 0; h < hits.Hits(); h++)
+    {
+        uint32_t event = events + hits.event[h];
+        if (event == lastEvent || hits.flags[h] || event / nTrig >= nPoints) continue;
+        nHits[event / nTrig]++;
+        phSum[event / nTrig] += hits.ph[h];
+        lastEvent = event;
+    }
+    events += hits.Events();
+}
+
+
+// Scans dac2 for each value of dac1. res[i*dacRange2 + k] is the number of
+// readouts with a hit at dac1 = i, dac2 = k, ph the mean pulse height of
+// the first hit in them. The reads of a dac1 value are queued behind its
+// triggers, the data is decoded on a thread of its own while the next
+// values are programmed. Both DACs are left at their last value.
+void CTestboard::DacDac(int32_t dac1, int32_t dacRange1, int32_t dac2, int32_t dacRange2, int32_t nTrig, int32_t res[], double ph[])
+{
+    // a header and a hit per ROC
+    const int rowSize = dacRange2 * nTrig * (1 + 3*nRocs);
+    const int nReads = 1 + rowSize / CDaqReadQueue::blockSize;
+    const uint32_t nPoints = dacRange1 * dacRange2;
+    vector<int32_t> nHits(nPoints, 0), phSum(nPoints, 0);
+    PixelHitList hits;
+    uint32_t events = 0;
+    CDecodeWorker decoder([&](vector<uint16_t> &data, bool complete)
+        { CountDacDacHits(data, complete, nTrig, nPoints, hits, events, nHits, phSum); }, 4);
+    CDaqReadQueue queue(*this, DAQ_MAXPENDING);
+    vector<uint16_t> data;
+
+    Daq_Open(rowSize * 4 > 1000000 ? rowSize * 4 : 1000000);
     Daq_Select_Deser160(deserAdjust);
     Daq_Start();
 
-    PixelReadoutData pix;
-    uint32_t n;
-    uint8_t status;
     for (int i = 0; i < dacRange1; i++)
     {
         roc_SetDAC(dac1, i);
         for (int k = 0; k < dacRange2; k++)
         {
             roc_SetDAC(dac2, k);
-            for (int16_t l=0; l < nTrig; l++)
-            {
-                Pg_Single();
-            }
-        }
-        vector<uint16_t> data;
-        status = Daq_Read(data, 20000, n);
-        int pos = 0;
-        for (int k = 0; k < dacRange2; k++)
-        {
-            int32_t nHits = 0;
-            try
-            {
-                for (int16_t l=0; l < nTrig; l++)
-                {
-                    DecodePixel(data, pos, pix);
-                    if (pix.n > 0) nHits++;
-                }
-            } catch (int) {}
-            //cout << "hits:" << res[i*dacRange1 + k] << endl;
-            res[i*dacRange1 + k] = nHits;
+            Pg_Triggers(nTrig, nRocs);
         }
+        queue.Read(nReads, data);
+        decoder.Push(data);
     }
     Daq_Stop();
+    queue.Finish(data);
     Daq_Close();
-    return;
+    decoder.Push(data);
+    decoder.Finish();
+
+    for (uint32_t p = 0; p < nPoints; p++)
+    {
+        res[p] = nHits[p];
+        if (ph) ph[p] = nHits[p] ? (double)phSum[p]/nHits[p] : 0;
+    }
 }
 
 void CTestboard::ArmPixel(int col, int row)
@@ -415,20 +791,187 @@ void CTestboard::ChipThresholdIntern(int32_t start[], int32_t step, int32_t thrL
 	}
 }
 
+// Counts the hits of the armed pixels per DAC value of the sweep and removes
+// the decoded samples from data. Readout e belongs to pattern
+// e / (nValues*nTrig) and DAC value (e / nTrig) % nValues.
+static void CountThresholdHits(vector<uint16_t> &data, bool complete, int32_t nTrig, int nValues,
+	PixelHitList &hits, uint32_t &events, vector<uint16_t> &count)
+{
+	hits.Clear();
+	size_t n = data.empty() ? 0 : DecodeReadouts(&data[0], data.size(), hits, complete);
+	data.erase(data.begin(), data.begin() + n);
+
+	for (unsigned int h = 0; h < hits.Hits(); h++)
+	{
+		uint32_t event = events + hits.event[h];
+		int pattern = event / (nValues*nTrig);
+		int value = (event / nTrig) % nValues;
+		int col = hits.col[h], row = hits.row[h];
+		if (hits.flags[h] || pattern >= THR_PATTERNS
+			|| col % 2 != pattern / THR_ROWSPACING || row % THR_ROWSPACING != pattern % THR_ROWSPACING) continue;
+		count[(col*ROC_NUMROWS + row)*nValues + value]++;
+	}
+	events += hits.Events();
+}
+
+// Threshold map from DAC sweeps with many pixels armed at once. Pattern p
+// arms the columns of parity p / THR_ROWSPACING, in each of them the rows
+// p % THR_ROWSPACING + k*THR_ROWSPACING: 104 pixels, none next to another
+// in the same column. The DAC is swept once per pattern with nTrig
+// triggers per value. The threshold of a pixel is the first value in the
+// direction of step where more than thrLevel triggers give a hit, 255 (0
+// for step < 0) if there is none. That is what PixelThreshold finds with
+// the same step, start isn't needed. The DAC is left at the last value.
+int32_t CTestboard::ChipThresholdParallel(int32_t start, int32_t step, int32_t thrLevel, int32_t nTrig, int32_t dacReg, int32_t xtalk, int32_t cals, int32_t trim[], int32_t res[])
+{
+	const int nArmed = ROC_NUMDCOLS * (ROC_NUMROWS / THR_ROWSPACING);
+	if (step == 0) step = 1;
+	const int first = step > 0 ? 0 : 255;
+	const int nValues = 1 + 255 / abs(step);
+	// a header and two hits (the pixel and a neighbour) per armed pixel
+	const int valueSize = nTrig * (1 + 4*nArmed);
+	const int nReads = 1 + valueSize / CDaqReadQueue::blockSize;
+
+	// the data of each DAC value is read behind its triggers
+	CDaqReadQueue queue(*this, DAQ_MAXPENDING);
+	vector<uint16_t> data;
+	PixelHitList hits;
+	vector<uint16_t> count(ROC_NUMCOLS*ROC_NUMROWS*nValues, 0);
+	uint32_t events = 0;
+
+	Daq_Open(valueSize * 4 > 500000 ? valueSize * 4 : 500000);
+	Daq_Select_Deser160(deserAdjust);
+	Daq_Start();
+
+	for (int p = 0; p < THR_PATTERNS; p++)
+	{
+		int parity = p / THR_ROWSPACING, rowOffset = p % THR_ROWSPACING;
+		for (int col = parity; col < ROC_NUMCOLS; col += 2)
+		{
+			EnableColumn(col);
+			for (int row = rowOffset; row < ROC_NUMROWS; row += THR_ROWSPACING)
+			{
+				int calRow = row;
+				if (xtalk) calRow = (row == ROC_NUMROWS - 1) ? row - 1 : row + 1;
+				roc_Pix_Trim(col, row, trim[col*ROC_NUMROWS + row]);
+				roc_Pix_Cal(col, calRow, cals != 0);
+			}
+		}
+
+		for (int i = 0; i < nValues; i++)
+		{
+			roc_SetDAC(dacReg, first + i*step);
+			cDelay(1200);
+			Pg_Triggers(nTrig, 2*nArmed);
+			queue.Read(nReads, data);
+		}
+
+		roc_ClrCal();
+		for (int col = parity; col < ROC_NUMCOLS; col += 2)
+		{
+			for (int row = rowOffset; row < ROC_NUMROWS; row += THR_ROWSPACING)
+				roc_Pix_Mask(col, row);
+			roc_Col_Enable(col, 0);
+		}
+		CountThresholdHits(data, false, nTrig, nValues, hits, events, count);
+	}
+	Daq_Stop();
+	queue.Finish(data);
+	Daq_Close();
+	CountThresholdHits(data, true, nTrig, nValues, hits, events, count);
+
+	for (int pixel = 0; pixel < ROC_NUMCOLS*ROC_NUMROWS; pixel++)
+	{
+		int i = 0;
+		while (i < nValues && count[pixel*nValues + i] <= thrLevel) i++;
+		res[pixel] = i < nValues ? first + i*step : (step > 0 ? 255 : 0);
+	}
+	return 1;
+}
+
 void CTestboard::Init_Reset()
 {
     prep_dig_test();
     //InitDAC();
     //roc_Chip_Mask();
 
-    Pg_SetCmd(0, PG_RESR + 25);
-    Pg_SetCmd(1, PG_CAL  + 101 + tct_wbc);
-    Pg_SetCmd(2, PG_TRG  + 16);
-    Pg_SetCmd(3, PG_TOK);
+    uint16_t pg[] = { PG_RESR + 25, uint16_t(PG_CAL + 101 + tct_wbc), PG_TRG + 16, PG_TOK };
+    Pg_SetSequence(vector<uint16_t>(pg, pg + 4));
     uDelay(100);
     Flush();
 }
 
+void CTestboard::Pg_SetSequence(const vector<uint16_t> &cmd)
+{
+    pgSequence = cmd;
+    if (!cmd.empty()) Pg_LoadBurst(PG_BURSTSPACING);
+}
+
+// Loads the copies of pgSequence. A command delays 255 clocks at most, a
+// longer spacing goes on with commands without signals. Copies 1 and
+// pgBurst end with delay 0, the others run on into the next.
+void CTestboard::Pg_LoadBurst(int spacing)
+{
+    int n = pgSequence.size();
+    uint16_t end = pgSequence[n-1] & 0xff00;
+    pgSpacing = spacing;
+    pgCopySize = n + (spacing > 255 ? (spacing - 1) / 255 : 0);
+    int copies = 256 / pgCopySize < PG_MAXBURST ? 256 / pgCopySize : PG_MAXBURST;
+    pgBurst = copies;
+    for (int r = 0; r < copies; r++)
+    {
+        int a = r*pgCopySize;
+        for (int i = 0; i < n - 1; i++) Pg_SetCmd(a + i, pgSequence[i]);
+        bool last = r == 0 || r == copies - 1;
+        Pg_SetCmd(a + n - 1, end | (last ? 0 : spacing > 255 ? 255 : spacing));
+        for (int wait = spacing - 255, i = n; wait > 0; wait -= 255, i++)
+            Pg_SetCmd(a + i, wait > 255 ? 255 : wait);
+    }
+}
+
+void CTestboard::Pg_Triggers(int32_t nTriggers, int32_t nHits)
+{
+    int n = pgSequence.size();
+    int spacing = PG_BURSTSPACING + PG_HITCLOCKS*(nHits > 0 ? nHits : 0);
+    if (n > 0 && spacing != pgSpacing) Pg_LoadBurst(spacing);
+    if (n == 0 || pgBurst < 2)
+    {
+        for (int i = 0; i < nTriggers; i++) Pg_Single();
+        return;
+    }
+
+    uint16_t end = pgSequence[n-1] & 0xff00;
+    uint16_t open = end | (spacing > 255 ? 255 : spacing);
+    uint32_t clocks = spacing;
+    for (int i = 0; i < n; i++) clocks += pgSequence[i] & 0xff;
+    int copies = 256 / pgCopySize < PG_MAXBURST ? 256 / pgCopySize : PG_MAXBURST;
+
+    while (nTriggers > 1)
+    {
+        int k = nTriggers < copies ? nTriggers : copies;
+        if (k != pgBurst)
+        {
+            Pg_SetCmd((k - 1)*pgCopySize + n - 1, end);
+            Pg_SetCmd((pgBurst - 1)*pgCopySize + n - 1, open);
+            pgBurst = k;
+        }
+        // open the end of the first copy for the burst only, Pg_Single
+        // elsewhere still sends one trigger
+        Pg_SetCmd(n - 1, open);
+        Pg_Single();
+        // cDelay takes 16 bits
+        for (uint32_t wait = k*clocks; wait > 0; )
+        {
+            uint16_t d = wait > 0xffff ? 0xffff : wait;
+            cDelay(d);
+            wait -= d;
+        }
+        Pg_SetCmd(n - 1, end);
+        nTriggers -= k;
+    }
+    if (nTriggers == 1) Pg_Single();
+}
+
 int32_t CTestboard::ChipThreshold(int32_t start, int32_t step, int32_t thrLevel, int32_t nTrig, int32_t dacReg, int32_t xtalk, int32_t cals, int32_t trim[], int32_t res[])
 {
   int startValue;
@@ -489,43 +1032,109 @@ int32_t CTestboard::SCurve(int32_t nTrig, int32_t dacReg, int32_t thr[], int32_t
 }
 
 
-int32_t CTestboard::SCurveColumn(int32_t iColumn, int32_t nTrig, int32_t dacReg, int32_t thr[], int32_t trim[], int32_t chipId[], int32_t sCurve[])
-{	
-	int32_t buffer[nRocs*32], thresholds[nRocs];
-	long position = 0;
-		
-	for (int iChip = 0; iChip < nRocs; iChip++)
+// Counts the hits of the armed pixels per S-curve point and removes the
+// decoded samples from data. Readout e belongs to row e / (32*nTrig) and
+// point (e / nTrig) % 32, sCurve is filled in SCurveColumn order. A hit
+// counts for the chip at its readout position in chipId, hits of positions
+// beyond the list or marked -1 are dropped.
+static void CountSCurveHits(vector<uint16_t> &data, bool complete, int32_t iColumn, int32_t nTrig, int nChips,
+	const int32_t chipId[], PixelHitList &hits, uint32_t &events, int32_t sCurve[])
+{
+	hits.Clear();
+	size_t n = data.empty() ? 0 : DecodeReadouts(&data[0], data.size(), hits, complete);
+	data.erase(data.begin(), data.begin() + n);
+
+	vector<uint32_t> lastEvent(nChips, ~0u);
+	for (unsigned int h = 0; h < hits.Hits(); h++)
+	{
+		uint32_t event = events + hits.event[h];
+		uint32_t row = event / (32*nTrig);
+		int i = (event / nTrig) % 32;
+		int k = nChips > 1 ? hits.roc[h] : 0;
+		if (row >= ROC_NUMROWS || k >= nChips || chipId[k] < 0 || event == lastEvent[k] || hits.flags[h]
+			|| hits.col[h] != iColumn || hits.row[h] != row) continue;
+		sCurve[(row*32 + i)*nChips + k]++;
+		lastEvent[k] = event;
+	}
+	events += hits.Events();
+}
+
+
+// Point i of the S-curve of a pixel is taken at DAC value thr - 16 + i, the
+// points start at 0 for thresholds below 16. All rows of the column go
+// through one DAQ session, the hits are counted on the host.
+// chipId: the ROC at each of the nChips readout positions, -1 for one not
+// tested; thr, trim and sCurve are arranged by readout position as well.
+int32_t CTestboard::SCurveColumn(int32_t iColumn, int32_t nTrig, int32_t dacReg, int32_t nChips, int32_t thr[], int32_t trim[], int32_t chipId[], int32_t sCurve[])
+{
+	// a header and a hit per ROC
+	const int rowSize = 32 * nTrig * (1 + 3*nChips);
+	const int nReads = 1 + rowSize / CDaqReadQueue::blockSize;
+	CDaqReadQueue queue(*this, DAQ_MAXPENDING);
+	vector<uint16_t> data;
+	PixelHitList hits;
+	uint32_t events = 0;
+
+	for (int i = 0; i < ROC_NUMROWS*32*nChips; i++) sCurve[i] = 0;
+
+	for (int iChip = 0; iChip < nChips; iChip++)
 	{
+		if (chipId[iChip] < 0) continue;
 		SetChip(chipId[iChip]);
-  	    EnableColumn(iColumn);
+		EnableColumn(iColumn);
 	}
-	
+
+	Daq_Open(rowSize * 4 > 500000 ? rowSize * 4 : 500000);
+	Daq_Select_Deser160(deserAdjust);
+	Daq_Start();
+
 	for (int iRow = 0; iRow < ROC_NUMROWS; iRow++)
 	{
-		for (int iChip = 0; iChip < nRocs; iChip++)
+		for (int iChip = 0; iChip < nChips; iChip++)
 		{
-			thresholds[iChip] = thr[nRocs * iRow + iChip];
+			if (chipId[iChip] < 0) continue;
 			SetChip(chipId[iChip]);
-            ArmPixel(iColumn,iRow,trim[nRocs * iRow + iChip]);
+			ArmPixel(iColumn, iRow, trim[nChips * iRow + iChip]);
 		}
-		
-		SCurve(nTrig, dacReg, thresholds, chipId, buffer);
 
-		for (int iChip = 0; iChip < nRocs; iChip++)
+		for (int i = 0; i < 32; i++)
 		{
+			for (int iChip = 0; iChip < nChips; iChip++)
+			{
+				if (chipId[iChip] < 0) continue;
+				int start = thr[nChips * iRow + iChip] - 16;
+				if (start < 0) start = 0;
+				int dac = start + i;
+				if (dac > 255) dac = 255;
+				SetChip(chipId[iChip]);
+				roc_SetDAC(dacReg, dac);
+			}
+			cDelay(1200);
+			if (i == 0) cDelay(1200);
+			Pg_Triggers(nTrig, nChips);
+		}
+
+		for (int iChip = 0; iChip < nChips; iChip++)
+		{
+			if (chipId[iChip] < 0) continue;
 			SetChip(chipId[iChip]);
- 		 	DisarmPixel(iColumn, iRow);
+			DisarmPixel(iColumn, iRow);
 		}
 
-		for (int i = 0; i < 32*nRocs; i++) sCurve[position + i] = buffer[i];
-		position+=32*nRocs;
+		queue.Read(nReads, data);
+		CountSCurveHits(data, false, iColumn, nTrig, nChips, chipId, hits, events, sCurve);
 	}
-	
-	for (int iChip = 0; iChip < nRocs; iChip++)
+	Daq_Stop();
+	queue.Finish(data);
+	Daq_Close();
+	CountSCurveHits(data, true, iColumn, nTrig, nChips, chipId, hits, events, sCurve);
+
+	for (int iChip = 0; iChip < nChips; iChip++)
 	{
+		if (chipId[iChip] < 0) continue;
 		SetChip(chipId[iChip]);
-  	    roc_Col_Enable(iColumn, 0);
+		roc_Col_Enable(iColumn, 0);
 	}
-    return 1;
+	return 1;
 }
 
@@ -22,7 +22,7 @@
 
 #pragma once
 
-// #define RPC_MULTITHREADING
+#define RPC_MULTITHREADING  // a DAQ reader thread may run next to the test sequence (see DaqDrain.h)
 #include "interface/rpc.h"
 
 #ifdef _WIN32
@@ -30,6 +30,8 @@
 #endif
 
 #include "interface/USBInterface.h"
+#include "interface/DtbEmulator.h"
+#include "interface/rpc_record.h"
 
 // size of ROC pixel array
 #define ROC_NUMROWS  80  // # rows
@@ -39,6 +41,17 @@
 
 #define PIXMASK  0x80
 
+#define DAQ_MAXPENDING 8   // DAQ reads in flight in the scans, the replies have to fit in the USB read buffer
+
+// pixel patterns of CTestboard::ChipThresholdParallel
+#define THR_ROWSPACING 20  // rows between pixels armed together in a column
+#define THR_PATTERNS   (2*THR_ROWSPACING)
+
+// pattern generator bursts of CTestboard::Pg_SetSequence and Pg_Triggers
+#define PG_MAXBURST     32   // copies of the sequence
+#define PG_BURSTSPACING 200  // clocks after the token before the next copy, without hits
+#define PG_HITCLOCKS    6    // readout clocks per hit on top of that
+
 // PUC register addresses for roc_SetDAC
 #define	Vdig        0x01
 #define Vana        0x02
@@ -83,14 +96,25 @@ class CTestboard
 	CPipeClient pipe;
 #endif
 	CUSB usb;
+	CDtbEmulator emulator; // used for testboard names starting with "emulator"
+	CRpcIoReplay replay;   // "replay:<session file>[,realtime]"
+	CRpcIoRecorder recorder;
+	CRpcIo *link;          // usb, emulator or replay, rpc_io may be the recorder on top
+	string recordFile;
+	string callIdCacheFile;
+
+	void ResolveRpcCalls();
+	void ResolveRpcCallIds(const vector<uint16_t> &cmd);
 
 public:
 	CRpcIo& GetIo() { return *rpc_io; }
 
-	CTestboard() { RPC_INIT rpc_io = &usb;
+	CTestboard() { RPC_INIT rpc_io = link = &usb;
 	  // Set defaults for deser160 variables:
 	  delayAdjust = 4;
 	  deserAdjust = 4;
+	  pgBurst = 0;
+	  pgSpacing = pgCopySize = 0;
 	}
 	~CTestboard() { RPC_EXIT }
 
@@ -126,12 +150,40 @@ public:
 
 	void SetTimeout(unsigned int timeout) { usb.SetTimeout(timeout); }
 
-	bool IsConnected() { return usb.Connected(); }
-	const char * ConnectionError()
-	{ return usb.GetErrorMsg(usb.GetLastError()); }
+	// USB read engine: queue depth and transfer size (applied at Open), throughput in MB/s
+	void SetUsbReadQueue(unsigned int nTransfers, unsigned int transferSize)
+	{ usb.SetReadQueue(nTransfers, transferSize); }
+	double GetUsbReadRate() { return usb.GetReadRate(); }
+	void ResetUsbReadRate() { usb.ResetReadRate(); }
+
+	// RPC profiler: calls, traffic and round trip times per command,
+	// the summary is printed at exit while profiling is on
+	void SetRpcProfiling(bool on) { rpc_profiler.Enable(on); }
+	bool GetRpcProfiling() { return rpc_profiler.IsEnabled(); }
+	void ShowRpcProfile() { rpc_profiler.Report(); }
+	void ResetRpcProfile() { rpc_profiler.Reset(); }
+
+	bool IsEmulated() { return link == &emulator; }
+	bool IsReplayed() { return link == &replay; }
+	CDtbEmulator& GetEmulator() { return emulator; }
+
+	bool IsConnected();
+	const char * ConnectionError();
 
-	void Flush() { rpc_io->Flush(); }
-	void Clear() { rpc_io->Clear(); }
+	// session recording: logs all bytes to and from the board with timestamps
+	// from the next Open() on. The file can be opened later as testboard
+	// "replay:<file>" to rerun the same sequence without hardware.
+	void SetRecordFile(const char *fileName) { recordFile = fileName; }
+	void StopRecording();
+
+	// call ids of all commands are resolved at Open() in one batch, the
+	// result is kept in this file per firmware (empty: no cache)
+	void SetCallIdCacheFile(const char *fileName) { callIdCacheFile = fileName; }
+	bool IsRecording() { return recorder.Recording(); }
+
+	// locked like the generated calls, a CDaqDrain thread may be using rpc_io
+	void Flush() { RPC_THREAD_LOCK rpc_io->Flush(); }
+	void Clear() { RPC_THREAD_LOCK rpc_io->Clear(); }
 
 
 	// === DTB identification ================================================
@@ -276,6 +328,14 @@ public:
 	RPC_EXPORT void Pg_Trigger();
 	RPC_EXPORT void Pg_Loop(uint16_t period);
 
+	// Pattern generator sequence run by Pg_Single, the last command ends it.
+	// It is loaded up to PG_MAXBURST times in a row, so that Pg_Triggers can
+	// run a burst of triggers with one Pg_Single. The copies are spaced for
+	// the readout of nHits hits per trigger (all ROCs together).
+	void Pg_SetSequence(const vector<uint16_t> &cmd);
+	const vector<uint16_t> &Pg_GetSequence() const { return pgSequence; }
+	void Pg_Triggers(int32_t nTriggers, int32_t nHits = 1);
+
 	RPC_EXPORT uint16_t GetUser1Version();
 
 
@@ -292,6 +352,13 @@ public:
 	RPC_EXPORT uint8_t Daq_Read(vectorR<uint16_t> &data,
 			uint16_t blocksize, uint32_t &availsize);
 
+	// Daq_Read appending to the first size samples of data and adding the
+	// number received to size. data only grows (zero filled) when less than
+	// blocksize samples are free behind size; a buffer reused over a run is
+	// neither reallocated nor cleared per block.
+	uint8_t Daq_ReadAppend(vector<uint16_t> &data, size_t &size,
+			uint16_t blocksize, uint32_t &availsize);
+
 	RPC_EXPORT void Daq_Select_ADC(uint16_t blocksize, uint8_t source,
 			uint8_t start, uint8_t stop = 0);
 
@@ -443,7 +510,9 @@ public:
     void SetChip(int iChip);    
     int32_t MaskTest(int16_t nTriggers, int16_t res[]);
 	int32_t ChipEfficiency(int16_t nTriggers, int32_t trim[], double res[]); 
-	void DacDac(int32_t dac1, int32_t dacRange1, int32_t dac2, int32_t dacRange2, int32_t nTrig, int32_t result[]);
+	int32_t ModuleEfficiency(int16_t nTriggers, int32_t nChips, int32_t chipId[], int32_t trim[], double res[], double ph[]);
+	int32_t PixelEfficiency(int16_t nTriggers, int32_t nChips, int32_t chipId[], int32_t trim[], double res[], double ph[]);
+	void DacDac(int32_t dac1, int32_t dacRange1, int32_t dac2, int32_t dacRange2, int32_t nTrig, int32_t result[], double ph[] = 0);
 	void AddressLevels(int32_t position, int32_t result[]){ print_missing(); return;}
     RPC_EXPORT int32_t CountReadouts(int32_t nTriggers);
 	RPC_EXPORT int32_t CountReadouts(int32_t nTriggers, int32_t chipId);
@@ -451,9 +520,10 @@ public:
 	RPC_EXPORT int32_t PixelThreshold(int32_t col, int32_t row, int32_t start, int32_t step, int32_t thrLevel, int32_t nTrig, int32_t dacReg, int32_t xtalk, int32_t cals, int32_t trim);
 	int32_t ChipThreshold(int32_t start, int32_t step, int32_t thrLevel, int32_t nTrig, int32_t dacReg, int32_t xtalk, int32_t cals, int32_t trim[], int32_t res[]);
 	void ChipThresholdIntern(int32_t start[], int32_t step, int32_t thrLevel, int32_t nTrig, int32_t dacReg, int32_t xtalk, int32_t cals, int32_t trim[], int32_t res[]);
+	int32_t ChipThresholdParallel(int32_t start, int32_t step, int32_t thrLevel, int32_t nTrig, int32_t dacReg, int32_t xtalk, int32_t cals, int32_t trim[], int32_t res[]);
 	int32_t SCurve(int32_t nTrig, int32_t dacReg, int32_t threshold, int32_t res[]);
     int32_t SCurve(int32_t nTrig, int32_t dacReg, int32_t thr[], int32_t chipId[], int32_t sCurve[]);
-	int32_t SCurveColumn(int32_t column, int32_t nTrig, int32_t dacReg, int32_t thr[], int32_t trims[], int32_t chipId[], int32_t res[]);
+	int32_t SCurveColumn(int32_t column, int32_t nTrig, int32_t dacReg, int32_t nChips, int32_t thr[], int32_t trims[], int32_t chipId[], int32_t res[]);
     RPC_EXPORT int32_t PH(int32_t col, int32_t row, int32_t trim, int16_t nTriggers);
     RPC_EXPORT bool test_pixel_address(int32_t col, int32_t row);
     void SetNRocs(int32_t value);
@@ -497,7 +567,7 @@ public:
 
     void ForceSignal(unsigned char pattern){ print_missing(); return; }
 
-    bool ShowUSB() { print_missing(); return false; }; 
+    bool ShowUSB();
 
     bool Open(char name[], bool init = true){ print_missing(); return true;}
 
@@ -533,8 +603,17 @@ public:
 
 
 
+	// === deferred RPC calls =============================================
+	// <name>_Async variants of all calls with return values (see rpc.h)
+#include "interface/rpc_calls_async.h"
+
 private:
     int hubId;
     int nRocs;
+    vector<uint16_t> pgSequence;
+    int pgBurst;    // copy of the sequence that ends a burst
+    int pgSpacing;  // clocks after the last command of a copy before the next
+    int pgCopySize; // commands per copy, the sequence and the waits of the spacing
+    void Pg_LoadBurst(int spacing);
     
 };
@@ -0,0 +1,1066 @@
+#include "DtbEmulator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+
+using namespace std;
+
+
+// ROC registers and pattern generator bits used by the model
+#define EMU_VANA       0x02
+#define EMU_VTRIM      0x0B
+#define EMU_VTHRCOMP   0x0C
+#define EMU_VCAL       0x19
+#define EMU_CTRLREG    0xFD
+
+#define EMU_PG_CAL     0x0400
+#define EMU_PG_TRG     0x0200
+
+// reference DAC settings the pixel thresholds refer to
+#define EMU_VTHRCOMP_REF  20
+#define EMU_VTHRCOMP_GAIN 0.8   // Vcal per VthrComp step
+#define EMU_TRIM_GAIN     0.05  // Vcal per Vtrim step and trim bit
+#define EMU_XTALK         0.05  // fraction of the charge seen by row neighbours
+
+// largest data block of one RPC message (16 bit byte count)
+#define EMU_MAXBLOCK 32767
+
+
+static uint64_t emu_Now()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return uint64_t(t.tv_sec)*1000000000 + t.tv_nsec;
+}
+
+
+double CEmuRandom::Gauss()
+{
+	if (m_haveGauss) { m_haveGauss = false; return m_gauss; }
+	double u, v, s;
+	do
+	{
+		u = 2.0*Uniform() - 1.0;
+		v = 2.0*Uniform() - 1.0;
+		s = u*u + v*v;
+	} while (s >= 1.0 || s == 0.0);
+	s = sqrt(-2.0*log(s)/s);
+	m_gauss = v*s;
+	m_haveGauss = true;
+	return u*s;
+}
+
+
+// === ROC model ==============================================================
+
+void CRocModel::Configure(const CRocModelSettings &s, CEmuRandom &rnd)
+{
+	m_noise = s.noise;
+	for (unsigned int i = 0; i < NPIX; i++)
+	{
+		m_thr[i]  = float(s.thrMean + s.thrSigma*rnd.Gauss());
+		m_gain[i] = float(1.0 + s.phGain*rnd.Gauss());
+		m_dead[i] = rnd.Uniform() < s.dead;
+		m_noBump[i] = s.noBump > 0 && rnd.Uniform() < s.noBump;
+	}
+}
+
+
+void CRocModel::Reset()
+{
+	memset(m_dac, 0, sizeof(m_dac));
+	for (unsigned int i = 0; i < NCOL/2; i++) m_colEnable[i] = false;
+	for (unsigned int i = 0; i < NPIX; i++)
+	{
+		m_trim[i] = 15;
+		m_masked[i] = true;
+		m_isCal[i] = false;
+		m_calSensor[i] = false;
+	}
+	m_cal.clear();
+}
+
+
+void CRocModel::Pix(uint8_t col, uint8_t row, uint8_t value)
+{
+	if (col >= NCOL || row >= NROW) return;
+	m_trim[col*NROW + row] = value & 0x0f;
+	m_masked[col*NROW + row] = (value & 0x80) != 0;
+}
+
+
+void CRocModel::PixTrim(uint8_t col, uint8_t row, uint8_t value)
+{
+	Pix(col, row, value & 0x0f);
+}
+
+
+void CRocModel::PixMask(uint8_t col, uint8_t row)
+{
+	if (col >= NCOL || row >= NROW) return;
+	m_masked[col*NROW + row] = true;
+}
+
+
+void CRocModel::PixCal(uint8_t col, uint8_t row, bool sensor)
+{
+	if (col >= NCOL || row >= NROW) return;
+	unsigned int pix = col*NROW + row;
+	m_calSensor[pix] = sensor;
+	if (m_isCal[pix]) return;
+	m_isCal[pix] = true;
+	m_cal.push_back(pix);
+}
+
+
+void CRocModel::ClrCal()
+{
+	for (unsigned int i = 0; i < m_cal.size(); i++) m_isCal[m_cal[i]] = false;
+	m_cal.clear();
+}
+
+
+void CRocModel::ColMask(uint8_t col)
+{
+	if (col >= NCOL) return;
+	for (unsigned int row = 0; row < NROW; row++) m_masked[col*NROW + row] = true;
+	m_colEnable[col/2] = false;
+}
+
+
+void CRocModel::ChipMask()
+{
+	for (unsigned int i = 0; i < NPIX; i++) m_masked[i] = true;
+	for (unsigned int i = 0; i < NCOL/2; i++) m_colEnable[i] = false;
+}
+
+
+void CRocModel::SetDead(uint8_t col, uint8_t row, bool dead)
+{
+	if (col < NCOL && row < NROW) m_dead[col*NROW + row] = dead;
+}
+
+
+void CRocModel::SetNoBump(uint8_t col, uint8_t row, bool noBump)
+{
+	if (col < NCOL && row < NROW) m_noBump[col*NROW + row] = noBump;
+}
+
+
+void CRocModel::SetThreshold(uint8_t col, uint8_t row, double thr)
+{
+	if (col < NCOL && row < NROW) m_thr[col*NROW + row] = float(thr);
+}
+
+
+// threshold in low range Vcal units for the current DAC and trim settings
+double CRocModel::Threshold(unsigned int pix)
+{
+	return m_thr[pix]
+		- EMU_VTHRCOMP_GAIN*(int(m_dac[EMU_VTHRCOMP]) - EMU_VTHRCOMP_REF)
+		- EMU_TRIM_GAIN*m_dac[EMU_VTRIM]*(15 - m_trim[pix]);
+}
+
+
+void CRocModel::Hit(unsigned int pix, double q, CEmuRandom &rnd,
+	vector<uint16_t> &addr, vector<uint8_t> &ph)
+{
+	unsigned int col = pix / NROW, row = pix % NROW;
+	if (m_dead[pix] || m_masked[pix] || !m_colEnable[col/2]) return;
+	double thr = Threshold(pix);
+	if (q + m_noise*rnd.Gauss() <= thr) return;
+
+	double p = m_gain[pix]*(30.0 + 200.0*tanh(q/600.0)) + rnd.Gauss();
+	if (p < 0) p = 0; else if (p > 255) p = 255;
+	addr.push_back(uint16_t((col << 8) | row));
+	ph.push_back(uint8_t(p + 0.5));
+}
+
+
+void CRocModel::Trigger(CEmuRandom &rnd, vector<uint16_t> &addr, vector<uint8_t> &ph)
+{
+	addr.clear();
+	ph.clear();
+	if (m_cal.empty()) return;
+
+	double q = m_dac[EMU_VCAL] * ((m_dac[EMU_CTRLREG] & 0x04) ? 7.0 : 1.0);
+	for (unsigned int i = 0; i < m_cal.size(); i++)
+	{
+		unsigned int pix = m_cal[i], row = pix % NROW;
+		if (m_calSensor[pix] && m_noBump[pix]) continue;  // charge stays in the sensor
+		Hit(pix, q, rnd, addr, ph);
+		if (row > 0 && !m_isCal[pix-1]) Hit(pix-1, EMU_XTALK*q, rnd, addr, ph);
+		if (row < NROW-1 && !m_isCal[pix+1]) Hit(pix+1, EMU_XTALK*q, rnd, addr, ph);
+	}
+	if (addr.size() < 2) return;
+
+	// readout order, one entry per pixel
+	vector< pair<uint16_t, uint8_t> > hits(addr.size());
+	for (unsigned int i = 0; i < addr.size(); i++) hits[i] = make_pair(addr[i], ph[i]);
+	sort(hits.begin(), hits.end());
+	addr.clear();
+	ph.clear();
+	for (unsigned int i = 0; i < hits.size(); i++)
+	{
+		if (i > 0 && hits[i].first == hits[i-1].first) continue;
+		addr.push_back(hits[i].first);
+		ph.push_back(hits[i].second);
+	}
+}
+
+
+double CRocModel::Current()
+{
+	return 0.18*m_dac[EMU_VANA];
+}
+
+
+// === command table ==========================================================
+
+// names and signatures as in CTestboard::rpc_cmdName
+CDtbEmulator::CCmd CDtbEmulator::cmdList[] =
+{
+	{ "GetRpcVersion$S",             &CDtbEmulator::rpc_GetRpcVersion },
+	{ "GetRpcCallId$i3c",            &CDtbEmulator::rpc_GetRpcCallId },
+	{ "GetRpcTimestamp$v4c",         &CDtbEmulator::rpc_GetRpcTimestamp },
+	{ "GetRpcCallCount$i",           &CDtbEmulator::rpc_GetRpcCallCount },
+	{ "GetRpcCallName$bi4c",         &CDtbEmulator::rpc_GetRpcCallName },
+	{ "GetInfo$v4c",                 &CDtbEmulator::rpc_GetInfo },
+	{ "GetBoardId$S",                &CDtbEmulator::rpc_GetBoardId },
+	{ "GetHWVersion$v4c",            &CDtbEmulator::rpc_GetHWVersion },
+	{ "GetFWVersion$S",              &CDtbEmulator::rpc_GetFWVersion },
+	{ "GetSWVersion$S",              &CDtbEmulator::rpc_GetSWVersion },
+	{ "UpgradeGetVersion$S",         &CDtbEmulator::rpc_UpgradeGetVersion },
+	{ "UpgradeStart$CS",             &CDtbEmulator::rpc_UpgradeStart },
+	{ "UpgradeData$C3c",             &CDtbEmulator::rpc_UpgradeData },
+	{ "UpgradeError$C",              &CDtbEmulator::rpc_UpgradeError },
+	{ "UpgradeErrorMsg$v4c",         &CDtbEmulator::rpc_UpgradeErrorMsg },
+	{ "UpgradeExec$vS",              &CDtbEmulator::rpc_Void },
+	{ "Init$v",                      &CDtbEmulator::rpc_Init },
+	{ "Welcome$v",                   &CDtbEmulator::rpc_Void },
+	{ "SetLed$vC",                   &CDtbEmulator::rpc_Void },
+	{ "cDelay$vS",                   &CDtbEmulator::rpc_Void },
+	{ "uDelay$vS",                   &CDtbEmulator::rpc_Void },
+	{ "Sig_SetMode$vCC",             &CDtbEmulator::rpc_Void },
+	{ "Sig_SetPRBS$vCC",             &CDtbEmulator::rpc_Void },
+	{ "Sig_SetDelay$vCSc",           &CDtbEmulator::rpc_Void },
+	{ "Sig_SetLevel$vCC",            &CDtbEmulator::rpc_Void },
+	{ "Sig_SetOffset$vC",            &CDtbEmulator::rpc_Void },
+	{ "Sig_SetLVDS$v",               &CDtbEmulator::rpc_Void },
+	{ "Sig_SetLCDS$v",               &CDtbEmulator::rpc_Void },
+	{ "SignalProbeD1$vC",            &CDtbEmulator::rpc_Void },
+	{ "SignalProbeD2$vC",            &CDtbEmulator::rpc_Void },
+	{ "SignalProbeA1$vC",            &CDtbEmulator::rpc_Void },
+	{ "SignalProbeA2$vC",            &CDtbEmulator::rpc_Void },
+	{ "SignalProbeADC$vCC",          &CDtbEmulator::rpc_Void },
+	{ "Pon$v",                       &CDtbEmulator::rpc_Pon },
+	{ "Poff$v",                      &CDtbEmulator::rpc_Poff },
+	{ "_SetVD$vS",                   &CDtbEmulator::rpc_SetVD },
+	{ "_SetVA$vS",                   &CDtbEmulator::rpc_SetVA },
+	{ "_SetID$vS",                   &CDtbEmulator::rpc_SetID },
+	{ "_SetIA$vS",                   &CDtbEmulator::rpc_SetIA },
+	{ "_GetVD$S",                    &CDtbEmulator::rpc_GetVD },
+	{ "_GetVA$S",                    &CDtbEmulator::rpc_GetVA },
+	{ "_GetID$S",                    &CDtbEmulator::rpc_GetID },
+	{ "_GetIA$S",                    &CDtbEmulator::rpc_GetIA },
+	{ "HVon$v",                      &CDtbEmulator::rpc_HVon },
+	{ "HVoff$v",                     &CDtbEmulator::rpc_HVoff },
+	{ "ResetOn$v",                   &CDtbEmulator::rpc_ResetOn },
+	{ "ResetOff$v",                  &CDtbEmulator::rpc_ResetOff },
+	{ "GetStatus$C",                 &CDtbEmulator::rpc_GetStatus },
+	{ "SetRocAddress$vC",            &CDtbEmulator::rpc_Void },
+	{ "Pg_SetCmd$vSS",               &CDtbEmulator::rpc_Pg_SetCmd },
+	{ "Pg_Stop$v",                   &CDtbEmulator::rpc_Pg_Stop },
+	{ "Pg_Single$v",                 &CDtbEmulator::rpc_Pg_Single },
+	{ "Pg_Trigger$v",                &CDtbEmulator::rpc_Pg_Single },
+	{ "Pg_Loop$vS",                  &CDtbEmulator::rpc_Pg_Loop },
+	{ "GetUser1Version$S",           &CDtbEmulator::rpc_GetFWVersion },
+	{ "Daq_Open$II",                 &CDtbEmulator::rpc_Daq_Open },
+	{ "Daq_Close$v",                 &CDtbEmulator::rpc_Daq_Close },
+	{ "Daq_Start$v",                 &CDtbEmulator::rpc_Daq_Start },
+	{ "Daq_Stop$v",                  &CDtbEmulator::rpc_Daq_Stop },
+	{ "Daq_GetSize$I",               &CDtbEmulator::rpc_Daq_GetSize },
+	{ "Daq_Read$C2SS",               &CDtbEmulator::rpc_Daq_Read },
+	{ "Daq_Read$C2SS0I",             &CDtbEmulator::rpc_Daq_ReadAvail },
+	{ "Daq_Select_ADC$vSCCC",        &CDtbEmulator::rpc_Void },
+	{ "Daq_Select_Deser160$vC",      &CDtbEmulator::rpc_Void },
+	{ "roc_I2cAddr$vC",              &CDtbEmulator::rpc_roc_I2cAddr },
+	{ "roc_ClrCal$v",                &CDtbEmulator::rpc_roc_ClrCal },
+	{ "roc_SetDAC$vCC",              &CDtbEmulator::rpc_roc_SetDAC },
+	{ "roc_Pix$vCCC",                &CDtbEmulator::rpc_roc_Pix },
+	{ "roc_Pix_Trim$vCCC",           &CDtbEmulator::rpc_roc_Pix_Trim },
+	{ "roc_Pix_Mask$vCC",            &CDtbEmulator::rpc_roc_Pix_Mask },
+	{ "roc_Pix_Cal$vCCb",            &CDtbEmulator::rpc_roc_Pix_Cal },
+	{ "roc_Col_Enable$vCb",          &CDtbEmulator::rpc_roc_Col_Enable },
+	{ "roc_Col_Mask$vC",             &CDtbEmulator::rpc_roc_Col_Mask },
+	{ "roc_Chip_Mask$v",             &CDtbEmulator::rpc_roc_Chip_Mask },
+	{ "TBM_Present$b",               &CDtbEmulator::rpc_TBM_Present },
+	{ "tbm_Enable$vb",               &CDtbEmulator::rpc_Void },
+	{ "tbm_Addr$vCC",                &CDtbEmulator::rpc_Void },
+	{ "mod_Addr$vC",                 &CDtbEmulator::rpc_Void },
+	{ "tbm_Set$vCC",                 &CDtbEmulator::rpc_Void },
+	{ "tbm_Get$bC0C",                &CDtbEmulator::rpc_tbm_Get },
+	{ "tbm_GetRaw$bC0I",             &CDtbEmulator::rpc_tbm_GetRaw },
+	{ "GetPixelAddressInverted$b",   &CDtbEmulator::rpc_GetPixelAddressInverted },
+	{ "SetPixelAddressInverted$vb",  &CDtbEmulator::rpc_SetPixelAddressInverted },
+	{ "CountReadouts$ii",            &CDtbEmulator::rpc_CountReadouts },
+	{ "CountReadouts$iii",           &CDtbEmulator::rpc_CountReadoutsChip },
+	{ "CountReadouts$iiii",          &CDtbEmulator::rpc_CountReadoutsDac },
+	{ "PH$iiiis",                    &CDtbEmulator::rpc_PH },
+	{ "PixelThreshold$iiiiiiiiiii",  &CDtbEmulator::rpc_PixelThreshold },
+	{ "test_pixel_address$bii",      &CDtbEmulator::rpc_test_pixel_address },
+	{ "testColPixel$bCC2C",          &CDtbEmulator::rpc_testColPixel },
+	{ "Ethernet_Send$v3c",           &CDtbEmulator::rpc_Void },
+	{ "Ethernet_RecvPackets$I",      &CDtbEmulator::rpc_Ethernet_RecvPackets }
+};
+
+unsigned int CDtbEmulator::cmdCount = 0;
+
+
+static unsigned int emu_TypeSize(char t)
+{
+	switch (t)
+	{
+		case 'b': case 'c': case 'C': return 1;
+		case 's': case 'S': return 2;
+		case 'i': case 'I': return 4;
+		case 'l': case 'L': return 8;
+		default: return 0;
+	}
+}
+
+
+// derive message sizes from the signatures (see rpc_TranslateCallName)
+void CDtbEmulator::InitCmdList()
+{
+	if (cmdCount) return;
+	unsigned int n = sizeof(cmdList)/sizeof(CCmd);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		CCmd &cmd = cmdList[i];
+		const char *p = strrchr(cmd.name, '$') + 1;
+		cmd.parSize = cmd.dataIn = 0;
+		cmd.retSize = emu_TypeSize(*p);
+		cmd.reply = *p != 'v';
+		for (p++; *p; p++)
+		{
+			int comp = -1;
+			if (*p >= '0' && *p <= '4') comp = *p++ - '0';
+			unsigned int size = emu_TypeSize(*p);
+			switch (comp)
+			{
+				case -1: cmd.parSize += size; break;
+				case 0:  cmd.parSize += size; cmd.retSize += size; cmd.reply = true; break;
+				case 1: case 3: cmd.dataIn++; break;
+				case 2: case 4: cmd.reply = true; break;
+			}
+		}
+	}
+	cmdCount = n;
+}
+
+
+// === RPC stream =============================================================
+
+CDtbEmulator::CDtbEmulator()
+{
+	InitCmdList();
+	m_open = false;
+	m_latency = 0;
+	m_inPos = m_outPos = 0;
+	m_rocAddr = 0;
+	m_power = m_hv = m_reset = m_addrInverted = false;
+	m_vd = m_va = m_id = m_ia = 0;
+	memset(m_pg, 0, sizeof(m_pg));
+	m_pgLoopPeriod = 0;
+	m_pgLoopStart = m_pgLoopDone = 0;
+	m_daqSize = 0;
+	m_daqOpen = m_daqRunning = m_daqOverflow = false;
+}
+
+
+// name: "emulator[:key=value,...]" with the keys
+//   rocs      number of ROCs (I2C addresses 0..rocs-1)       [1]
+//   thr       mean pixel threshold in Vcal DAC units         [60]
+//   thrsigma  pixel to pixel threshold spread                [4]
+//   noise     noise per trigger in Vcal DAC units            [1.5]
+//   dead      fraction of dead pixels                        [0]
+//   phgain    relative pulse height gain spread              [0.05]
+//   nobump    fraction of pixels without bump bond           [0]
+//   seed      random seed                                    [1]
+//   latency   simulated round trip time in us                [0]
+// A trigger reads out all ROCs, each with its header, in address order.
+bool CDtbEmulator::Open(const char *name)
+{
+	Close();
+	CRocModelSettings settings;
+	unsigned int nRocs = 1;
+	unsigned long seed = 1;
+	uint32_t latency = 0;
+
+	string s(name);
+	size_t pos = s.find(':');
+	while (pos != string::npos)
+	{
+		size_t end = s.find(',', pos + 1);
+		string item = s.substr(pos + 1, end == string::npos ? string::npos : end - pos - 1);
+		pos = end;
+		if (item.empty()) continue;
+		size_t eq = item.find('=');
+		if (eq == string::npos) { m_error = "emulator: missing value for '" + item + "'"; return false; }
+		string key = item.substr(0, eq);
+		double value = atof(item.c_str() + eq + 1);
+		if      (key == "rocs")     nRocs = (unsigned int)value;
+		else if (key == "thr")      settings.thrMean = value;
+		else if (key == "thrsigma") settings.thrSigma = value;
+		else if (key == "noise")    settings.noise = value;
+		else if (key == "dead")     settings.dead = value;
+		else if (key == "phgain")   settings.phGain = value;
+		else if (key == "nobump")   settings.noBump = value;
+		else if (key == "seed")     seed = (unsigned long)value;
+		else if (key == "latency")  latency = (uint32_t)value;
+		else { m_error = "emulator: unknown setting '" + key + "'"; return false; }
+	}
+	if (nRocs < 1 || nRocs > 16) { m_error = "emulator: rocs must be 1..16"; return false; }
+
+	m_settings = settings;
+	m_latency = latency;
+	m_rnd.Seed(seed);
+	m_roc.assign(nRocs, CRocModel());
+	for (unsigned int i = 0; i < nRocs; i++) m_roc[i].Configure(m_settings, m_rnd);
+
+	m_rocAddr = 0;
+	m_power = m_hv = m_reset = m_addrInverted = false;
+	m_vd = m_va = m_id = m_ia = 0;
+	memset(m_pg, 0, sizeof(m_pg));
+	m_pgLoopPeriod = 0;
+	m_daqOpen = m_daqRunning = m_daqOverflow = false;
+	m_daq.clear();
+	m_error.clear();
+	m_open = true;
+	return true;
+}
+
+
+void CDtbEmulator::Close()
+{
+	Clear();
+	m_open = false;
+}
+
+
+bool CDtbEmulator::Show()
+{
+	printf("DTB emulator: %s\n", m_open ? "open" : "closed");
+	if (!m_open) return true;
+	printf("  %u ROC(s), threshold %.1f +- %.1f Vcal, noise %.1f Vcal, %.2f%% dead pixels\n",
+		(unsigned int)m_roc.size(), m_settings.thrMean, m_settings.thrSigma,
+		m_settings.noise, 100.0*m_settings.dead);
+	printf("  round trip latency %u us, DAQ buffer %u of %u words%s\n",
+		m_latency, (unsigned int)m_daq.size(), m_daqSize, m_daqOverflow ? " (overflow)" : "");
+	return true;
+}
+
+
+void CDtbEmulator::Write(const void *buffer, uint32_t size)
+{
+	if (!m_open) throw CRpcError(CRpcError::WRITE_ERROR);
+	const uint8_t *p = (const uint8_t*)buffer;
+	m_in.insert(m_in.end(), p, p + size);
+}
+
+
+void CDtbEmulator::Flush()
+{
+	if (!m_open) return;
+	bool replied = m_outPos < m_out.size();
+	while (Execute()) {}
+	if (m_inPos == m_in.size()) { m_in.clear(); m_inPos = 0; }
+	if (m_latency && !replied && m_outPos < m_out.size()) usleep(m_latency);
+}
+
+
+void CDtbEmulator::Clear()
+{
+	m_in.clear();
+	m_inPos = 0;
+	m_out.clear();
+	m_outPos = 0;
+}
+
+
+void CDtbEmulator::Read(void *buffer, uint32_t size)
+{
+	if (!m_open) throw CRpcError(CRpcError::READ_ERROR);
+	if (m_out.size() - m_outPos < size) Flush();
+	if (m_out.size() - m_outPos < size) throw CRpcError(CRpcError::READ_TIMEOUT);
+	memcpy(buffer, &m_out[m_outPos], size);
+	m_outPos += size;
+	if (m_outPos == m_out.size()) { m_out.clear(); m_outPos = 0; }
+}
+
+
+bool CDtbEmulator::Execute()
+{
+	unsigned int avail = m_in.size() - m_inPos;
+	if (avail < 4) return false;
+	const uint8_t *p = &m_in[m_inPos];
+
+	if (p[0] == 0xC1)
+	{ // data block without command, skip it
+		unsigned int size = p[2] | (p[3] << 8);
+		if (avail < 4 + size) return false;
+		m_inPos += 4 + size;
+		return true;
+	}
+	if (p[0] != 0xC0)
+	{ // out of step, drop the stream
+		m_inPos = m_in.size();
+		return false;
+	}
+
+	uint16_t cmd = p[1] | (p[2] << 8);
+	unsigned int size = p[3];
+	if (avail < 4 + size) return false;
+	if (cmd >= cmdCount)
+	{
+		m_inPos += 4 + size;
+		return true;
+	}
+
+	// the command is complete once all its input blocks are there
+	CEmuCall c;
+	unsigned int pos = 4 + size;
+	for (unsigned int i = 0; i < cmdList[cmd].dataIn; i++)
+	{
+		if (avail < pos + 4) return false;
+		unsigned int dsize = p[pos+2] | (p[pos+3] << 8);
+		if (avail < pos + 4 + dsize) return false;
+		c.m_dataIn.push_back(string((const char*)p + pos + 4, dsize));
+		pos += 4 + dsize;
+	}
+
+	c.m_par = p + 4;
+	c.m_pos = 0;
+	c.m_size = size;
+	c.m_dataPos = 0;
+	m_inPos += pos;
+	(this->*cmdList[cmd].call)(c);
+	if (cmdList[cmd].reply) Reply(cmd, c);
+	return true;
+}
+
+
+void CDtbEmulator::PutData(uint8_t chn, const void *data, unsigned int size)
+{
+	if (size > 0xffff) size = 0xffff;
+	m_out.push_back(0xC1);
+	m_out.push_back(chn);
+	m_out.push_back(uint8_t(size));
+	m_out.push_back(uint8_t(size >> 8));
+	const uint8_t *p = (const uint8_t*)data;
+	m_out.insert(m_out.end(), p, p + size);
+}
+
+
+void CDtbEmulator::Reply(uint16_t cmd, CEmuCall &c)
+{
+	c.m_ret.resize(cmdList[cmd].retSize, 0);
+	m_out.push_back(0xC0);
+	m_out.push_back(uint8_t(cmd));
+	m_out.push_back(uint8_t(cmd >> 8));
+	m_out.push_back(uint8_t(c.m_ret.size()));
+	m_out.insert(m_out.end(), c.m_ret.begin(), c.m_ret.end());
+	for (unsigned int i = 0; i < c.m_dataOut.size(); i++)
+		PutData(0, c.m_dataOut[i].data(), c.m_dataOut[i].size());
+}
+
+
+// === pattern generator and DAQ ==============================================
+
+// number of triggers in the sequence, a burst (see CTestboard::Pg_Triggers)
+// holds several
+int CDtbEmulator::PgSequence(bool &cal)
+{
+	cal = false;
+	int trg = 0;
+	for (unsigned int i = 0; i < 256; i++)
+	{
+		if (m_pg[i] & EMU_PG_CAL) cal = true;
+		if (m_pg[i] & EMU_PG_TRG) trg++;
+		if ((m_pg[i] & 0xff) == 0) break;
+	}
+	return trg;
+}
+
+
+void CDtbEmulator::PgRun()
+{
+	bool cal;
+	int trg = PgSequence(cal);
+	if (!m_daqRunning) return;
+	// the whole token chain is read out, not only the addressed ROC
+	vector< vector<uint16_t> > addr(m_roc.size());
+	vector< vector<uint8_t> > ph(m_roc.size());
+	for (int t = 0; t < trg && !m_daqOverflow; t++)
+	{
+		if (cal) for (unsigned int i = 0; i < m_roc.size(); i++) m_roc[i].Trigger(m_rnd, addr[i], ph[i]);
+		DaqEvent(addr, ph);
+	}
+}
+
+
+// catch up with the sequences the looping pattern generator ran since the last call
+void CDtbEmulator::PgLoopUpdate()
+{
+	if (m_pgLoopPeriod == 0) return;
+	uint64_t due = (emu_Now() - m_pgLoopStart) / (uint64_t(m_pgLoopPeriod)*25);
+	uint64_t n = due - m_pgLoopDone;
+	if (n > 100000) n = 100000;
+	m_pgLoopDone = due;
+	for (uint64_t i = 0; i < n && !m_daqOverflow; i++) PgRun();
+}
+
+
+// readout of one trigger in the deser160 format: per ROC the header 0x7F8,
+// then two 12 bit words per pixel. The first header flags the event start.
+void CDtbEmulator::DaqEvent(const vector< vector<uint16_t> > &addr, const vector< vector<uint8_t> > &ph)
+{
+	size_t size = 0;
+	for (unsigned int k = 0; k < addr.size(); k++) size += 1 + 2*addr[k].size();
+	if (m_daq.size() + size > m_daqSize)
+	{
+		m_daqOverflow = true;
+		return;
+	}
+	for (unsigned int k = 0; k < addr.size(); k++)
+	{
+		m_daq.push_back(k == 0 ? 0x87f8 : 0x07f8);
+		for (unsigned int i = 0; i < addr[k].size(); i++)
+		{
+			unsigned int col = addr[k][i] >> 8, row = addr[k][i] & 0xff;
+			unsigned int c = col/2, r = 2*(CRocModel::NROW - row) + (col & 1);
+			uint32_t raw = ((c/6) << 12) | ((c%6) << 9) | ((r/36) << 6) | (((r/6)%6) << 3) | (r%6);
+			raw = (raw << 9) | ((ph[k][i] & 0xf0) << 1) | (ph[k][i] & 0x0f);
+			m_daq.push_back((raw >> 12) & 0xfff);
+			m_daq.push_back(raw & 0xfff);
+		}
+	}
+}
+
+
+int CDtbEmulator::CountReadouts(int nTriggers)
+{
+	bool cal;
+	if (!PgSequence(cal) || !cal) return 0;
+	vector<uint16_t> addr;
+	vector<uint8_t> ph;
+	int n = 0;
+	for (int i = 0; i < nTriggers; i++)
+	{
+		Roc().Trigger(m_rnd, addr, ph);
+		if (!addr.empty()) n++;
+	}
+	return n;
+}
+
+
+// mean pulse height of a pixel, 7777 if it never responds
+int CDtbEmulator::PulseHeight(int col, int row, int nTriggers)
+{
+	bool cal;
+	if (!PgSequence(cal) || !cal) return 7777;
+	uint16_t pixel = uint16_t((col << 8) | row);
+	vector<uint16_t> addr;
+	vector<uint8_t> ph;
+	int n = 0, sum = 0;
+	for (int i = 0; i < nTriggers; i++)
+	{
+		Roc().Trigger(m_rnd, addr, ph);
+		for (unsigned int k = 0; k < addr.size(); k++)
+			if (addr[k] == pixel) { sum += ph[k]; n++; break; }
+	}
+	return n ? sum / n : 7777;
+}
+
+
+int CDtbEmulator::PixelThreshold(int col, int row, int start, int step, int thrLevel,
+	int nTrig, int dacReg, int xtalk, int cals, int trim)
+{
+	CRocModel &roc = Roc();
+	uint8_t dacSave = roc.GetDAC(dacReg);
+	int calRow = row;
+	if (xtalk) calRow = (row == CRocModel::NROW - 1) ? row - 1 : row + 1;
+	roc.PixTrim(col, row, trim);
+	roc.PixCal(col, calRow, cals != 0);
+
+	// walk from start against the step direction while above the level,
+	// otherwise along it until the level is reached
+	int dac = start;
+	if (dac < 0) dac = 0; else if (dac > 255) dac = 255;
+	roc.SetDAC(dacReg, dac);
+	if (CountReadouts(nTrig) > thrLevel)
+	{
+		while (true)
+		{
+			int next = dac - step;
+			if (next < 0 || next > 255) break;
+			roc.SetDAC(dacReg, next);
+			if (CountReadouts(nTrig) <= thrLevel) break;
+			dac = next;
+		}
+	}
+	else
+	{
+		while (true)
+		{
+			dac += step;
+			if (dac < 0) { dac = 0; break; }
+			if (dac > 255) { dac = 255; break; }
+			roc.SetDAC(dacReg, dac);
+			if (CountReadouts(nTrig) > thrLevel) break;
+		}
+	}
+
+	roc.SetDAC(dacReg, dacSave);
+	roc.ClrCal();
+	roc.PixMask(col, row);
+	return dac;
+}
+
+
+// === RPC calls ==============================================================
+
+void CDtbEmulator::rpc_Void(CEmuCall &c) {}
+
+void CDtbEmulator::rpc_GetRpcVersion(CEmuCall &c) { c.Put_UINT16(0x0100); }
+
+void CDtbEmulator::rpc_GetRpcCallId(CEmuCall &c)
+{
+	const string &name = c.Get_Data();
+	for (unsigned int i = 0; i < cmdCount; i++)
+		if (name == cmdList[i].name) { c.Put_INT32(i); return; }
+	c.Put_INT32(-1);
+}
+
+void CDtbEmulator::rpc_GetRpcTimestamp(CEmuCall &c) { c.Put_Data(string("emulator")); }
+
+void CDtbEmulator::rpc_GetRpcCallCount(CEmuCall &c) { c.Put_INT32(cmdCount); }
+
+void CDtbEmulator::rpc_GetRpcCallName(CEmuCall &c)
+{
+	int32_t id = c.Get_INT32();
+	bool ok = id >= 0 && (unsigned int)id < cmdCount;
+	c.Put_BOOL(ok);
+	c.Put_Data(string(ok ? cmdList[id].name : ""));
+}
+
+void CDtbEmulator::rpc_GetInfo(CEmuCall &c)
+{
+	char s[256];
+	snprintf(s, sizeof(s),
+		"Board id:    0\n"
+		"HW version:  DTB emulator\n"
+		"FW version:  1.0\n"
+		"SW version:  1.0\n"
+		"ROCs:        %u\n", (unsigned int)m_roc.size());
+	c.Put_Data(string(s));
+}
+
+void CDtbEmulator::rpc_GetBoardId(CEmuCall &c) { c.Put_UINT16(0); }
+void CDtbEmulator::rpc_GetHWVersion(CEmuCall &c) { c.Put_Data(string("DTB emulator")); }
+void CDtbEmulator::rpc_GetFWVersion(CEmuCall &c) { c.Put_UINT16(0x0100); }
+void CDtbEmulator::rpc_GetSWVersion(CEmuCall &c) { c.Put_UINT16(0x0100); }
+
+void CDtbEmulator::rpc_UpgradeGetVersion(CEmuCall &c) { c.Put_UINT16(0x0100); }
+void CDtbEmulator::rpc_UpgradeStart(CEmuCall &c) { c.Put_UINT8(1); }
+void CDtbEmulator::rpc_UpgradeData(CEmuCall &c) { c.Put_UINT8(1); }
+void CDtbEmulator::rpc_UpgradeError(CEmuCall &c) { c.Put_UINT8(1); }
+void CDtbEmulator::rpc_UpgradeErrorMsg(CEmuCall &c) { c.Put_Data(string("the emulator cannot be upgraded")); }
+
+void CDtbEmulator::rpc_Init(CEmuCall &c)
+{
+	m_power = m_hv = m_reset = false;
+	memset(m_pg, 0, sizeof(m_pg));
+	m_pgLoopPeriod = 0;
+	m_daqOpen = m_daqRunning = m_daqOverflow = false;
+	m_daq.clear();
+}
+
+void CDtbEmulator::rpc_Pon(CEmuCall &c)
+{
+	if (!m_power) for (unsigned int i = 0; i < m_roc.size(); i++) m_roc[i].Reset();
+	m_power = true;
+}
+
+void CDtbEmulator::rpc_Poff(CEmuCall &c) { m_power = false; }
+void CDtbEmulator::rpc_SetVD(CEmuCall &c) { m_vd = c.Get_UINT16(); }
+void CDtbEmulator::rpc_SetVA(CEmuCall &c) { m_va = c.Get_UINT16(); }
+void CDtbEmulator::rpc_SetID(CEmuCall &c) { m_id = c.Get_UINT16(); }
+void CDtbEmulator::rpc_SetIA(CEmuCall &c) { m_ia = c.Get_UINT16(); }
+void CDtbEmulator::rpc_GetVD(CEmuCall &c) { c.Put_UINT16(m_power ? m_vd : 0); }
+void CDtbEmulator::rpc_GetVA(CEmuCall &c) { c.Put_UINT16(m_power ? m_va : 0); }
+
+// currents in units of 100 uA
+void CDtbEmulator::rpc_GetID(CEmuCall &c)
+{
+	c.Put_UINT16(m_power ? uint16_t(250*m_roc.size()) : 0);
+}
+
+void CDtbEmulator::rpc_GetIA(CEmuCall &c)
+{
+	double ia = 0;
+	if (m_power) for (unsigned int i = 0; i < m_roc.size(); i++) ia += m_roc[i].Current();
+	c.Put_UINT16(uint16_t(10*ia + 0.5));
+}
+
+void CDtbEmulator::rpc_HVon(CEmuCall &c) { m_hv = true; }
+void CDtbEmulator::rpc_HVoff(CEmuCall &c) { m_hv = false; }
+void CDtbEmulator::rpc_ResetOn(CEmuCall &c) { m_reset = true; }
+void CDtbEmulator::rpc_ResetOff(CEmuCall &c) { m_reset = false; }
+void CDtbEmulator::rpc_GetStatus(CEmuCall &c) { c.Put_UINT8(0); }
+
+void CDtbEmulator::rpc_Pg_SetCmd(CEmuCall &c)
+{
+	uint16_t addr = c.Get_UINT16();
+	uint16_t cmd = c.Get_UINT16();
+	if (addr < 256) m_pg[addr] = cmd;
+}
+
+void CDtbEmulator::rpc_Pg_Stop(CEmuCall &c)
+{
+	PgLoopUpdate();
+	m_pgLoopPeriod = 0;
+}
+
+void CDtbEmulator::rpc_Pg_Single(CEmuCall &c) { PgRun(); }
+
+void CDtbEmulator::rpc_Pg_Loop(CEmuCall &c)
+{
+	PgLoopUpdate();
+	m_pgLoopPeriod = c.Get_UINT16();
+	m_pgLoopStart = emu_Now();
+	m_pgLoopDone = 0;
+}
+
+void CDtbEmulator::rpc_Daq_Open(CEmuCall &c)
+{
+	m_daqSize = c.Get_UINT32();
+	m_daqOpen = true;
+	m_daqRunning = m_daqOverflow = false;
+	m_daq.clear();
+	c.Put_UINT32(m_daqSize);
+}
+
+void CDtbEmulator::rpc_Daq_Close(CEmuCall &c)
+{
+	m_daqOpen = m_daqRunning = false;
+	m_daq.clear();
+}
+
+void CDtbEmulator::rpc_Daq_Start(CEmuCall &c) { if (m_daqOpen) m_daqRunning = true; }
+
+void CDtbEmulator::rpc_Daq_Stop(CEmuCall &c)
+{
+	PgLoopUpdate();
+	m_daqRunning = false;
+}
+
+void CDtbEmulator::rpc_Daq_GetSize(CEmuCall &c)
+{
+	PgLoopUpdate();
+	c.Put_UINT32(m_daq.size());
+}
+
+void CDtbEmulator::rpc_Daq_Read(CEmuCall &c)
+{
+	PgLoopUpdate();
+	unsigned int n = c.Get_UINT16();
+	if (n > m_daq.size()) n = m_daq.size();
+	if (n > EMU_MAXBLOCK) n = EMU_MAXBLOCK;
+	string block(2*n, 0);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		block[2*i]   = char(m_daq[i]);
+		block[2*i+1] = char(m_daq[i] >> 8);
+	}
+	m_daq.erase(m_daq.begin(), m_daq.begin() + n);
+	c.Put_UINT8(m_daqOverflow ? 1 : 0);
+	c.Put_Data(block);
+}
+
+void CDtbEmulator::rpc_Daq_ReadAvail(CEmuCall &c)
+{
+	CEmuCall r;
+	r.m_par = c.m_par;
+	r.m_pos = 0;
+	r.m_size = 2;
+	rpc_Daq_Read(r);
+	c.Put_UINT8(r.m_ret[0]);
+	c.Put_UINT32(m_daq.size());
+	c.Put_Data(r.m_dataOut[0]);
+}
+
+void CDtbEmulator::rpc_roc_I2cAddr(CEmuCall &c) { m_rocAddr = c.Get_UINT8(); }
+void CDtbEmulator::rpc_roc_ClrCal(CEmuCall &c) { Roc().ClrCal(); }
+
+void CDtbEmulator::rpc_roc_SetDAC(CEmuCall &c)
+{
+	uint8_t reg = c.Get_UINT8();
+	uint8_t value = c.Get_UINT8();
+	Roc().SetDAC(reg, value);
+}
+
+void CDtbEmulator::rpc_roc_Pix(CEmuCall &c)
+{
+	uint8_t col = c.Get_UINT8();
+	uint8_t row = c.Get_UINT8();
+	uint8_t value = c.Get_UINT8();
+	Roc().Pix(col, row, value);
+}
+
+void CDtbEmulator::rpc_roc_Pix_Trim(CEmuCall &c)
+{
+	uint8_t col = c.Get_UINT8();
+	uint8_t row = c.Get_UINT8();
+	uint8_t value = c.Get_UINT8();
+	Roc().PixTrim(col, row, value);
+}
+
+void CDtbEmulator::rpc_roc_Pix_Mask(CEmuCall &c)
+{
+	uint8_t col = c.Get_UINT8();
+	uint8_t row = c.Get_UINT8();
+	Roc().PixMask(col, row);
+}
+
+void CDtbEmulator::rpc_roc_Pix_Cal(CEmuCall &c)
+{
+	uint8_t col = c.Get_UINT8();
+	uint8_t row = c.Get_UINT8();
+	bool sensor = c.Get_BOOL();
+	Roc().PixCal(col, row, sensor);
+}
+
+void CDtbEmulator::rpc_roc_Col_Enable(CEmuCall &c)
+{
+	uint8_t col = c.Get_UINT8();
+	bool on = c.Get_BOOL();
+	Roc().ColEnable(col, on);
+}
+
+void CDtbEmulator::rpc_roc_Col_Mask(CEmuCall &c) { Roc().ColMask(c.Get_UINT8()); }
+void CDtbEmulator::rpc_roc_Chip_Mask(CEmuCall &c) { Roc().ChipMask(); }
+
+void CDtbEmulator::rpc_TBM_Present(CEmuCall &c) { c.Put_BOOL(false); }
+
+void CDtbEmulator::rpc_tbm_Get(CEmuCall &c)
+{
+	c.Get_UINT8();
+	c.Put_BOOL(false);
+	c.Put_UINT8(0);
+}
+
+void CDtbEmulator::rpc_tbm_GetRaw(CEmuCall &c)
+{
+	c.Get_UINT8();
+	c.Put_BOOL(false);
+	c.Put_UINT32(0);
+}
+
+void CDtbEmulator::rpc_GetPixelAddressInverted(CEmuCall &c) { c.Put_BOOL(m_addrInverted); }
+void CDtbEmulator::rpc_SetPixelAddressInverted(CEmuCall &c) { m_addrInverted = c.Get_BOOL(); }
+
+void CDtbEmulator::rpc_CountReadouts(CEmuCall &c)
+{
+	int32_t nTriggers = c.Get_INT32();
+	c.Put_INT32(CountReadouts(nTriggers));
+}
+
+void CDtbEmulator::rpc_CountReadoutsChip(CEmuCall &c)
+{
+	int32_t nTriggers = c.Get_INT32();
+	int32_t chipId = c.Get_INT32();
+	unsigned int addr = m_rocAddr;
+	m_rocAddr = chipId;
+	c.Put_INT32(CountReadouts(nTriggers));
+	m_rocAddr = addr;
+}
+
+void CDtbEmulator::rpc_CountReadoutsDac(CEmuCall &c)
+{
+	int32_t nTriggers = c.Get_INT32();
+	int32_t dacReg = c.Get_INT32();
+	int32_t dacValue = c.Get_INT32();
+	Roc().SetDAC(dacReg, dacValue);
+	c.Put_INT32(CountReadouts(nTriggers));
+}
+
+void CDtbEmulator::rpc_PH(CEmuCall &c)
+{
+	int32_t col = c.Get_INT32();
+	int32_t row = c.Get_INT32();
+	int32_t trim = c.Get_INT32();
+	int16_t nTriggers = c.Get_INT16();
+
+	CRocModel &roc = Roc();
+	bool colEnabled = roc.ColEnabled(col);
+	roc.ColEnable(col, true);
+	roc.PixTrim(col, row, trim);
+	roc.PixCal(col, row, false);
+	c.Put_INT32(PulseHeight(col, row, nTriggers));
+	roc.PixMask(col, row);
+	roc.ClrCal();
+	roc.ColEnable(col, colEnabled);
+}
+
+void CDtbEmulator::rpc_PixelThreshold(CEmuCall &c)
+{
+	int32_t p[10];
+	for (int i = 0; i < 10; i++) p[i] = c.Get_INT32();
+	c.Put_INT32(PixelThreshold(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9]));
+}
+
+void CDtbEmulator::rpc_test_pixel_address(CEmuCall &c)
+{
+	int32_t col = c.Get_INT32();
+	int32_t row = c.Get_INT32();
+
+	CRocModel &roc = Roc();
+	bool colEnabled = roc.ColEnabled(col);
+	roc.ColEnable(col, true);
+	roc.PixTrim(col, row, 15);
+	roc.PixCal(col, row, false);
+	bool ok = PulseHeight(col, row, 1) != 7777;
+	roc.PixMask(col, row);
+	roc.ClrCal();
+	roc.ColEnable(col, colEnabled);
+	c.Put_BOOL(ok);
+}
+
+// Vcal threshold of each pixel of a column with only one trim bit set
+// (trimbit > 3: untrimmed)
+void CDtbEmulator::rpc_testColPixel(CEmuCall &c)
+{
+	uint8_t col = c.Get_UINT8();
+	uint8_t trimbit = c.Get_UINT8();
+	if (col >= CRocModel::NCOL) { c.Put_BOOL(false); c.Put_Data(string()); return; }
+
+	CRocModel &roc = Roc();
+	bool colEnabled = roc.ColEnabled(col);
+	roc.ColEnable(col, true);
+	int trim = trimbit < 4 ? 15 ^ (1 << trimbit) : 15;
+	string res(CRocModel::NROW, 0);
+	for (int row = 0; row < CRocModel::NROW; row++)
+		res[row] = char(PixelThreshold(col, row, 0, 1, 0, 1, EMU_VCAL, 0, 0, trim));
+	roc.ColEnable(col, colEnabled);
+	c.Put_BOOL(true);
+	c.Put_Data(res);
+}
+
+void CDtbEmulator::rpc_Ethernet_RecvPackets(CEmuCall &c) { c.Put_UINT32(0); }
@@ -0,0 +1,287 @@
+// Software model of the digital testboard (DTB) with PSI46dig ROCs.
+// CDtbEmulator is a CRpcIo backend: it decodes the rpcMessage stream written
+// by CTestboard, executes the calls on an in-process model of the board and
+// queues the replies for Read(). It lets the tests run without hardware and
+// gives a link independent baseline for host side timing.
+//
+// The board is selected with the testboard name "emulator", optionally
+// followed by settings, e.g. "emulator:rocs=4,thr=60,noise=2,dead=0.001".
+// See CDtbEmulator::Open() for the list.
+
+#ifndef DTBEMULATOR_H
+#define DTBEMULATOR_H
+
+#include "rpc_io.h"
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+
+// --- random numbers (reproducible for a given seed) -------------------------
+
+class CEmuRandom
+{
+	uint64_t m_state;
+	bool m_haveGauss;
+	double m_gauss;
+public:
+	CEmuRandom(uint64_t seed = 1) { Seed(seed); }
+	void Seed(uint64_t seed) { m_state = seed ? seed : 0x2545F4914F6CDD1DULL; m_haveGauss = false; }
+	uint64_t Next()
+	{
+		m_state ^= m_state >> 12; m_state ^= m_state << 25; m_state ^= m_state >> 27;
+		return m_state * 0x2545F4914F6CDD1DULL;
+	}
+	double Uniform() { return (Next() >> 11) * (1.0/9007199254740992.0); }
+	double Gauss();
+};
+
+
+// --- PSI46dig readout chip ---------------------------------------------------
+
+struct CRocModelSettings
+{
+	double thrMean;   // pixel threshold in low range Vcal DAC units (default DACs)
+	double thrSigma;  // pixel to pixel threshold spread
+	double noise;     // per trigger noise in Vcal DAC units
+	double dead;      // fraction of dead pixels
+	double phGain;    // pulse height gain spread (relative)
+	double noBump;    // fraction of pixels without bump bond to the sensor
+
+	CRocModelSettings() : thrMean(60.0), thrSigma(4.0), noise(1.5), dead(0.0), phGain(0.05), noBump(0.0) {}
+};
+
+
+class CRocModel
+{
+public:
+	enum { NCOL = 52, NROW = 80, NPIX = NCOL*NROW };
+
+private:
+	uint8_t m_dac[256];
+	bool m_colEnable[NCOL/2];
+	uint8_t m_trim[NPIX];
+	bool m_masked[NPIX];
+	std::vector<uint16_t> m_cal;  // pixels with calibrate set
+	bool m_isCal[NPIX];
+	bool m_calSensor[NPIX];       // calibrate through the sensor, not directly
+
+	float m_thr[NPIX];    // threshold at the reference DACs
+	float m_gain[NPIX];   // relative pulse height gain
+	bool m_dead[NPIX];
+	bool m_noBump[NPIX];  // sensor calibrate does not reach the pixel
+	double m_noise;
+
+	double Threshold(unsigned int pix);
+	void Hit(unsigned int pix, double q, CEmuRandom &rnd,
+		std::vector<uint16_t> &addr, std::vector<uint8_t> &ph);
+public:
+	CRocModel() { Reset(); }
+	void Configure(const CRocModelSettings &s, CEmuRandom &rnd);
+	void Reset();
+
+	// configuration as sent over the control link
+	void SetDAC(uint8_t reg, uint8_t value) { m_dac[reg] = value; }
+	uint8_t GetDAC(uint8_t reg) { return m_dac[reg]; }
+	void Pix(uint8_t col, uint8_t row, uint8_t value);
+	void PixTrim(uint8_t col, uint8_t row, uint8_t value);
+	void PixMask(uint8_t col, uint8_t row);
+	void PixCal(uint8_t col, uint8_t row, bool sensor);
+	void ClrCal();
+	void ColEnable(uint8_t col, bool on) { if (col < NCOL) m_colEnable[col/2] = on; }
+	bool ColEnabled(uint8_t col) { return col < NCOL && m_colEnable[col/2]; }
+	void ColMask(uint8_t col);
+	void ChipMask();
+
+	// direct access for test setups
+	void SetDead(uint8_t col, uint8_t row, bool dead = true);
+	void SetNoBump(uint8_t col, uint8_t row, bool noBump = true);
+	void SetThreshold(uint8_t col, uint8_t row, double thr);
+
+	// hit pixels of one calibrate + trigger: (col << 8 | row) and pulse height
+	void Trigger(CEmuRandom &rnd, std::vector<uint16_t> &addr, std::vector<uint8_t> &ph);
+	double Current();  // analog current in mA
+};
+
+
+// --- board -------------------------------------------------------------------
+
+class CDtbEmulator;
+
+// one decoded call: parameters in, results out
+class CEmuCall
+{
+	friend class CDtbEmulator;
+	const uint8_t *m_par;
+	unsigned int m_pos, m_size;
+	std::vector<std::string> m_dataIn;
+	unsigned int m_dataPos;
+	std::vector<uint8_t> m_ret;
+	std::vector<std::string> m_dataOut;
+	uint8_t Par() { return m_pos < m_size ? m_par[m_pos++] : 0; }
+public:
+	uint8_t  Get_UINT8()  { return Par(); }
+	int8_t   Get_INT8()   { return int8_t(Par()); }
+	bool     Get_BOOL()   { return Par() != 0; }
+	uint16_t Get_UINT16() { uint16_t x = Par(); return x | (uint16_t(Par()) << 8); }
+	int16_t  Get_INT16()  { return int16_t(Get_UINT16()); }
+	uint32_t Get_UINT32() { uint32_t x = Get_UINT16(); return x | (uint32_t(Get_UINT16()) << 16); }
+	int32_t  Get_INT32()  { return int32_t(Get_UINT32()); }
+	const std::string& Get_Data() { static const std::string empty; return m_dataPos < m_dataIn.size() ? m_dataIn[m_dataPos++] : empty; }
+
+	void Put_UINT8(uint8_t x)   { m_ret.push_back(x); }
+	void Put_BOOL(bool x)       { Put_UINT8(x ? 1 : 0); }
+	void Put_UINT16(uint16_t x) { Put_UINT8(uint8_t(x)); Put_UINT8(uint8_t(x >> 8)); }
+	void Put_INT16(int16_t x)   { Put_UINT16(uint16_t(x)); }
+	void Put_UINT32(uint32_t x) { Put_UINT16(uint16_t(x)); Put_UINT16(uint16_t(x >> 16)); }
+	void Put_INT32(int32_t x)   { Put_UINT32(uint32_t(x)); }
+	void Put_Data(const void *x, unsigned int size) { m_dataOut.push_back(std::string((const char*)x, size)); }
+	void Put_Data(const std::string &x) { m_dataOut.push_back(x); }
+};
+
+
+class CDtbEmulator : public CRpcIo
+{
+	typedef void (CDtbEmulator::*rpcHandler)(CEmuCall &c);
+	struct CCmd
+	{
+		const char *name;
+		rpcHandler call;
+		unsigned int parSize;  // bytes of value and reference parameters
+		unsigned int dataIn;   // # of vector/string input blocks
+		unsigned int retSize;  // bytes of return value and references
+		bool reply;
+	};
+	static CCmd cmdList[];
+	static unsigned int cmdCount;
+	static void InitCmdList();
+
+	bool m_open;
+	std::string m_error;
+	uint32_t m_latency;  // us per round trip
+	std::vector<uint8_t> m_in;   // written by the host, not yet executed
+	unsigned int m_inPos;
+	std::vector<uint8_t> m_out;  // replies, not yet read by the host
+	unsigned int m_outPos;
+
+	// board state
+	CEmuRandom m_rnd;
+	CRocModelSettings m_settings;
+	std::vector<CRocModel> m_roc;
+	unsigned int m_rocAddr;
+	bool m_power, m_hv, m_reset, m_addrInverted;
+	uint16_t m_vd, m_va, m_id, m_ia;
+	uint16_t m_pg[256];
+	uint16_t m_pgLoopPeriod;  // 0: not looping
+	uint64_t m_pgLoopStart, m_pgLoopDone;
+	uint32_t m_daqSize;
+	bool m_daqOpen, m_daqRunning, m_daqOverflow;
+	std::deque<uint16_t> m_daq;
+
+	bool Execute();  // runs the next complete call, false if none
+	void Reply(uint16_t cmd, CEmuCall &c);
+	void PutData(uint8_t chn, const void *data, unsigned int size);
+
+	CRocModel& Roc() { return m_roc[m_rocAddr < m_roc.size() ? m_rocAddr : 0]; }
+	int PgSequence(bool &cal);
+	void PgRun();
+	void PgLoopUpdate();
+	void DaqEvent(const std::vector< std::vector<uint16_t> > &addr,
+		const std::vector< std::vector<uint8_t> > &ph);
+	int CountReadouts(int nTriggers);
+	int PulseHeight(int col, int row, int nTriggers);
+	int PixelThreshold(int col, int row, int start, int step, int thrLevel,
+		int nTrig, int dacReg, int xtalk, int cals, int trim);
+
+	// RPC calls
+	void rpc_GetRpcVersion(CEmuCall &c);
+	void rpc_GetRpcCallId(CEmuCall &c);
+	void rpc_GetRpcTimestamp(CEmuCall &c);
+	void rpc_GetRpcCallCount(CEmuCall &c);
+	void rpc_GetRpcCallName(CEmuCall &c);
+	void rpc_GetInfo(CEmuCall &c);
+	void rpc_GetBoardId(CEmuCall &c);
+	void rpc_GetHWVersion(CEmuCall &c);
+	void rpc_GetFWVersion(CEmuCall &c);
+	void rpc_GetSWVersion(CEmuCall &c);
+	void rpc_UpgradeGetVersion(CEmuCall &c);
+	void rpc_UpgradeStart(CEmuCall &c);
+	void rpc_UpgradeData(CEmuCall &c);
+	void rpc_UpgradeError(CEmuCall &c);
+	void rpc_UpgradeErrorMsg(CEmuCall &c);
+	void rpc_Init(CEmuCall &c);
+	void rpc_Void(CEmuCall &c);
+	void rpc_Pon(CEmuCall &c);
+	void rpc_Poff(CEmuCall &c);
+	void rpc_SetVD(CEmuCall &c);
+	void rpc_SetVA(CEmuCall &c);
+	void rpc_SetID(CEmuCall &c);
+	void rpc_SetIA(CEmuCall &c);
+	void rpc_GetVD(CEmuCall &c);
+	void rpc_GetVA(CEmuCall &c);
+	void rpc_GetID(CEmuCall &c);
+	void rpc_GetIA(CEmuCall &c);
+	void rpc_HVon(CEmuCall &c);
+	void rpc_HVoff(CEmuCall &c);
+	void rpc_ResetOn(CEmuCall &c);
+	void rpc_ResetOff(CEmuCall &c);
+	void rpc_GetStatus(CEmuCall &c);
+	void rpc_Pg_SetCmd(CEmuCall &c);
+	void rpc_Pg_Stop(CEmuCall &c);
+	void rpc_Pg_Single(CEmuCall &c);
+	void rpc_Pg_Loop(CEmuCall &c);
+	void rpc_Daq_Open(CEmuCall &c);
+	void rpc_Daq_Close(CEmuCall &c);
+	void rpc_Daq_Start(CEmuCall &c);
+	void rpc_Daq_Stop(CEmuCall &c);
+	void rpc_Daq_GetSize(CEmuCall &c);
+	void rpc_Daq_Read(CEmuCall &c);
+	void rpc_Daq_ReadAvail(CEmuCall &c);
+	void rpc_roc_I2cAddr(CEmuCall &c);
+	void rpc_roc_ClrCal(CEmuCall &c);
+	void rpc_roc_SetDAC(CEmuCall &c);
+	void rpc_roc_Pix(CEmuCall &c);
+	void rpc_roc_Pix_Trim(CEmuCall &c);
+	void rpc_roc_Pix_Mask(CEmuCall &c);
+	void rpc_roc_Pix_Cal(CEmuCall &c);
+	void rpc_roc_Col_Enable(CEmuCall &c);
+	void rpc_roc_Col_Mask(CEmuCall &c);
+	void rpc_roc_Chip_Mask(CEmuCall &c);
+	void rpc_TBM_Present(CEmuCall &c);
+	void rpc_tbm_Get(CEmuCall &c);
+	void rpc_tbm_GetRaw(CEmuCall &c);
+	void rpc_GetPixelAddressInverted(CEmuCall &c);
+	void rpc_SetPixelAddressInverted(CEmuCall &c);
+	void rpc_CountReadouts(CEmuCall &c);
+	void rpc_CountReadoutsChip(CEmuCall &c);
+	void rpc_CountReadoutsDac(CEmuCall &c);
+	void rpc_PH(CEmuCall &c);
+	void rpc_PixelThreshold(CEmuCall &c);
+	void rpc_test_pixel_address(CEmuCall &c);
+	void rpc_testColPixel(CEmuCall &c);
+	void rpc_Ethernet_RecvPackets(CEmuCall &c);
+
+public:
+	CDtbEmulator();
+	~CDtbEmulator() {}
+
+	bool Open(const char *name);
+	bool Connected() { return m_open; }
+	const char* GetErrorMsg() { return m_error.c_str(); }
+	bool Show();
+
+	unsigned int GetRocCount() { return m_roc.size(); }
+	CRocModel& GetRoc(unsigned int i) { return m_roc[i]; }
+	void SetLatency(uint32_t us) { m_latency = us; }
+
+	// CRpcIo
+	void Write(const void *buffer, uint32_t size);
+	void Flush();
+	void Clear();
+	void Read(void *buffer, uint32_t size);
+	void Close();
+};
+
+#endif
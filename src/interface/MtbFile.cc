@@ -0,0 +1,514 @@
+// MtbFile.cc
+
+#include "MtbFile.h"
+
+#include <string.h>
+#include <fstream>
+#include <iostream>
+
+
+static const char fileMagic[8] = { 'P', 'S', 'I', '4', '6', 'M', 'T', 'B' };
+static const uint32_t blockMagic = 0x4242544d; // "MTBB"
+static const uint32_t fileVersion = 2;
+static const unsigned int fileHeaderSize = 64;
+static const unsigned int blockHeaderSize = 24;
+static const unsigned int blockHeaderSizeV1 = 20; // without the header checksum
+static const uint32_t maxBlockBytes = 1 << 26;    // larger sizes in a header are damage
+
+enum { CODEC_STORED = 0, CODEC_WORDLZ = 1 };
+
+
+static inline void Put16(unsigned char *p, uint16_t x) { p[0] = x; p[1] = x >> 8; }
+static inline void Put32(unsigned char *p, uint32_t x) { Put16(p, x); Put16(p + 2, x >> 16); }
+static inline uint16_t Get16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+static inline uint32_t Get32(const unsigned char *p) { return Get16(p) | (uint32_t(Get16(p + 2)) << 16); }
+
+
+// == checksum ================================================================
+
+struct CCrc32Table
+{
+	uint32_t entry[256];
+	CCrc32Table()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			entry[i] = c;
+		}
+	}
+};
+
+
+uint32_t MtbCrc32(const void *data, size_t n, uint32_t crc)
+{
+	// built on the first call, thread safe: the writer thread and readers call this
+	static const CCrc32Table crcTable;
+	const uint32_t *table = crcTable.entry;
+
+	const unsigned char *p = (const unsigned char *)data;
+	crc = ~crc;
+	for (size_t i = 0; i < n; i++) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+
+// == word LZ =================================================================
+
+static const int hashBits = 13;
+static const size_t maxLiterals = 128;
+static const size_t minMatch = 2, maxMatch = 129;
+static const size_t maxDistance = 65535;
+
+
+static void PutLiterals(const uint16_t *in, size_t n, std::vector<unsigned char> &out)
+{
+	while (n > 0)
+	{
+		size_t k = n < maxLiterals ? n : maxLiterals;
+		size_t pos = out.size();
+		out.resize(pos + 1 + 2*k);
+		out[pos++] = k - 1;
+		for (size_t i = 0; i < k; i++, pos += 2) Put16(&out[pos], in[i]);
+		in += k;
+		n -= k;
+	}
+}
+
+
+void MtbCompress(const uint16_t *in, size_t n, std::vector<unsigned char> &out)
+{
+	std::vector<uint32_t> table(1 << hashBits, 0); // position + 1 of the last word pair
+	size_t i = 0, literals = 0;
+	while (i + minMatch <= n)
+	{
+		uint32_t key = in[i] | (uint32_t(in[i+1]) << 16);
+		uint32_t h = (key * 2654435761u) >> (32 - hashBits);
+		size_t candidate = table[h];
+		table[h] = i + 1;
+		if (candidate == 0 || i - (candidate - 1) > maxDistance
+			|| in[candidate-1] != in[i] || in[candidate] != in[i+1])
+		{
+			i++;
+			continue;
+		}
+
+		size_t from = candidate - 1, len = minMatch;
+		while (len < maxMatch && i + len < n && in[from + len] == in[i + len]) len++;
+
+		PutLiterals(in + literals, i - literals, out);
+		size_t pos = out.size();
+		out.resize(pos + 3);
+		out[pos] = 0x80 | (len - minMatch);
+		Put16(&out[pos + 1], i - from);
+		i += len;
+		literals = i;
+	}
+	PutLiterals(in + literals, n - literals, out);
+}
+
+
+bool MtbDecompress(const unsigned char *in, size_t size, size_t n, std::vector<uint16_t> &out)
+{
+	size_t begin = out.size(), end = begin + n;
+	out.reserve(end);
+	size_t pos = 0;
+	while (pos < size)
+	{
+		unsigned char c = in[pos++];
+		if (c < 0x80)
+		{
+			size_t k = c + 1;
+			if (pos + 2*k > size || out.size() + k > end) return false;
+			for (size_t i = 0; i < k; i++, pos += 2) out.push_back(Get16(in + pos));
+		}
+		else
+		{
+			size_t len = (c & 0x7f) + minMatch;
+			if (pos + 2 > size) return false;
+			size_t distance = Get16(in + pos);
+			pos += 2;
+			if (distance == 0 || distance > out.size() - begin || out.size() + len > end) return false;
+			size_t from = out.size() - distance;
+			for (size_t i = 0; i < len; i++) out.push_back(out[from + i]);
+		}
+	}
+	return out.size() == end;
+}
+
+
+// == writer ==================================================================
+
+CMtbWriter::CMtbWriter(size_t blockBytes, unsigned int maxQueued)
+	: m_file(0), m_blockBytes(blockBytes & ~size_t(1)), m_maxQueued(maxQueued ? maxQueued : 1),
+	  m_rawBytes(0), m_fileBytes(0), m_done(false), m_error(false), m_indexing(false)
+{
+	if (m_blockBytes == 0) m_blockBytes = 2;
+	if (m_blockBytes > maxBlockBytes) m_blockBytes = maxBlockBytes;
+}
+
+
+bool CMtbWriter::Open(const char *fileName, const CMtbHeader &header, bool index)
+{
+	Close();
+	m_file = fopen(fileName, "wb");
+	if (!m_file) return false;
+
+	unsigned char h[fileHeaderSize];
+	memset(h, 0, sizeof(h));
+	memcpy(h, fileMagic, sizeof(fileMagic));
+	Put32(h + 8, fileVersion);
+	Put32(h + 12, fileHeaderSize);
+	Put32(h + 16, header.runNumber);
+	Put16(h + 20, header.nRocs);
+	Put16(h + 22, header.dataFormat);
+	strncpy((char *)h + 24, header.boardId.c_str(), 32);
+	m_error = fwrite(h, sizeof(h), 1, m_file) != 1;
+
+	m_rawBytes = 0;
+	m_fileBytes = sizeof(h);
+	m_done = false;
+	m_indexing = index;
+	m_indexName = MtbIndexName(fileName);
+	m_index.SetFormat(header.dataFormat);
+	m_block.reserve(m_blockBytes);
+	m_thread = std::thread(&CMtbWriter::Run, this);
+	return !m_error;
+}
+
+
+void CMtbWriter::Write(const void *data, size_t bytes)
+{
+	if (!m_file) return;
+	const unsigned char *p = (const unsigned char *)data;
+	m_rawBytes += bytes;
+	while (bytes > 0)
+	{
+		size_t k = m_blockBytes - m_block.size();
+		if (k > bytes) k = bytes;
+		m_block.insert(m_block.end(), p, p + k);
+		p += k;
+		bytes -= k;
+		if (m_block.size() == m_blockBytes) Push();
+	}
+}
+
+
+// hands the collected block over to the thread
+void CMtbWriter::Push()
+{
+	if (m_block.empty()) return;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_changed.wait(lock, [this] { return m_queue.size() < m_maxQueued; });
+	m_queue.push_back(std::vector<unsigned char>());
+	m_queue.back().swap(m_block);
+	m_changed.notify_all();
+	lock.unlock();
+	m_block.reserve(m_blockBytes);
+}
+
+
+void CMtbWriter::Run()
+{
+	std::vector<unsigned char> raw, out;
+	std::vector<uint16_t> words;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_changed.wait(lock, [this] { return m_done || !m_queue.empty(); });
+			if (m_queue.empty()) break;
+			raw.swap(m_queue.front());
+			m_queue.pop_front();
+			m_changed.notify_all();
+		}
+
+		if (m_indexing) m_index.Add(&raw[0], raw.size());
+
+		// an odd byte can only be in the last block, which is then stored
+		out.assign(blockHeaderSize, 0);
+		uint32_t codec = CODEC_STORED;
+		if (raw.size() % 2 == 0)
+		{
+			words.resize(raw.size() / 2);
+			memcpy(&words[0], &raw[0], raw.size()); // little endian host
+			MtbCompress(&words[0], words.size(), out);
+			codec = CODEC_WORDLZ;
+		}
+		if (codec == CODEC_STORED || out.size() - blockHeaderSize >= raw.size())
+		{
+			out.resize(blockHeaderSize);
+			out.insert(out.end(), raw.begin(), raw.end());
+			codec = CODEC_STORED;
+		}
+		Put32(&out[0], blockMagic);
+		Put32(&out[4], raw.size());
+		Put32(&out[8], out.size() - blockHeaderSize);
+		Put32(&out[12], MtbCrc32(&raw[0], raw.size()));
+		Put32(&out[16], codec);
+		Put32(&out[20], MtbCrc32(&out[0], 20));
+
+		bool ok = fwrite(&out[0], out.size(), 1, m_file) == 1;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!ok) m_error = true;
+		m_fileBytes += out.size();
+	}
+}
+
+
+uint64_t CMtbWriter::FileBytes()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_fileBytes;
+}
+
+
+bool CMtbWriter::Close()
+{
+	if (!m_file) return !m_error;
+	Push();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_done = true;
+		m_changed.notify_all();
+	}
+	m_thread.join();
+	if (fclose(m_file) != 0) m_error = true;
+	m_file = 0;
+	if (m_indexing && !m_error) m_index.Save(m_indexName.c_str(), m_fileBytes);
+	m_index.Clear();
+	return !m_error;
+}
+
+
+// == reader ==================================================================
+
+// decompresses the blocks of the container into the get area
+class CMtbStreamBuf : public std::streambuf
+{
+	std::ifstream m_file;
+	std::vector<unsigned char> m_stored;
+	std::vector<uint16_t> m_words;
+	std::string m_name;
+
+	uint64_t m_blockRaw, m_nextRaw; // raw offsets of the current and the next block
+	std::streamoff m_firstBlock;
+	// file and raw offset of each block, read on the first seek
+	std::vector< std::pair<std::streamoff, uint64_t> > m_blocks;
+	unsigned int m_headerSize; // of a block, by file version
+
+	bool GoodBlockHeader(const unsigned char *h);
+	bool NextBlockHeader(unsigned char *h, bool quiet);
+	bool ReadBlock();
+	void ReadBlockTable();
+public:
+	CMtbStreamBuf(const char *fileName)
+		: m_file(fileName, std::ios::binary), m_name(fileName), m_blockRaw(0), m_nextRaw(0), m_firstBlock(0),
+		  m_headerSize(blockHeaderSize) {}
+	// 1 for a container, 0 for one this version can't read, -1 for another file
+	int ReadHeader(CMtbHeader &header);
+protected:
+	int_type underflow();
+	pos_type seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which);
+	pos_type seekpos(pos_type pos, std::ios::openmode which);
+};
+
+
+int CMtbStreamBuf::ReadHeader(CMtbHeader &header)
+{
+	unsigned char h[fileHeaderSize];
+	if (!m_file.read((char *)h, 16) || memcmp(h, fileMagic, sizeof(fileMagic)) != 0) return -1;
+	uint32_t version = Get32(h + 8), size = Get32(h + 12);
+	if (version < 1 || version > fileVersion || size < fileHeaderSize
+		|| !m_file.read((char *)h + 16, fileHeaderSize - 16)) return 0;
+	m_file.ignore(size - fileHeaderSize);
+	m_firstBlock = size;
+	m_headerSize = version == 1 ? blockHeaderSizeV1 : blockHeaderSize;
+	header.runNumber = int32_t(Get32(h + 16));
+	header.nRocs = Get16(h + 20);
+	header.dataFormat = Get16(h + 22);
+	header.boardId.assign((const char *)h + 24, strnlen((const char *)h + 24, 32));
+	return 1;
+}
+
+
+// Only sizes the writer can produce pass, a header of version 2 also has
+// to match its checksum.
+bool CMtbStreamBuf::GoodBlockHeader(const unsigned char *h)
+{
+	uint32_t rawBytes = Get32(h + 4), storedBytes = Get32(h + 8), codec = Get32(h + 16);
+	if (Get32(h) != blockMagic || rawBytes > maxBlockBytes || storedBytes > rawBytes) return false;
+	if (codec == CODEC_STORED ? storedBytes != rawBytes : codec != CODEC_WORDLZ) return false;
+	return m_headerSize == blockHeaderSizeV1 || Get32(h + 20) == MtbCrc32(h, 20);
+}
+
+
+// Next good block header into h. Behind a damaged one the blocks are lost
+// until the next good header, found byte by byte. false at the end of the
+// file.
+bool CMtbStreamBuf::NextBlockHeader(unsigned char *h, bool quiet)
+{
+	bool lost = false;
+	while (m_file.read((char *)h, m_headerSize))
+	{
+		if (GoodBlockHeader(h)) return true;
+		if (!lost && !quiet) std::cerr << m_name << ": bad block header at byte "
+			<< (long long)m_file.tellg() - m_headerSize << ", looking for the next block" << std::endl;
+		lost = true;
+		m_file.seekg(1 - int(m_headerSize), std::ios::cur);
+	}
+	return false;
+}
+
+
+// next good block into m_words, false at the end of the file
+bool CMtbStreamBuf::ReadBlock()
+{
+	unsigned char h[blockHeaderSize];
+	while (NextBlockHeader(h, false))
+	{
+		uint32_t rawBytes = Get32(h + 4), storedBytes = Get32(h + 8), crc = Get32(h + 12), codec = Get32(h + 16);
+		m_blockRaw = m_nextRaw;
+		m_nextRaw += rawBytes;
+		m_stored.resize(storedBytes);
+		if (storedBytes && !m_file.read((char *)&m_stored[0], storedBytes))
+		{
+			std::cerr << m_name << ": file ends inside a block of " << rawBytes << " bytes" << std::endl;
+			return false;
+		}
+
+		m_words.clear();
+		bool ok;
+		if (codec == CODEC_STORED)
+		{
+			ok = storedBytes == rawBytes;
+			m_words.resize((rawBytes + 1) / 2);
+			if (ok && rawBytes) memcpy(&m_words[0], &m_stored[0], rawBytes);
+		}
+		else ok = codec == CODEC_WORDLZ && rawBytes % 2 == 0
+			&& MtbDecompress(&m_stored[0], storedBytes, rawBytes / 2, m_words);
+		if (ok && rawBytes) ok = MtbCrc32(&m_words[0], rawBytes) == crc;
+		if (!ok)
+		{
+			std::cerr << m_name << ": corrupt block of " << rawBytes << " bytes left out" << std::endl;
+			continue;
+		}
+		if (rawBytes == 0) continue;
+		char *p = (char *)&m_words[0];
+		setg(p, p, p + rawBytes);
+		return true;
+	}
+	return false;
+}
+
+
+CMtbStreamBuf::int_type CMtbStreamBuf::underflow()
+{
+	if (gptr() < egptr() || ReadBlock()) return traits_type::to_int_type(*gptr());
+	return traits_type::eof();
+}
+
+
+// reads the block table, the file stays where it was for the current block
+void CMtbStreamBuf::ReadBlockTable()
+{
+	std::streamoff here = m_file.tellg(); // -1 after the last block
+	m_blocks.clear();
+	m_file.clear();
+	m_file.seekg(m_firstBlock);
+	unsigned char h[blockHeaderSize];
+	uint64_t raw = 0;
+	while (NextBlockHeader(h, true))
+	{
+		m_blocks.push_back(std::make_pair(std::streamoff(m_file.tellg()) - std::streamoff(m_headerSize), raw));
+		raw += Get32(h + 4);
+		m_file.seekg(Get32(h + 8), std::ios::cur);
+	}
+	m_blocks.push_back(std::make_pair(std::streamoff(-1), raw)); // end
+	m_file.clear();
+	if (here >= 0) m_file.seekg(here);
+	else m_file.seekg(0, std::ios::end);
+}
+
+
+CMtbStreamBuf::pos_type CMtbStreamBuf::seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which)
+{
+	if (dir == std::ios::cur)
+	{
+		pos_type here = m_blockRaw + (gptr() - eback());
+		if (off == 0) return here;
+		return seekpos(here + off, which);
+	}
+	if (dir == std::ios::end)
+	{
+		if (m_blocks.empty()) ReadBlockTable();
+		return seekpos(off_type(m_blocks.back().second) + off, which);
+	}
+	return seekpos(off, which);
+}
+
+
+// the block holding pos is decoded again, unless it is the current one
+CMtbStreamBuf::pos_type CMtbStreamBuf::seekpos(pos_type pos, std::ios::openmode which)
+{
+	if (!(which & std::ios::in) || off_type(pos) < 0) return pos_type(off_type(-1));
+	uint64_t raw = off_type(pos);
+	if (eback() && raw >= m_blockRaw && raw < m_blockRaw + (egptr() - eback()))
+	{
+		setg(eback(), eback() + (raw - m_blockRaw), egptr());
+		return pos;
+	}
+
+	if (m_blocks.empty()) ReadBlockTable();
+	if (raw > m_blocks.back().second) return pos_type(off_type(-1));
+	size_t b = 0;
+	while (b + 1 < m_blocks.size() && m_blocks[b + 1].second <= raw) b++;
+
+	setg(0, 0, 0);
+	m_file.clear();
+	if (m_blocks[b].first < 0)
+	{
+		// at the end
+		m_file.seekg(0, std::ios::end);
+		m_blockRaw = m_nextRaw = raw;
+		return pos;
+	}
+	m_file.seekg(m_blocks[b].first);
+	m_nextRaw = m_blocks[b].second;
+	if (ReadBlock() && raw >= m_blockRaw) gbump(raw - m_blockRaw);
+	return pos;
+}
+
+
+class CMtbIStream : public std::istream
+{
+	CMtbStreamBuf m_buf;
+public:
+	CMtbIStream(const char *fileName) : std::istream(0), m_buf(fileName) { rdbuf(&m_buf); }
+	int ReadHeader(CMtbHeader &header) { return m_buf.ReadHeader(header); }
+};
+
+
+std::istream *OpenMtbFile(const char *fileName, CMtbHeader *header)
+{
+	CMtbHeader h;
+	CMtbIStream *container = new CMtbIStream(fileName);
+	int status = container->ReadHeader(h);
+	if (status > 0)
+	{
+		if (header) *header = h;
+		return container;
+	}
+	delete container;
+	if (status == 0)
+	{
+		std::cerr << fileName << ": container version not supported" << std::endl;
+		return 0;
+	}
+
+	std::ifstream *file = new std::ifstream(fileName, std::ios::binary);
+	if (file->is_open()) return file;
+	delete file;
+	return 0;
+}
@@ -0,0 +1,113 @@
+// MtbFile.h
+//
+// Block structured container for raw DAQ data (mtb.bin). The 16 bit words
+// are compressed block by block with a word oriented LZ codec, made for the
+// repeating levels and headers of the readout, and each block carries the
+// CRC32 of its raw bytes. All numbers are little endian.
+//
+//   file header, 64 bytes
+//     char     magic[8]      "PSI46MTB"
+//     uint32   version       2 (1 without the block header checksum)
+//     uint32   headerSize    64
+//     int32    run number
+//     uint16   number of ROCs
+//     uint16   data format   0 records of the board memory readout (header
+//                            word 0x80tt and 3 time stamp words each, what
+//                            UsbDaq and BinaryFileReader read), 1 deser160
+//                            samples of the DTB DAQ (12 bit words, a readout
+//                            starts at bit 15, see ReadoutScanner.h)
+//     char     boardId[32]   testboard name, zero padded
+//     uint32   reserved[2]
+//   blocks, each
+//     uint32   magic         "MTBB"
+//     uint32   raw bytes
+//     uint32   stored bytes
+//     uint32   CRC32 of the raw bytes
+//     uint32   codec         0 stored, 1 word LZ
+//     uint32   CRC32 of the 20 bytes above (not in version 1)
+//     stored bytes of data
+//
+// A reader leaves out a block whose data doesn't match its CRC, and behind a
+// damaged block header (checksum, or sizes above 64 MiB or not from the
+// writer) looks for the next good header byte by byte.
+//
+// Word LZ: a control byte c < 0x80 is followed by c+1 literal words, a
+// control byte c >= 0x80 by a 16 bit distance d: copy (c & 0x7f) + 2 words
+// from d words back (d < length repeats a pattern).
+//
+// Readers use OpenMtbFile, which returns a plain stream for a file without
+// the header, so the old raw files read as before. Those are always in the
+// record format; a reader has to check the data format of a container.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <istream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "MtbIndex.h"
+
+
+struct CMtbHeader
+{
+	int32_t runNumber;
+	uint16_t nRocs;
+	uint16_t dataFormat;   // MTB_RECORDS or MTB_DESER160
+	std::string boardId;
+	CMtbHeader() : runNumber(0), nRocs(0), dataFormat(MTB_RECORDS) {}
+};
+
+
+uint32_t MtbCrc32(const void *data, size_t n, uint32_t crc = 0);
+void MtbCompress(const uint16_t *in, size_t n, std::vector<unsigned char> &out);
+// appends the n words coded in in[0..size) to out, false for corrupt data
+bool MtbDecompress(const unsigned char *in, size_t size, size_t n, std::vector<uint16_t> &out);
+
+
+// Writes the container. Write only collects the data, full blocks are
+// compressed and written by a thread of the writer, which also fills the
+// record index saved as <file>.idx by Close.
+class CMtbWriter
+{
+	FILE *m_file;
+	size_t m_blockBytes;
+	unsigned int m_maxQueued;
+	std::vector<unsigned char> m_block;
+	std::deque< std::vector<unsigned char> > m_queue;
+	uint64_t m_rawBytes, m_fileBytes;
+	bool m_done, m_error;
+	bool m_indexing;
+	std::string m_indexName;
+	CMtbIndex m_index;
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::thread m_thread;
+
+	void Run();
+	void Push();
+public:
+	CMtbWriter(size_t blockBytes = 1 << 18, unsigned int maxQueued = 8);
+	~CMtbWriter() { Close(); }
+
+	bool Open(const char *fileName, const CMtbHeader &header, bool index = true);
+	bool IsOpen() { return m_file != 0; }
+	void Write(const void *data, size_t bytes);
+	bool Close(); // writes the rest, false after an I/O error
+
+	uint64_t RawBytes() { return m_rawBytes; }
+	uint64_t FileBytes(); // so far
+};
+
+
+// Opens a raw data file for reading, a container is decompressed on the
+// fly. Returns 0 if the file can't be opened. header gets the container
+// header, it stays empty for a plain file. Blocks with a wrong checksum
+// are left out with a message on stderr. seekg and tellg work with
+// offsets in the raw data, so the offsets of CMtbIndex apply to both.
+std::istream *OpenMtbFile(const char *fileName, CMtbHeader *header = 0);
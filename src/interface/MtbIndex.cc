@@ -0,0 +1,181 @@
+// MtbIndex.cc
+
+#include "MtbIndex.h"
+#include "MtbFile.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <istream>
+
+
+static const char indexMagic[8] = { 'P', 'S', 'I', '4', '6', 'I', 'D', 'X' };
+static const uint32_t indexVersion = 1;
+static const unsigned int indexHeaderSize = 32;
+static const unsigned int entrySize = 16;
+
+
+static inline void Put64(unsigned char *p, uint64_t x) { for (int i = 0; i < 8; i++) p[i] = x >> (8*i); }
+static inline uint64_t Get64(const unsigned char *p)
+{
+	uint64_t x = 0;
+	for (int i = 7; i >= 0; i--) x = (x << 8) | p[i];
+	return x;
+}
+
+
+void CMtbIndex::Clear()
+{
+	m_entries.clear();
+	m_bytes = 0;
+	m_pending = -1;
+	m_timeWords = 0;
+}
+
+
+void CMtbIndex::Add(const void *data, size_t bytes)
+{
+	const unsigned char *p = (const unsigned char *)data, *end = p + bytes;
+	while (p < end)
+	{
+		uint16_t word;
+		if (m_pending >= 0)
+		{
+			word = m_pending | (*p++ << 8);
+			m_pending = -1;
+		}
+		else if (p + 1 < end)
+		{
+			word = p[0] | (p[1] << 8);
+			p += 2;
+		}
+		else
+		{
+			m_pending = *p++;
+			break;
+		}
+
+		if (m_format == MTB_DESER160)
+		{
+			if (word & 0x8000)
+			{
+				MtbIndexEntry e = { m_bytes, int64_t(m_entries.size()), 0 };
+				m_entries.push_back(e);
+			}
+		}
+		else if (m_timeWords > 0)
+		{
+			MtbIndexEntry &e = m_entries.back();
+			e.time = (e.time << 16) | word;
+			m_timeWords--;
+		}
+		else if ((word & 0xff00) == 0x8000)
+		{
+			MtbIndexEntry e = { m_bytes, 0, uint16_t(word & 0x00ff) };
+			m_entries.push_back(e);
+			m_timeWords = 3;
+		}
+		m_bytes += 2;
+	}
+}
+
+
+bool CMtbIndex::Load(const char *indexName, uint64_t dataFileBytes)
+{
+	FILE *f = fopen(indexName, "rb");
+	if (!f) return false;
+
+	unsigned char h[indexHeaderSize];
+	bool ok = fread(h, sizeof(h), 1, f) == 1 && memcmp(h, indexMagic, sizeof(indexMagic)) == 0
+		&& Get64(h + 8) == (indexVersion | (uint64_t(entrySize) << 32))
+		&& Get64(h + 16) == dataFileBytes;
+	if (ok)
+	{
+		uint64_t n = Get64(h + 24);
+		std::vector<unsigned char> buffer(entrySize * std::min<uint64_t>(n, 65536));
+		Clear();
+		m_entries.reserve(n);
+		while (ok && m_entries.size() < n)
+		{
+			size_t k = std::min<uint64_t>(n - m_entries.size(), buffer.size() / entrySize);
+			ok = fread(&buffer[0], entrySize, k, f) == k;
+			for (size_t i = 0; ok && i < k; i++)
+			{
+				const unsigned char *q = &buffer[entrySize * i];
+				uint64_t th = Get64(q + 8);
+				MtbIndexEntry e = { Get64(q), int64_t(th & 0xffffffffffffull), uint16_t(th >> 48) };
+				m_entries.push_back(e);
+			}
+		}
+	}
+	fclose(f);
+	if (!ok) Clear();
+	return ok;
+}
+
+
+bool CMtbIndex::Save(const char *indexName, uint64_t dataFileBytes) const
+{
+	FILE *f = fopen(indexName, "wb");
+	if (!f) return false;
+
+	unsigned char h[indexHeaderSize];
+	memcpy(h, indexMagic, sizeof(indexMagic));
+	Put64(h + 8, indexVersion | (uint64_t(entrySize) << 32));
+	Put64(h + 16, dataFileBytes);
+	Put64(h + 24, m_entries.size());
+	bool ok = fwrite(h, sizeof(h), 1, f) == 1;
+
+	std::vector<unsigned char> buffer;
+	for (size_t i = 0; ok && i < m_entries.size(); i += 65536)
+	{
+		size_t k = std::min<size_t>(m_entries.size() - i, 65536);
+		buffer.resize(entrySize * k);
+		for (size_t j = 0; j < k; j++)
+		{
+			const MtbIndexEntry &e = m_entries[i + j];
+			Put64(&buffer[entrySize * j], e.offset);
+			Put64(&buffer[entrySize * j + 8], (uint64_t(e.time) & 0xffffffffffffull) | (uint64_t(e.header) << 48));
+		}
+		ok = fwrite(&buffer[0], entrySize, k, f) == k;
+	}
+	if (fclose(f) != 0) ok = false;
+	if (!ok) remove(indexName);
+	return ok;
+}
+
+
+static bool TimeLess(const MtbIndexEntry &e, int64_t time) { return e.time < time; }
+
+size_t CMtbIndex::FindTime(int64_t time) const
+{
+	return std::lower_bound(m_entries.begin(), m_entries.end(), time, TimeLess) - m_entries.begin();
+}
+
+
+std::string MtbIndexName(const char *dataFileName)
+{
+	return std::string(dataFileName) + ".idx";
+}
+
+
+bool MtbIndexOpen(const char *dataFileName, CMtbIndex &index)
+{
+	struct stat st;
+	if (stat(dataFileName, &st) != 0) return false;
+	std::string indexName = MtbIndexName(dataFileName);
+	if (index.Load(indexName.c_str(), st.st_size)) return true;
+
+	CMtbHeader header;
+	std::istream *in = OpenMtbFile(dataFileName, &header);
+	if (!in) return false;
+	index.SetFormat(header.dataFormat);
+	std::vector<char> buffer(1 << 20);
+	while (in->read(&buffer[0], buffer.size()) || in->gcount() > 0)
+		index.Add(&buffer[0], in->gcount());
+	delete in;
+
+	index.Save(indexName.c_str(), st.st_size); // only a cache, may be read only
+	return true;
+}
@@ -0,0 +1,87 @@
+// MtbIndex.h
+//
+// Record index of a raw data file, kept next to it as <file>.idx. A record
+// starts with a header word 0x80tt (tt = header type, the bits of the
+// readers' kData, kReset, ...) followed by the three time stamp words. The
+// index holds per record the byte offset of its header word in the raw
+// stream (the decompressed one for a container), its time stamp and type,
+// so a reader can seek to record n or to a time without reading the file
+// up to there.
+//
+// Data in the deser160 format (MTB_DESER160, streamed from the DTB DAQ)
+// has no records: there each readout, starting at a word with bit 15 set,
+// is an entry, with the readout number as time stamp and type 0.
+//
+//   index file, little endian
+//     char     magic[8]      "PSI46IDX"
+//     uint32   version       1
+//     uint32   entry size    16
+//     uint64   size of the data file on disk, to detect a stale index
+//     uint64   number of entries
+//   entries, each
+//     uint64   byte offset of the header word
+//     uint48   time stamp
+//     uint16   header type
+//
+// CMtbWriter fills the index while it writes, MtbIndexOpen builds it on
+// the first read of other files.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+
+// data format of a raw stream, stored in the container header
+enum
+{
+	MTB_RECORDS  = 0,  // records of the board memory readout, see above
+	MTB_DESER160 = 1   // deser160 samples of the DTB DAQ, see interface/ReadoutScanner.h
+};
+
+
+struct MtbIndexEntry
+{
+	uint64_t offset;
+	int64_t time;
+	uint16_t header;
+};
+
+
+class CMtbIndex
+{
+	std::vector<MtbIndexEntry> m_entries;
+	uint16_t m_format;
+
+	// scanner state, so the data can come in pieces of any size
+	uint64_t m_bytes;
+	int m_pending;      // byte of an incomplete word, -1 if none
+	int m_timeWords;    // time stamp words still to come
+public:
+	CMtbIndex(uint16_t format = MTB_RECORDS) : m_format(format) { Clear(); }
+
+	void Clear();
+	// clears the index for data of the given format
+	void SetFormat(uint16_t format) { m_format = format; Clear(); }
+	uint16_t Format() const { return m_format; }
+	// scans the next bytes of the raw stream
+	void Add(const void *data, size_t bytes);
+
+	bool Load(const char *indexName, uint64_t dataFileBytes);
+	bool Save(const char *indexName, uint64_t dataFileBytes) const;
+
+	size_t Size() const { return m_entries.size(); }
+	const MtbIndexEntry &operator[](size_t i) const { return m_entries[i]; }
+	// first record with a time stamp >= time, Size() if there is none;
+	// the time stamps of a run only grow
+	size_t FindTime(int64_t time) const;
+};
+
+
+std::string MtbIndexName(const char *dataFileName);
+
+// Loads the index of a data file, or builds it from the file and saves it
+// if the sidecar is missing or stale. false if the data file can't be read.
+bool MtbIndexOpen(const char *dataFileName, CMtbIndex &index);
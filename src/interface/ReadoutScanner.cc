@@ -0,0 +1,137 @@
+// ReadoutScanner.cc
+
+#include "ReadoutScanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+
+// appends base + position of each set bit of mask
+static inline void ScanPush(std::vector<uint32_t> & v, uint32_t mask, uint32_t base)
+{
+	while (mask)
+	{
+		v.push_back(base + __builtin_ctz(mask));
+		mask &= mask - 1;
+	}
+}
+
+
+static inline bool IsEvent(uint16_t x) { return (x & 0x8000) != 0; }
+static inline bool IsRoc(uint16_t x) { return (x & 0x0ffc) == 0x07f8; }
+
+
+static void ScanScalar(const uint16_t * x, size_t begin, size_t n, ReadoutIndex & index)
+{
+	for (size_t i = begin; i < n; i++)
+	{
+		if (IsEvent(x[i])) index.event.push_back(i);
+		if (IsRoc(x[i])) index.roc.push_back(i);
+	}
+}
+
+
+#ifdef SCAN_X86
+
+// 16 words per step: the sign bit of a word is bit 15, the packed compare
+// result gives the ROC headers
+__attribute__((target("sse2")))
+static size_t ScanSSE2(const uint16_t * x, size_t n, ReadoutIndex & index)
+{
+	const __m128i rocMask = _mm_set1_epi16(0x0ffc);
+	const __m128i rocHeader = _mm_set1_epi16(0x07f8);
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *)(x + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(x + i + 8));
+		uint32_t ev = _mm_movemask_epi8(_mm_packs_epi16(a, b));
+		__m128i ra = _mm_cmpeq_epi16(_mm_and_si128(a, rocMask), rocHeader);
+		__m128i rb = _mm_cmpeq_epi16(_mm_and_si128(b, rocMask), rocHeader);
+		uint32_t roc = _mm_movemask_epi8(_mm_packs_epi16(ra, rb));
+		ScanPush(index.event, ev, i);
+		ScanPush(index.roc, roc, i);
+	}
+	return i;
+}
+
+
+// 32 words per step, packs works per 128 bit lane so the
+// quadwords are put back in order before the movemask
+__attribute__((target("avx2")))
+static size_t ScanAVX2(const uint16_t * x, size_t n, ReadoutIndex & index)
+{
+	const __m256i rocMask = _mm256_set1_epi16(0x0ffc);
+	const __m256i rocHeader = _mm256_set1_epi16(0x07f8);
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i *)(x + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(x + i + 16));
+		__m256i ev = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xd8);
+		__m256i ra = _mm256_cmpeq_epi16(_mm256_and_si256(a, rocMask), rocHeader);
+		__m256i rb = _mm256_cmpeq_epi16(_mm256_and_si256(b, rocMask), rocHeader);
+		__m256i roc = _mm256_permute4x64_epi64(_mm256_packs_epi16(ra, rb), 0xd8);
+		ScanPush(index.event, _mm256_movemask_epi8(ev), i);
+		ScanPush(index.roc, _mm256_movemask_epi8(roc), i);
+	}
+	return i;
+}
+
+#endif
+
+
+bool ReadoutScanAvailable(ReadoutScanImpl impl)
+{
+	switch (impl)
+	{
+		case SCAN_AUTO:
+		case SCAN_SCALAR: return true;
+#ifdef SCAN_X86
+		case SCAN_SSE2: return __builtin_cpu_supports("sse2");
+		case SCAN_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+		default: return false;
+	}
+}
+
+
+const char * ReadoutScanName(ReadoutScanImpl impl)
+{
+	switch (impl)
+	{
+		case SCAN_AUTO:   return "auto";
+		case SCAN_SCALAR: return "scalar";
+		case SCAN_SSE2:   return "sse2";
+		case SCAN_AVX2:   return "avx2";
+	}
+	return "?";
+}
+
+
+void ScanReadouts(const uint16_t * x, size_t n, ReadoutIndex & index, ReadoutScanImpl impl)
+{
+	static const ReadoutScanImpl best =
+		ReadoutScanAvailable(SCAN_AVX2) ? SCAN_AVX2 :
+		ReadoutScanAvailable(SCAN_SSE2) ? SCAN_SSE2 : SCAN_SCALAR;
+	if (impl == SCAN_AUTO || !ReadoutScanAvailable(impl)) impl = best;
+
+	index.Clear();
+	size_t done = 0;
+#ifdef SCAN_X86
+	if (impl == SCAN_AVX2) done = ScanAVX2(x, n, index);
+	else if (impl == SCAN_SSE2) done = ScanSSE2(x, n, index);
+#endif
+	ScanScalar(x, done, n, index);
+
+	// first ROC header at or after the start of each event
+	index.eventRoc.resize(index.event.size());
+	size_t r = 0;
+	for (size_t e = 0; e < index.event.size(); e++)
+	{
+		while (r < index.roc.size() && index.roc[r] < index.event[e]) r++;
+		index.eventRoc[e] = r;
+	}
+}
@@ -0,0 +1,56 @@
+// Boundaries of readouts and ROCs in a raw DAQ buffer, found in one pass
+// over the buffer with SSE2 or AVX2 where the CPU has it.
+//
+// A readout (one trigger) starts at a word with bit 15 set. Each ROC in it
+// starts with its header, (x & 0x0ffc) == 0x07f8, the first one also carries
+// bit 15. A pixel word can't match the header pattern (invalid column digit
+// or fill bit set), so both searches need no decoding.
+//
+//   ReadoutIndex index;
+//   ScanReadouts(&data[0], data.size(), index);
+//   for (unsigned int e = 0; e < index.Events(); e++)
+//       Decode(&data[index.EventBegin(e)], index.EventSize(e, data.size()));
+//
+// The events are independent, so they can be decoded in any order or in
+// parallel.
+
+#ifndef READOUTSCANNER_H
+#define READOUTSCANNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+struct ReadoutIndex
+{
+	std::vector<uint32_t> event;    // offset of each word with bit 15 set
+	std::vector<uint32_t> roc;      // offset of each ROC header
+	std::vector<uint32_t> eventRoc; // per event the index of its first entry in roc
+
+	unsigned int Events() const { return event.size(); }
+	uint32_t EventBegin(unsigned int e) const { return event[e]; }
+	uint32_t EventSize(unsigned int e, size_t n) const
+	{ return (e + 1 < event.size() ? event[e + 1] : n) - event[e]; }
+	// number of ROC headers of event e
+	unsigned int EventRocs(unsigned int e) const
+	{ return (e + 1 < eventRoc.size() ? eventRoc[e + 1] : roc.size()) - eventRoc[e]; }
+
+	void Clear() { event.clear(); roc.clear(); eventRoc.clear(); }
+};
+
+
+enum ReadoutScanImpl
+{
+	SCAN_AUTO,    // best one the CPU supports
+	SCAN_SCALAR,  // word by word
+	SCAN_SSE2,
+	SCAN_AVX2
+};
+
+bool ReadoutScanAvailable(ReadoutScanImpl impl);
+const char * ReadoutScanName(ReadoutScanImpl impl);
+
+// Replaces the contents of index by the boundaries in x[0..n).
+void ScanReadouts(const uint16_t * x, size_t n, ReadoutIndex & index, ReadoutScanImpl impl = SCAN_AUTO);
+
+#endif
@@ -22,10 +22,15 @@
 #include "rpc_io.h"
 
 #include <inttypes.h>
+#include <sys/time.h>
 
 #define USBWRITEBUFFERSIZE  150000
 #define USBREADBUFFERSIZE   150000
 
+// defaults for the bulk read engine (see CUSB::SetReadQueue)
+#define USBREADTRANSFERS      8
+#define USBREADTRANSFERSIZE   16384
+
 
 #define ESC_EXTENDED 0x8f
 
@@ -48,6 +53,11 @@ class CUSB : public CRpcIo
   uint32_t m_posR, m_sizeR;
   unsigned char m_bufferR[USBREADBUFFERSIZE];
 
+  uint32_t m_readTransfers, m_readTransferSize; // bulk read engine settings
+
+  uint64_t m_rateBytes;     // bytes returned by Read() since ResetReadRate()
+  struct timeval m_rateStart;
+
   bool FillBuffer(uint32_t minBytesToRead);
 
 public:
@@ -56,7 +66,7 @@ public:
   int32_t GetLastError() { return ftdiStatus; }
 #ifdef HAVE_LIBFTDI
   const char* GetErrorMsg();
-  const char* GetErrorMsg(int){GetErrorMsg();};
+  const char* GetErrorMsg(int){ return GetErrorMsg(); }
 #else
   const char* GetErrorMsg(int error);
 #endif
@@ -86,6 +96,15 @@ public:
   bool WaitForFilledQueue(int pSize,int pMaxWait=10000);
   void SetTimeout(unsigned int timeout){m_timeout = timeout;}
 
+  // Configures the bulk read engine, takes effect with the next Open().
+  // libftdi: number of asynchronous libusb transfers kept queued on the IN endpoint
+  //          and their size in bytes (0 transfers falls back to polled reading)
+  // ftd2xx:  transfer size is passed to the driver, the queue depth is not used
+  void SetReadQueue(uint32_t nTransfers, uint32_t transferSize);
+  // average read throughput in MB/s since Open() or the last ResetReadRate()
+  double GetReadRate();
+  void ResetReadRate();
+
 
   // read methods
 
@@ -19,6 +19,9 @@ CUSB::CUSB(){
   ftdiStatus = 0;
   enumPos = enumCount = 0;
   m_timeout = 15000; // maximum time to wait for read call in ms
+  m_readTransfers = USBREADTRANSFERS;
+  m_readTransferSize = USBREADTRANSFERSIZE;
+  ResetReadRate();
  }
 
  CUSB::~CUSB(){
@@ -178,6 +181,14 @@ bool CUSB::Open(char serialNumber[])
   if (ftdiStatus != FT_OK) return false;
 
   FT_SetTimeouts(ftHandle,m_timeout,m_timeout);
+
+  // the driver queues its own requests, we can only choose their size (multiple of 64 bytes)
+  uint32_t transferSize = m_readTransferSize - m_readTransferSize % 64;
+  if (transferSize < 64) transferSize = 64;
+  if (transferSize > 65536) transferSize = 65536;
+  FT_SetUSBParameters(ftHandle, transferSize, transferSize);
+
+  ResetReadRate();
   isUSB_open = true;
   return true;
 }
@@ -278,6 +289,7 @@ void CUSB::Read(uint32_t bytesToRead, void *buffer, uint32_t &bytesRead)
 				((unsigned char*)buffer)[i] = m_bufferR[m_posR++];
 			else
 			{   // timeout (bytesRead < bytesToRead)
+				m_rateBytes += i;
 				bytesRead = i;
 				throw CRpcError(CRpcError::READ_TIMEOUT);
 			}
@@ -285,11 +297,13 @@ void CUSB::Read(uint32_t bytesToRead, void *buffer, uint32_t &bytesRead)
 
 		else
 		{
+			m_rateBytes += i;
 			bytesRead = i;
 			throw CRpcError(CRpcError::READ_TIMEOUT);
 		}
 	}
 
+	m_rateBytes += bytesToRead;
 	bytesRead = bytesToRead;
 }
 
@@ -317,11 +331,34 @@ bool CUSB::Show()
   std::cout << ", m_sizeR = " << m_sizeR;
   std::cout << ", m_posR = " << m_posR;
   std::cout << ", m_posW = " << m_posW;
+  std::cout << ", read rate = " << GetReadRate() << " MB/s";
   std::cout << std::endl;
 
   return true;
 }
 
+//----------------------------------------------------------------------
+void CUSB::SetReadQueue(uint32_t nTransfers, uint32_t transferSize)
+{
+  m_readTransfers = nTransfers;
+  m_readTransferSize = transferSize;
+}
+
+double CUSB::GetReadRate()
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  double seconds = (now.tv_sec - m_rateStart.tv_sec) + 1e-6 * (now.tv_usec - m_rateStart.tv_usec);
+  if (seconds <= 0) return 0;
+  return m_rateBytes / seconds / 1e6;
+}
+
+void CUSB::ResetReadRate()
+{
+  m_rateBytes = 0;
+  gettimeofday(&m_rateStart, NULL);
+}
+
 //----------------------------------------------------------------------
 int CUSB::GetQueue()
 {
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <iostream>
+#include <deque>
 #include <unistd.h>
 #include <time.h> // needed for usleep function
 
@@ -11,16 +12,37 @@
 
 // needed for threaded readout of FTDI
 #include <pthread.h> 
-#include <semaphore.h>
+#include <errno.h>
+#include <sys/time.h>
 
 static struct ftdi_context ftdic;
 
 // the read buffer needs to be accessable outside of our USB class
 #define BUFSIZE 0x200000
 static pthread_t readerthread;
-static sem_t buf_data, buf_space;
+static pthread_mutex_t buf_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t buf_data = PTHREAD_COND_INITIALIZER;  // signalled when new data has been added
+static pthread_cond_t buf_space = PTHREAD_COND_INITIALIZER; // signalled when data has been consumed
 static unsigned char read_buffer[BUFSIZE];
-static int32_t head, tail; // read buffer is used as ring buffer
+static uint32_t head, tail, buf_fill; // read buffer is used as ring buffer, buf_fill is the number of bytes stored
+static volatile bool reader_stop;     // asks the reader thread to finish
+
+// asynchronous bulk read engine: several libusb transfers are kept queued on the
+// FTDI IN endpoint so the chip can always hand its data to the host. The callbacks
+// run on any thread handling libusb events, also the main thread inside libftdi's
+// synchronous calls, so they never wait: a transfer whose data doesn't fit into the
+// ring buffer is parked, and so is every later one to keep the order, until the
+// reader thread finds space and resubmits them.
+struct read_slot {
+    struct libusb_transfer *transfer;
+    struct ftdi_context *handle;
+    uint32_t pos, len;                // data not yet in the ring buffer
+};
+static struct read_slot *read_slots;
+static uint32_t read_nTransfers, read_transferSize;
+static volatile int read_active;      // transfers currently owned by libusb (buf_mutex)
+static std::deque<struct read_slot *> read_parked; // waiting for buffer space, oldest first (buf_mutex)
+static volatile bool read_stopping;   // no more resubmits, the transfers are cancelled
 
 // cleanup is threaded to include a timeout on the calls to the device that sometimes hang
 pthread_mutex_t cleanup_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -33,31 +55,40 @@ const int32_t vendorID = 0x0403; // Future Technology Devices International, Ltd
 
 using namespace std;
 
-static void add_to_buf (unsigned char c) {
-    int32_t nh;
-
-    sem_wait (&buf_space);
-    if (head == (BUFSIZE -1)) nh = 0;
-    else                      nh = head + 1;
+static void unlock_buf (void *arg) {
+  // cleanup handler: the reader thread may be cancelled while waiting for buffer space
+    pthread_mutex_unlock (&buf_mutex);
+}
 
-    if (nh == tail) {
-        fprintf (stderr, "USBInterface (libftdi) FATAL: overflow of circular buffer in threaded read routine. Sorry -- will exit now.\n");
-        exit (1);
+static void add_to_buf (const unsigned char *data, uint32_t size) {
+  // copies a whole block into the ring buffer; if the buffer is full we wait for the
+  // consumer instead of dropping data (the FTDI chip then holds off the testboard)
+    pthread_mutex_lock (&buf_mutex);
+    pthread_cleanup_push (unlock_buf, NULL);
+    while (size > 0) {
+        while (buf_fill == BUFSIZE && !reader_stop) pthread_cond_wait (&buf_space, &buf_mutex);
+        if (reader_stop) break;
+
+        uint32_t n = BUFSIZE - buf_fill;
+        if (n > size) n = size;
+        if (n > BUFSIZE - head) n = BUFSIZE - head; // copy up to the end of the ring first
+        memcpy (read_buffer + head, data, n);
+        head += n;
+        if (head == BUFSIZE) head = 0;
+        buf_fill += n;
+        data += n;
+        size -= n;
+        pthread_cond_signal (&buf_data);
     }
-    read_buffer[head] = c;
-    head = nh;
-    sem_post (&buf_data);
+    pthread_cleanup_pop (1);
 }
 
-static void *reader (void *arg) {
-  // there is no non-blocking read command implemented in libftdi ->
-  // therefore we use multithreading and a static buffer to emulate
-  // non-blocking calls
-    struct ftdi_context *handle = (struct ftdi_context *)(arg);
+static void poll_reader (struct ftdi_context *handle) {
+  // fallback: blocking reads of 4 kB, libftdi removes the modem status bytes
     unsigned char buf[0x1000];
-    int32_t br, i;
+    int32_t br;
 
-    while (1) {
+    while (!reader_stop) {
       usleep(100); // wait 0.1 ms
       pthread_testcancel();
       br = ftdi_read_data (handle, buf, sizeof(buf));
@@ -66,11 +97,209 @@ static void *reader (void *arg) {
 	std::cout << " ERROR during USB read polling: error code from libusb_bulk_transfer(): " << br << std::endl;
       }
       if (br > 0){
-	for (i=0; i<br; i++){
-	  add_to_buf (buf[i]);
-	}
+	add_to_buf (buf, br);
+      }
+    }
+}
+
+static bool deliver (struct read_slot *slot) {
+  // copies what fits of the slot's data into the ring buffer without waiting,
+  // true when all of it is in; called with buf_mutex locked
+    while (slot->len > 0 && buf_fill < BUFSIZE) {
+      uint32_t n = BUFSIZE - buf_fill;
+      if (n > slot->len) n = slot->len;
+      if (n > BUFSIZE - head) n = BUFSIZE - head; // copy up to the end of the ring first
+      memcpy (read_buffer + head, slot->transfer->buffer + slot->pos, n);
+      head += n;
+      if (head == BUFSIZE) head = 0;
+      buf_fill += n;
+      slot->pos += n;
+      slot->len -= n;
+      pthread_cond_signal (&buf_data);
+    }
+    return slot->len == 0;
+}
+
+static void resubmit (struct read_slot *slot) {
+  // hands the transfer back to libusb, read_active already counts it
+    int32_t status = libusb_submit_transfer (slot->transfer);
+    if (status < 0) {
+      std::cout << " ERROR resubmitting asynchronous USB read: " << libusb_error_name(status) << std::endl;
+      pthread_mutex_lock (&buf_mutex);
+      read_active--;
+      pthread_mutex_unlock (&buf_mutex);
+    }
+}
+
+static void read_callback (struct libusb_transfer *transfer) {
+    struct read_slot *slot = (struct read_slot *)(transfer->user_data);
+
+    slot->pos = slot->len = 0;
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+      // every USB packet starts with two modem status bytes which are not part of the data,
+      // the payloads are moved together at the start of the buffer
+      int32_t packetSize = slot->handle->max_packet_size;
+      for (int32_t pos = 0; pos < transfer->actual_length; pos += packetSize) {
+	int32_t n = transfer->actual_length - pos;
+	if (n > packetSize) n = packetSize;
+	if (n <= 2) continue;
+	memmove (transfer->buffer + slot->len, transfer->buffer + pos + 2, n - 2);
+	slot->len += n - 2;
+      }
+    }
+    else if (transfer->status != LIBUSB_TRANSFER_CANCELLED && transfer->status != LIBUSB_TRANSFER_TIMED_OUT) {
+      std::cout << " ERROR during asynchronous USB read: transfer status " << transfer->status << std::endl;
+    }
+
+    bool again = false;
+    pthread_mutex_lock (&buf_mutex);
+    read_active--;
+    if (!reader_stop && !read_stopping && transfer->status != LIBUSB_TRANSFER_CANCELLED
+	&& transfer->status != LIBUSB_TRANSFER_NO_DEVICE) {
+      if (read_parked.empty () && deliver (slot)) {
+	read_active++;
+	again = true;
+      } else {
+	read_parked.push_back (slot);
+      }
+    }
+    pthread_mutex_unlock (&buf_mutex);
+    if (again) resubmit (slot);
+}
+
+static void resume_parked () {
+  // resubmits the parked transfers, in order, as long as their data fits into the ring buffer
+    while (true) {
+      struct read_slot *slot = NULL;
+      pthread_mutex_lock (&buf_mutex);
+      if (!read_parked.empty () && !read_stopping && deliver (read_parked.front ())) {
+	slot = read_parked.front ();
+	read_parked.pop_front ();
+	read_active++;
+      }
+      pthread_mutex_unlock (&buf_mutex);
+      if (slot == NULL) break;
+      resubmit (slot);
+    }
+}
+
+static bool async_busy (int *active, bool *parked) {
+  // state of the engine for the reader thread: transfers with libusb, transfers parked
+    pthread_mutex_lock (&buf_mutex);
+    *active = read_active;
+    *parked = !read_parked.empty ();
+    pthread_mutex_unlock (&buf_mutex);
+    return *active > 0 || *parked;
+}
+
+static bool async_start (struct ftdi_context *handle) {
+    pthread_mutex_lock (&buf_mutex);
+    read_active = 0;
+    read_parked.clear ();
+    pthread_mutex_unlock (&buf_mutex);
+    read_stopping = false;
+    read_slots = new struct read_slot[read_nTransfers];
+    for (uint32_t i = 0; i < read_nTransfers; i++) {
+      read_slots[i].transfer = NULL;
+      read_slots[i].handle = handle;
+      read_slots[i].pos = read_slots[i].len = 0;
+    }
+    for (uint32_t i = 0; i < read_nTransfers; i++) {
+      read_slots[i].transfer = libusb_alloc_transfer (0);
+      if (read_slots[i].transfer == NULL) return false;
+      // libftdi names the endpoints from the chip's point of view: out_ep is the one we read from
+      libusb_fill_bulk_transfer (read_slots[i].transfer, handle->usb_dev, handle->out_ep,
+				 new unsigned char[read_transferSize], read_transferSize,
+				 read_callback, &read_slots[i], 0);
+      pthread_mutex_lock (&buf_mutex);
+      read_active++;
+      pthread_mutex_unlock (&buf_mutex);
+      int32_t status = libusb_submit_transfer (read_slots[i].transfer);
+      if (status < 0) {
+	std::cout << " Warning: could not queue asynchronous USB read: " << libusb_error_name(status) << std::endl;
+	pthread_mutex_lock (&buf_mutex);
+	read_active--;
+	pthread_mutex_unlock (&buf_mutex);
+	return false;
+      }
+    }
+    return true;
+}
+
+static void async_stop (struct ftdi_context *handle) {
+    // no more resubmits, cancel what is still queued and let libusb deliver the cancellations
+    read_stopping = true;
+    for (uint32_t i = 0; i < read_nTransfers; i++)
+      if (read_slots[i].transfer != NULL) libusb_cancel_transfer (read_slots[i].transfer);
+    int active;
+    bool parked;
+    for (int32_t n = 0; async_busy (&active, &parked) && active > 0 && n < 100; n++) {
+      struct timeval tv = {0, 10000};
+      libusb_handle_events_timeout (handle->usb_ctx, &tv);
+    }
+    if (active > 0) {
+      // libusb still owns transfers and would write into freed memory: better leak them
+      std::cout << " Warning: " << active << " asynchronous USB reads not cancelled, their buffers are kept" << std::endl;
+      read_slots = NULL;
+      return;
+    }
+    for (uint32_t i = 0; i < read_nTransfers; i++) {
+      if (read_slots[i].transfer == NULL) continue;
+      delete[] read_slots[i].transfer->buffer;
+      libusb_free_transfer (read_slots[i].transfer);
+    }
+    delete[] read_slots;
+    read_slots = NULL;
+    pthread_mutex_lock (&buf_mutex);
+    read_parked.clear ();
+    pthread_mutex_unlock (&buf_mutex);
+}
+
+static void *reader (void *arg) {
+  // there is no non-blocking read command implemented in libftdi ->
+  // therefore we use multithreading and a static buffer to emulate
+  // non-blocking calls
+    struct ftdi_context *handle = (struct ftdi_context *)(arg);
+
+    if (read_nTransfers == 0) {
+      poll_reader (handle);
+      return NULL;
+    }
+
+    // the asynchronous engine must not be cancelled inside libusb, it checks reader_stop instead
+    pthread_setcancelstate (PTHREAD_CANCEL_DISABLE, NULL);
+    if (!async_start (handle)) {
+      std::cout << " Warning: falling back to polled USB reads" << std::endl;
+      async_stop (handle);
+      read_nTransfers = 0; // Show() reports the polled reads
+      pthread_setcancelstate (PTHREAD_CANCEL_ENABLE, NULL);
+      poll_reader (handle);
+      return NULL;
+    }
+    int active;
+    bool parked;
+    while (!reader_stop && async_busy (&active, &parked)) {
+      if (active > 0) {
+	// short slices while transfers are parked, so they are resubmitted soon
+	struct timeval tv = {0, parked ? 10000 : 100000};
+	libusb_handle_events_timeout (handle->usb_ctx, &tv);
+      } else {
+	// all transfers parked: wait for the consumer
+	struct timeval now;
+	struct timespec deadline;
+	gettimeofday (&now, NULL);
+	deadline.tv_sec = now.tv_sec;
+	deadline.tv_nsec = now.tv_usec * 1000 + 10000000;
+	if (deadline.tv_nsec >= 1000000000) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000; }
+	pthread_mutex_lock (&buf_mutex);
+	if (buf_fill == BUFSIZE && !reader_stop) pthread_cond_timedwait (&buf_space, &buf_mutex, &deadline);
+	pthread_mutex_unlock (&buf_mutex);
       }
+      resume_parked ();
     }
+    if (!reader_stop && !async_busy (&active, &parked))
+      std::cout << " ERROR: asynchronous USB read engine stopped, no more data will be received" << std::endl;
+    async_stop (handle);
     return NULL;
 }
 
@@ -80,6 +309,7 @@ static void *usbclose (void *arg) {
     struct ftdi_context *handle = (struct ftdi_context *)(arg);
     ftdi_usb_close(handle);
     pthread_mutex_lock(&cleanup_mutex); usbclose_done = true; pthread_mutex_unlock(&cleanup_mutex);
+    return NULL;
 }
 
 static void *usbdeinit (void *arg) {
@@ -88,6 +318,7 @@ static void *usbdeinit (void *arg) {
     struct ftdi_context *handle = (struct ftdi_context *)(arg);
     ftdi_deinit(handle);
     pthread_mutex_lock(&cleanup_mutex); usbdeinit_done = true; pthread_mutex_unlock(&cleanup_mutex);
+    return NULL;
 }
 
 uint32_t FindAllUSB(struct ftdi_device_list ** devlist){
@@ -129,6 +360,9 @@ uint32_t FindAllUSB(struct ftdi_device_list ** devlist){
 CUSB::CUSB(){
       m_posR = m_sizeR = m_posW = 0;
       m_timeout = 15000; // maximum time to wait for read call in ms
+      m_readTransfers = USBREADTRANSFERS;
+      m_readTransferSize = USBREADTRANSFERSIZE;
+      ResetReadRate();
       isUSB_open = false;
       ftdiStatus = 0;
       enumPos = enumCount = 0;
@@ -160,7 +394,7 @@ CUSB::~CUSB(){
 
 const char* CUSB::GetErrorMsg()
 {
-  ftdi_get_error_string(&ftdic);
+  return ftdi_get_error_string(&ftdic);
 }
 
 
@@ -343,8 +577,15 @@ bool CUSB::Open(char serialNumber[])
   }
 
   // init threads for client-side data buffering
-  sem_init (&buf_data, 0, 0);
-  sem_init (&buf_space, 0, BUFSIZE);
+  pthread_mutex_lock (&buf_mutex);
+  head = tail = buf_fill = 0;
+  reader_stop = false;
+  pthread_mutex_unlock (&buf_mutex);
+  // transfers have to be a multiple of the USB packet size (each packet carries its own status bytes)
+  read_nTransfers = m_readTransfers;
+  read_transferSize = m_readTransferSize - m_readTransferSize % ftdic.max_packet_size;
+  if (read_transferSize == 0) read_transferSize = ftdic.max_packet_size;
+  ResetReadRate();
   pthread_create (&readerthread, NULL, reader, &ftdic);
 
   return true;
@@ -353,12 +594,15 @@ bool CUSB::Open(char serialNumber[])
 
 void CUSB::Close(){
   if( !isUSB_open) return;
+  // wake the reader thread in case it waits for buffer space
+  pthread_mutex_lock (&buf_mutex);
+  reader_stop = true;
+  pthread_cond_signal (&buf_space);
+  pthread_mutex_unlock (&buf_mutex);
   pthread_cancel(readerthread);
   usleep(10000);
-  // join reader thread and clean up semaphores
+  // join reader thread
   int pth_status = pthread_join(readerthread, NULL);
-  sem_destroy (&buf_data);
-  sem_destroy (&buf_space);
   usleep(10000);
   // set the flag (lock mutex first)
   pthread_mutex_lock(&cleanup_mutex); usbclose_done = false; pthread_mutex_unlock(&cleanup_mutex);
@@ -425,42 +669,55 @@ void CUSB::Read(uint32_t bytesToRead, void *buffer, uint32_t &bytesRead)
 {
    if (!isUSB_open) throw CRpcError(CRpcError::READ_ERROR);
  
-   // Copy over data from the circular buffer
-    int32_t i;
-    int32_t timewasted = 0; // time in ms wasted in this routine
-
-      for (i=0; i<bytesToRead; i++) {
-	bool bufferready = true;
-	if (tail == head) bufferready = false;
-	if (!bufferready){
-	  while (!bufferready && timewasted<m_timeout){
-	    if (timewasted==(m_timeout/10)) cout<< "USBInterface: Read(): data not ready after " << timewasted << "ms yet! Will wait for up to " << m_timeout << "ms"<< flush;
-	    if (timewasted>m_timeout && timewasted%100==0 ) cout << "." << flush;
-	    usleep(1000); //wait 1 ms
-	    timewasted++;
-	    if (tail != head) bufferready = true;	    
-	  }
-	  // if timeout message was printed before show the conclusion now
-	  if (timewasted >= (m_timeout/10)){
-	    if (bufferready) cout << "..done!" << endl;
-	    else cout << "..failed! :(    .. maybe adjust timeout setting (method SetTimeout(int)) for this call?" <<endl;
-	  }
+   // Copy over data from the circular buffer in blocks
+    uint32_t i = 0;
+    uint32_t timewasted = 0; // time in ms wasted in this routine
+
+    pthread_mutex_lock (&buf_mutex);
+    while (i < bytesToRead) {
+      if (buf_fill == 0) {
+	// wait for the reader thread in slices of 100 ms so we can keep the user informed
+	while (buf_fill == 0 && timewasted < m_timeout) {
+	  if (timewasted >= (m_timeout/10) && timewasted < (m_timeout/10) + 100)
+	    cout<< "USBInterface: Read(): data not ready after " << timewasted << "ms yet! Will wait for up to " << m_timeout << "ms"<< flush;
+	  else if (timewasted > (m_timeout/10)) cout << "." << flush;
+	  uint32_t slice = m_timeout - timewasted;
+	  if (slice > 100) slice = 100;
+	  struct timeval now;
+	  struct timespec deadline;
+	  gettimeofday (&now, NULL);
+	  deadline.tv_sec = now.tv_sec + slice / 1000;
+	  deadline.tv_nsec = now.tv_usec * 1000 + (slice % 1000) * 1000000;
+	  if (deadline.tv_nsec >= 1000000000) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000; }
+	  if (pthread_cond_timedwait (&buf_data, &buf_mutex, &deadline) == ETIMEDOUT) timewasted += slice;
+	}
+	// if timeout message was printed before show the conclusion now
+	if (timewasted >= (m_timeout/10)){
+	  if (buf_fill > 0) cout << "..done!" << endl;
+	  else cout << "..failed! :(    .. maybe adjust timeout setting (method SetTimeout(int)) for this call?" <<endl;
+	}
+	if (buf_fill == 0) {
+	  // buffer was not ready and reading it timed out so we stop attempting it now
+	  pthread_mutex_unlock (&buf_mutex);
+	  m_rateBytes += i;
+	  bytesRead = i;
+	  throw CRpcError(CRpcError::READ_TIMEOUT);
 	}
-	if (bufferready){
-	  sem_wait (&buf_data);	
-	  ((unsigned char*)buffer)[i] = read_buffer[tail];
-	  if (tail == (BUFSIZE -1)) tail = 0;
-	  else                      tail++;
-	  sem_post (&buf_space);
-	} 
-	else // buffer was not ready and reading it timed out so we stop attempting it now
-	  {
-	    bytesRead = i;
-	    throw CRpcError(CRpcError::READ_TIMEOUT);
-	    break;
-	  }
       }
-      bytesRead = i;
+
+      uint32_t n = bytesToRead - i;
+      if (n > buf_fill) n = buf_fill;
+      if (n > BUFSIZE - tail) n = BUFSIZE - tail; // copy up to the end of the ring first
+      memcpy ((unsigned char*)buffer + i, read_buffer + tail, n);
+      tail += n;
+      if (tail == BUFSIZE) tail = 0;
+      buf_fill -= n;
+      i += n;
+      pthread_cond_signal (&buf_space);
+    }
+    pthread_mutex_unlock (&buf_mutex);
+    m_rateBytes += i;
+    bytesRead = i;
 }
 
 //----------------------------------------------------------------------
@@ -471,11 +728,10 @@ void CUSB::Clear()
   ftdiStatus = ftdi_usb_purge_buffers(&ftdic);
 
   // drain our buffer.
-  while (head != tail) {
-    unsigned char t;
-    uint32_t n;
-    Read(1, &t, n);
-  }
+  pthread_mutex_lock (&buf_mutex);
+  head = tail = buf_fill = 0;
+  pthread_cond_signal (&buf_space);
+  pthread_mutex_unlock (&buf_mutex);
 
   m_posR = m_sizeR = 0;
   m_posW = 0;
@@ -490,16 +746,45 @@ bool CUSB::Show()
     return false;
   }
   cout << "  - max timeout for read calls set to " << m_timeout << "ms" << endl;
+  if (read_nTransfers > 0)
+    cout << "  - asynchronous reads: " << read_nTransfers << " transfers of " << read_transferSize << " bytes" << endl;
+  else
+    cout << "  - polled reads" << endl;
+  cout << "  - average read rate: " << GetReadRate() << " MB/s" << endl;
 
   unsigned char latency;
   if (ftdi_get_latency_timer(&ftdic,&latency)==0)  cout << "  - FTDI latency timer set to " << (int) latency << endl;
-  cout << "  - data waiting in local read buffer: " << !(tail == head) << endl;
+  pthread_mutex_lock (&buf_mutex);
+  cout << "  - data waiting in local read buffer: " << buf_fill << " bytes" << endl;
+  pthread_mutex_unlock (&buf_mutex);
   
 
   
   return true;
 }
 
+//----------------------------------------------------------------------
+void CUSB::SetReadQueue(uint32_t nTransfers, uint32_t transferSize)
+{
+  m_readTransfers = nTransfers;
+  m_readTransferSize = transferSize;
+}
+
+double CUSB::GetReadRate()
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  double seconds = (now.tv_sec - m_rateStart.tv_sec) + 1e-6 * (now.tv_usec - m_rateStart.tv_usec);
+  if (seconds <= 0) return 0;
+  return m_rateBytes / seconds / 1e6;
+}
+
+void CUSB::ResetReadRate()
+{
+  m_rateBytes = 0;
+  gettimeofday(&m_rateStart, NULL);
+}
+
 //----------------------------------------------------------------------
 int32_t CUSB::GetQueue()
 {
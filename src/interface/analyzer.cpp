@@ -1,6 +1,7 @@
 // analyzer.cpp
 
 #include "analyzer.h"
+#include "ReadoutScanner.h"
 
 using namespace std;
 
@@ -51,3 +52,72 @@ void DecodePixel(const vector<uint16_t> &x, int &pos, PixelReadoutData &pix)
 	pix.y = 80 - r/2;
 	pix.x = 2*c + (r&1);
 }
+
+
+static inline void DecodeHit(uint32_t raw, uint32_t event, uint8_t roc, PixelHitList &hits)
+{
+	uint8_t flags = (raw & 0x10) ? DECODE_FILLBIT : 0;
+	uint16_t p = (raw & 0x0f) + ((raw >> 1) & 0xf0);
+	raw >>= 9;
+	// base 6 digits: 2 for the double column, 3 for the pixel in it
+	unsigned int c1 = (raw >> 12) & 7, c0 = (raw >> 9) & 7;
+	unsigned int r2 = (raw >>  6) & 7, r1 = (raw >> 3) & 7, r0 = raw & 7;
+	if (c1 > 5 || c0 > 5 || r2 > 5 || r1 > 5 || r0 > 5) flags |= DECODE_ADDRESS;
+	int c = c1*6 + c0;
+	int r = (r2*6 + r1)*6 + r0;
+	int y = 80 - r/2;
+	int x = 2*c + (r&1);
+	if (x < 0 || x >= ROC_NUMCOLS || y < 0 || y >= ROC_NUMROWS) flags |= DECODE_ADDRESS;
+
+	hits.event.push_back(event);
+	hits.roc.push_back(roc);
+	hits.col.push_back(uint8_t(x));
+	hits.row.push_back(uint8_t(y));
+	hits.ph.push_back(p);
+	hits.flags.push_back(flags);
+	hits.eventFlags.back() |= flags;
+}
+
+
+size_t DecodeReadouts(const uint16_t *x, size_t n, PixelHitList &hits, bool complete)
+{
+	ReadoutIndex index;
+	ScanReadouts(x, n, index);
+	unsigned int nEvents = index.Events();
+	size_t end = n;
+	if (!complete)
+	{ // stop at the last header
+		if (nEvents == 0) return 0;
+		end = index.event[--nEvents];
+	}
+	hits.skipped += index.Events() ? index.event[0] : end;
+
+	for (unsigned int e = 0; e < nEvents; e++)
+	{
+		size_t pos = index.event[e];
+		size_t last = pos + index.EventSize(e, n);
+		uint16_t hdr = x[pos];
+
+		uint32_t event = hits.header.size();
+		hits.header.push_back(hdr & 0xfff);
+		if ((hdr & 0x8ffc) != 0x87f8)
+		{
+			hits.eventFlags.push_back(DECODE_HEADER);
+			continue;
+		}
+		hits.eventFlags.push_back(0);
+
+		// the first ROC header is the readout start, the hits of a ROC
+		// end at the header of the next one
+		unsigned int r = index.eventRoc[e], rEnd = r + index.EventRocs(e);
+		for (uint8_t roc = 0; r < rEnd; r++, roc++)
+		{
+			size_t end = r + 1 < rEnd ? index.roc[r+1] : last;
+			pos = index.roc[r] + 1;
+			if ((end - pos) & 1) hits.eventFlags.back() |= DECODE_INCOMPLETE;
+			for (; pos + 1 < end; pos += 2)
+				DecodeHit((uint32_t(x[pos] & 0xfff) << 12) | (x[pos+1] & 0xfff), event, roc, hits);
+		}
+	}
+	return end;
+}
@@ -16,5 +16,54 @@ struct PixelReadoutData
 };
 
 
+// decoder error flags of a readout (PixelHitList::eventFlags) or a hit
+#define DECODE_HEADER     0x01  // no valid ROC header, the readout data is skipped
+#define DECODE_INCOMPLETE 0x02  // odd number of data words, the last one is ignored
+#define DECODE_ADDRESS    0x04  // invalid column or row code
+#define DECODE_FILLBIT    0x08  // bit between the pulse height nibbles set
+
+
+// All hits of a sequence of readouts, one readout per trigger. Each hit
+// carries the index of its readout and the position of its ROC in the
+// readout (0 for the first ROC header), readouts without hits have no entry.
+struct PixelHitList
+{
+	// per readout
+	std::vector<uint16_t> header;
+	std::vector<uint8_t>  eventFlags; // DECODE_..., including those of its hits
+
+	// per hit
+	std::vector<uint32_t> event;
+	std::vector<uint8_t>  roc;
+	std::vector<uint8_t>  col;
+	std::vector<uint8_t>  row;
+	std::vector<uint16_t> ph;
+	std::vector<uint8_t>  flags;
+
+	unsigned int skipped; // samples before the first header
+
+	PixelHitList() : skipped(0) {}
+	unsigned int Events() const { return header.size(); }
+	unsigned int Hits() const { return event.size(); }
+	void Clear()
+	{
+		header.clear(); eventFlags.clear();
+		event.clear(); roc.clear(); col.clear(); row.clear(); ph.clear(); flags.clear();
+		skipped = 0;
+	}
+};
+
+
 void DumpData(const vector<uint16_t> &x, unsigned int n);
 void DecodePixel(const std::vector<uint16_t> &x, int &pos, PixelReadoutData &pix);
+
+// Appends the readouts in x[0..n) to hits. A readout of a module holds one
+// ROC header per ROC, the hits after a header belong to that ROC. Errors
+// don't stop the decoding, they are flagged at the readout and hit
+// concerned. With complete false the last readout may continue in the next
+// block, it is left for the next call. Returns the number of samples
+// decoded.
+size_t DecodeReadouts(const uint16_t *x, size_t n, PixelHitList &hits, bool complete = true);
+
+inline size_t DecodeReadouts(const std::vector<uint16_t> &x, PixelHitList &hits)
+{ return x.empty() ? 0 : DecodeReadouts(&x[0], x.size(), hits); }
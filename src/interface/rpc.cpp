@@ -19,6 +19,7 @@ void rpcMessage::Send(CRpcIo &rpc_io)
 	rpc_io.Write(&m_cmd,  2);
 	rpc_io.Write(&m_size, 1);
 	if (m_size) rpc_io.Write(m_par, m_size);
+	rpc_io.m_txBytes += 4 + m_size;
 }
 
 
@@ -33,12 +34,78 @@ void rpcMessage::Receive(CRpcIo &rpc_io)
 		uint16_t size;
 		rpc_io.Read(&chn, 1);
 		rpc_io.Read(&size, 2);
+		rpc_io.m_rxBytes += 4;
 		rpc_DataSink(rpc_io, size);
 		throw CRpcError(CRpcError::NO_CMD_MSG);
 	}
 	rpc_io.Read(&m_cmd, 2);
 	rpc_io.Read(&m_size, 1);
 	if (m_size) rpc_io.Read(m_par, m_size);
+	rpc_io.m_rxBytes += 4 + m_size;
+}
+
+
+// === deferred calls =======================================================
+
+void rpcQueue::Sync(CRpcIo &rpc_io, rpcDeferred *last)
+{
+	rpc_io.Flush();
+	while (!m_pending.empty())
+	{
+		rpcDeferred *x = m_pending.front();
+		m_pending.pop_front();
+		bool done = x == last;
+		try
+		{
+			uint64_t rx = rpc_io.m_rxBytes;
+			x->Receive(rpc_io);
+			if (m_profiler && m_profiler->IsEnabled())
+				m_profiler->AddDeferredReply(x->m_functionId, rpc_io.m_rxBytes - rx);
+			x->m_done = true;
+			x->Release();
+			if (done) break;
+		}
+		catch (CRpcError &e)
+		{
+			// the stream is out of step now, don't wait for the remaining replies
+			e.SetFunction(x->m_functionId);
+			x->Fail(e);
+			x->Release();
+			while (!m_pending.empty())
+			{
+				m_pending.front()->Fail(e);
+				m_pending.front()->Release();
+				m_pending.pop_front();
+			}
+		}
+	}
+}
+
+
+void rpcQueue::Clear()
+{
+	CRpcError e(CRpcError::READ_ERROR);
+	while (!m_pending.empty())
+	{
+		m_pending.front()->Fail(e);
+		m_pending.front()->Release();
+		m_pending.pop_front();
+	}
+}
+
+
+void rpcPending::Wait()
+{
+	if (!m_reply) throw CRpcError(CRpcError::UNDEF);
+	if (!m_reply->m_done)
+	{
+		// replies queued after this one stay pending, so that the board
+		// can go on with them while the caller works on this result
+		std::lock_guard<std::recursive_mutex> lock(m_queue->m_sync);
+		if (!m_reply->m_done) m_queue->Sync(*m_io, m_reply);
+	}
+	if (!m_reply->m_done) throw CRpcError(CRpcError::READ_ERROR);
+	if (m_reply->m_failed) throw m_reply->m_error;
 }
 
 
@@ -54,11 +121,13 @@ void CDataHeader::RecvHeader(CRpcIo &rpc_io)
 		uint8_t size;
 		rpc_io.Read(&cmd, 2);
 		rpc_io.Read(&size, 1);
+		rpc_io.m_rxBytes += 4;
 		rpc_DataSink(rpc_io, size);
 		throw CRpcError(CRpcError::NO_DATA_MSG);
 	}
 	rpc_io.Read(&m_chn, 1);
 	rpc_io.Read(&m_size, 2);
+	rpc_io.m_rxBytes += 4;
 }
 
 
@@ -70,6 +139,7 @@ void rpc_SendRaw(CRpcIo &rpc_io, uint8_t channel, const void *x, uint16_t size)
 	rpc_io.Write(&channel, 1);
 	rpc_io.Write(&size, 2);
 	if (size) rpc_io.Write(x, size);
+	rpc_io.m_txBytes += 4 + size;
 //	printf("Send Data [%i]\n", int(size));
 }
 
@@ -79,6 +149,7 @@ void rpc_DataSink(CRpcIo &rpc_io, uint16_t size)
 	if (size == 0) return;
 	CBuffer buffer(size);
 	rpc_io.Read(&buffer, size);
+	rpc_io.m_rxBytes += size;
 }
 
 
@@ -86,14 +157,9 @@ void rpc_Receive(CRpcIo &rpc_io, string &x)
 {
 	CDataHeader msg;
 	msg.RecvHeader(rpc_io);
-	x.clear();
-	x.reserve(msg.m_size);
-	char ch;
-	for (uint16_t i=0; i<msg.m_size; i++)
-	{
-		rpc_io.Read(&ch, 1);
-		x.push_back(ch);
-	}
+	x.resize(msg.m_size);
+	if (msg.m_size) rpc_io.Read(&(x[0]), msg.m_size);
+	rpc_io.m_rxBytes += msg.m_size;
 }
 
 
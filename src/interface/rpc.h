@@ -4,21 +4,24 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
 #include <stdint.h>
 
 #include <unistd.h>
 
 #include "rpc_io.h"
 #include "rpc_error.h"
+#include "rpc_profiler.h"
 
-#ifndef RPC_PROFILING
-#define RPC_PROFILING
-#endif
-
+// With RPC_MULTITHREADING each call holds the lock of its rpc_queue from
+// sending the request to receiving the reply, so several threads can share
+// one connection (e.g. a test sequencer and a DAQ reader). The lock is
+// recursive, calls may be nested. Open, Close and rpc_Clear are not covered.
 #ifdef RPC_MULTITHREADING
-#include <boost/thread.hpp>
-#define RPC_THREAD boost::mutex m_sync;
-#define RPC_THREAD_LOCK boost::lock_guard<boost::mutex> lock(m_sync);
+#define RPC_THREAD
+#define RPC_THREAD_LOCK std::lock_guard<std::recursive_mutex> rpc_lock(rpc_queue.m_sync);
 #define RPC_THREAD_UNLOCK
 #else
 #define RPC_THREAD
@@ -26,6 +29,13 @@
 #define RPC_THREAD_UNLOCK
 #endif
 
+// counts calls, traffic and round trip times per command while
+// rpc_profiler is enabled. It also takes the RPC_THREAD_LOCK of the call:
+// to compile the profiling out define it as RPC_THREAD_LOCK, not as empty.
+#ifndef RPC_PROFILING
+#define RPC_PROFILING(cmd, wait) RPC_THREAD_LOCK rpcProfileCall rpc_profileCall(rpc_profiler, *rpc_io, cmd, wait);
+#endif
+
 using namespace std;
 
 #define RPC_TYPE_ATB      0x8F
@@ -34,28 +44,44 @@ using namespace std;
 
 extern const char rpc_timestamp[];
 
+// rpc_cmdId: call id on the board, -1 not resolved yet, RPC_CMD_MISSING
+// not provided by the board firmware
+#define RPC_CMD_MISSING -2
+
 #define RPC_DEFS \
 	CRpcIo *rpc_io; \
+	rpcQueue rpc_queue; \
+	rpcProfiler rpc_profiler; \
 	static const char rpc_timestamp[]; \
 	static const unsigned int rpc_cmdListSize; \
 	static const char *rpc_cmdName[]; \
 	int *rpc_cmdId; \
-	void rpc_Clear() { rpc_cmdId[0] = 0; rpc_cmdId[1] = 1; for ( unsigned int i=2; i<rpc_cmdListSize; i++) rpc_cmdId[i] = -1; } \
+	void rpc_Clear() { rpc_queue.Clear(); rpc_cmdId[0] = 0; rpc_cmdId[1] = 1; for ( unsigned int i=2; i<rpc_cmdListSize; i++) rpc_cmdId[i] = -1; } \
+	void rpc_Sync() { rpc_queue.Sync(*rpc_io); } \
 	void rpc_Connect(CRpcIo &port) { rpc_io = &port; rpc_Clear(); } \
 	uint16_t rpc_GetCallId(uint16_t x) \
 	{ \
+		RPC_THREAD_LOCK \
 		int id = rpc_cmdId[x]; \
 		if (id >= 0) return id; \
+		if (id == RPC_CMD_MISSING) throw CRpcError(CRpcError::UNKNOWN_CMD); \
 		string name(rpc_cmdName[x]); \
 		rpc_cmdId[x] = id = GetRpcCallId(name); \
 		if (id >= 0) return id; \
+		rpc_cmdId[x] = RPC_CMD_MISSING; \
+		throw CRpcError(CRpcError::UNKNOWN_CMD); \
+	} \
+	static uint16_t rpc_CmdIndex(const string &name) \
+	{ \
+		for (unsigned int i=0; i<rpc_cmdListSize; i++) if (name == rpc_cmdName[i]) return i; \
 		throw CRpcError(CRpcError::UNKNOWN_CMD); \
 	} \
 	friend class CRpcError;
 
-#define RPC_INIT rpc_io = &RpcIoNull; rpc_cmdId = new int[rpc_cmdListSize]; rpc_Clear();
+#define RPC_INIT rpc_io = &RpcIoNull; rpc_cmdId = new int[rpc_cmdListSize]; rpc_Clear(); \
+	rpc_profiler.Init(rpc_cmdListSize, rpc_cmdName); rpc_queue.SetProfiler(&rpc_profiler);
 
-#define RPC_EXIT delete[] rpc_cmdId;
+#define RPC_EXIT if (rpc_profiler.IsEnabled()) rpc_profiler.Report(); delete[] rpc_cmdId;
 
 #define RPC_EXPORT
 
@@ -122,12 +148,105 @@ public:
 };
 
 
+// === deferred calls =======================================================
+
+// The _Async variants of the RPC calls send their request without flushing
+// and return a handle. The DTB answers in order, so all outstanding replies
+// are collected after a single flush when the first handle is resolved, or
+// before the next blocking call. Output references passed to an _Async call
+// must stay valid until the handle is resolved. A reply may be collected
+// by a blocking call of another thread, hence the atomic flags.
+
+class rpcDeferred
+{
+	std::atomic<int> m_refCount;
+public:
+	uint16_t m_callId;
+	int m_functionId;
+	std::atomic<bool> m_done;
+	bool m_failed;
+	CRpcError m_error;
+
+	rpcDeferred() : m_refCount(0), m_callId(0), m_functionId(-1), m_done(false), m_failed(false) {}
+	virtual ~rpcDeferred() {}
+	virtual void Receive(CRpcIo &rpc_io) = 0;
+	void AddRef() { m_refCount++; }
+	void Release() { if (--m_refCount <= 0) delete this; }
+	void Fail(CRpcError &e) { m_error = e; m_failed = true; m_done = true; }
+};
+
+
+template <class T>
+class rpcReply : public rpcDeferred
+{
+public:
+	T value;
+};
+
+
+class rpcQueue
+{
+	std::deque<rpcDeferred*> m_pending;
+	rpcProfiler *m_profiler;
+public:
+	std::recursive_mutex m_sync; // see RPC_MULTITHREADING
+
+	rpcQueue() : m_profiler(0) {}
+	~rpcQueue() { Clear(); }
+	void SetProfiler(rpcProfiler *profiler) { m_profiler = profiler; }
+	bool Empty() { return m_pending.empty(); }
+	unsigned int Size() { return m_pending.size(); }
+	void Push(rpcDeferred *x) { x->AddRef(); m_pending.push_back(x); }
+	void Sync(CRpcIo &rpc_io, rpcDeferred *last = 0); // flush and read the outstanding replies up to last, all by default
+	void Clear();              // drop outstanding replies (connection closed)
+};
+
+
+class rpcPending
+{
+protected:
+	rpcDeferred *m_reply;
+	rpcQueue *m_queue;
+	CRpcIo *m_io;
+public:
+	rpcPending() : m_reply(0), m_queue(0), m_io(0) {}
+	rpcPending(rpcDeferred *reply, rpcQueue &queue, CRpcIo &io)
+		: m_reply(reply), m_queue(&queue), m_io(&io) { m_reply->AddRef(); }
+	rpcPending(const rpcPending &x) : m_reply(x.m_reply), m_queue(x.m_queue), m_io(x.m_io)
+	{ if (m_reply) m_reply->AddRef(); }
+	rpcPending& operator=(const rpcPending &x)
+	{
+		if (x.m_reply) x.m_reply->AddRef();
+		if (m_reply) m_reply->Release();
+		m_reply = x.m_reply; m_queue = x.m_queue; m_io = x.m_io;
+		return *this;
+	}
+	~rpcPending() { if (m_reply) m_reply->Release(); }
+
+	bool Ready() { return m_reply && m_reply->m_done; }
+	void Wait();
+};
+
+
+template <class T>
+class rpcFuture : public rpcPending
+{
+public:
+	rpcFuture() {}
+	rpcFuture(rpcReply<T> *reply, rpcQueue &queue, CRpcIo &io) : rpcPending(reply, queue, io) {}
+	T Get() { Wait(); return static_cast<rpcReply<T>*>(m_reply)->value; }
+};
+
+
 // === data =================================================================
 
 #define vectorR vector
 #define stringR string
 
 
+void rpc_DataSink(CRpcIo &rpc_io, uint16_t size);
+
+
 class CDataHeader
 {
 public:
@@ -136,14 +255,20 @@ public:
 	uint16_t m_size;
 
 	void RecvHeader(CRpcIo &rpc_io);
+	// # of elements of the given size, drops the data if they don't fit
+	uint32_t Count(CRpcIo &rpc_io, unsigned int elementSize, uint32_t maxCount = 0xffff)
+	{
+		uint32_t n = m_size/elementSize;
+		if (n*elementSize == m_size && n <= maxCount) return n;
+		rpc_DataSink(rpc_io, m_size);
+		throw CRpcError(CRpcError::WRONG_DATA_SIZE);
+	}
 	void RecvRaw(CRpcIo &rpc_io, void *x)
-	{ if (m_size) rpc_io.Read(x, m_size); }
+	{ if (m_size) rpc_io.Read(x, m_size); rpc_io.m_rxBytes += m_size; }
 };
 
 void rpc_SendRaw(CRpcIo &rpc_io, uint8_t channel, const void *x, uint16_t size);
 
-void rpc_DataSink(CRpcIo &rpc_io, uint16_t size);
-
 
 template <class T>
 inline void rpc_Send(CRpcIo &rpc_io, const vector<T> &x)
@@ -152,18 +277,32 @@ inline void rpc_Send(CRpcIo &rpc_io, const vector<T> &x)
 }
 
 
+// The receive functions read the payload straight into the destination.
+// A vector is resized to the received size first; resize() value-initializes
+// (zero fills) every element beyond the previous size, also in a vector that
+// was cleared before. Where that matters, receive into caller owned storage
+// with the pointer version below.
+
 template <class T>
 void rpc_Receive(CRpcIo &rpc_io, vector<T> &x)
 {
 	CDataHeader msg;
 	msg.RecvHeader(rpc_io);
-	if ((msg.m_size % sizeof(T)) != 0)
-	{
-		rpc_DataSink(rpc_io, msg.m_size);
-		throw CRpcError(CRpcError::WRONG_DATA_SIZE);
-	}
-	x.assign(msg.m_size/sizeof(T), 0);
-	if (x.size() != 0) rpc_io.Read(&(x[0]), msg.m_size);
+	x.resize(msg.Count(rpc_io, sizeof(T)));
+	msg.RecvRaw(rpc_io, x.empty() ? 0 : &(x[0]));
+}
+
+
+// into a caller owned buffer of maxCount elements, returns the number received;
+// nothing is initialized or cleared
+template <class T>
+uint32_t rpc_Receive(CRpcIo &rpc_io, T *x, uint32_t maxCount)
+{
+	CDataHeader msg;
+	msg.RecvHeader(rpc_io);
+	uint32_t n = msg.Count(rpc_io, sizeof(T), maxCount);
+	msg.RecvRaw(rpc_io, x);
+	return n;
 }
 
 
@@ -0,0 +1,96 @@
+// rpc_cache.cpp
+
+#include "rpc_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+CRpcCallIdCache::Table* CRpcCallIdCache::Find(uint16_t fwVersion, const std::string &timestamp, bool create)
+{
+	for (unsigned int i = 0; i < m_table.size(); i++)
+		if (m_table[i].fwVersion == fwVersion && m_table[i].timestamp == timestamp) return &m_table[i];
+	if (!create) return 0;
+	Table t;
+	t.fwVersion = fwVersion;
+	t.timestamp = timestamp;
+	m_table.push_back(t);
+	return &m_table.back();
+}
+
+
+bool CRpcCallIdCache::Load(const char *fileName)
+{
+	m_fileName = fileName;
+	m_table.clear();
+	m_changed = false;
+
+	FILE *f = fopen(fileName, "r");
+	if (!f) return false;
+	Table *t = 0;
+	char line[512];
+	while (fgets(line, sizeof(line), f))
+	{
+		line[strcspn(line, "\r\n")] = 0;
+		if (strncmp(line, "table ", 6) == 0)
+		{
+			char *ts;
+			unsigned long fw = strtoul(line + 6, &ts, 0);
+			if (*ts == ' ') ts++;
+			t = Find(uint16_t(fw), ts, true);
+			continue;
+		}
+		char *name;
+		long id = strtol(line, &name, 10);
+		if (!t || name == line || *name != ' ') continue;
+		t->id[name + 1] = int32_t(id);
+	}
+	fclose(f);
+	return true;
+}
+
+
+bool CRpcCallIdCache::Save()
+{
+	if (!m_changed || m_fileName.empty()) return true;
+
+	// write a new file and replace the old one, so that a concurrent
+	// reader never sees a partial table
+	std::string tmpName = m_fileName + ".tmp";
+	FILE *f = fopen(tmpName.c_str(), "w");
+	if (!f) return false;
+	for (unsigned int i = 0; i < m_table.size(); i++)
+	{
+		fprintf(f, "table 0x%04X %s\n", m_table[i].fwVersion, m_table[i].timestamp.c_str());
+		std::map<std::string, int32_t>::iterator it;
+		for (it = m_table[i].id.begin(); it != m_table[i].id.end(); it++)
+			fprintf(f, "%i %s\n", int(it->second), it->first.c_str());
+	}
+	bool ok = fclose(f) == 0;
+	if (ok) ok = rename(tmpName.c_str(), m_fileName.c_str()) == 0;
+	if (!ok) remove(tmpName.c_str());
+	else m_changed = false;
+	return ok;
+}
+
+
+bool CRpcCallIdCache::Get(uint16_t fwVersion, const std::string &timestamp, const char *name, int32_t &id)
+{
+	Table *t = Find(fwVersion, timestamp, false);
+	if (!t) return false;
+	std::map<std::string, int32_t>::iterator it = t->id.find(name);
+	if (it == t->id.end()) return false;
+	id = it->second;
+	return true;
+}
+
+
+void CRpcCallIdCache::Put(uint16_t fwVersion, const std::string &timestamp, const char *name, int32_t id)
+{
+	Table *t = Find(fwVersion, timestamp, true);
+	std::map<std::string, int32_t>::iterator it = t->id.find(name);
+	if (it != t->id.end() && it->second == id) return;
+	t->id[name] = id;
+	m_changed = true;
+}
@@ -0,0 +1,42 @@
+// rpc_cache.h
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+
+// Call ids of known DTB firmware, so that connecting to a board needs no
+// GetRpcCallId round trips. Text file with one table per firmware,
+// identified by its version and RPC timestamp:
+//
+//   table <firmware version> <rpc timestamp>
+//   <call id> <call name>
+//   ...
+//
+// Call id -1 marks a call the firmware doesn't provide.
+class CRpcCallIdCache
+{
+	struct Table
+	{
+		uint16_t fwVersion;
+		std::string timestamp;
+		std::map<std::string, int32_t> id;
+	};
+
+	std::string m_fileName;
+	std::vector<Table> m_table;
+	bool m_changed;
+
+	Table* Find(uint16_t fwVersion, const std::string &timestamp, bool create);
+public:
+	CRpcCallIdCache() : m_changed(false) {}
+
+	bool Load(const char *fileName); // a missing file gives an empty cache
+	bool Save();                     // writes the file if anything was added
+
+	bool Get(uint16_t fwVersion, const std::string &timestamp, const char *name, int32_t &id);
+	void Put(uint16_t fwVersion, const std::string &timestamp, const char *name, int32_t id);
+};
@@ -105,7 +105,7 @@ const char *CTestboard::rpc_cmdName[] =
 };
 
 uint16_t CTestboard::GetRpcVersion()
-{ RPC_PROFILING
+{ RPC_PROFILING(0, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(0);
@@ -113,7 +113,7 @@ uint16_t CTestboard::GetRpcVersion()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -122,8 +122,34 @@ uint16_t CTestboard::GetRpcVersion()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::GetRpcVersion_Async()
+{ RPC_PROFILING(0, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(0);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 0;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(0); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 int32_t CTestboard::GetRpcCallId(string &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(1, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(1);
@@ -132,7 +158,7 @@ int32_t CTestboard::GetRpcCallId(string &rpc_par1)
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
 	rpc_Send(*rpc_io, rpc_par1);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -141,15 +167,42 @@ int32_t CTestboard::GetRpcCallId(string &rpc_par1)
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::GetRpcCallId_Async(string &rpc_par1)
+{ RPC_PROFILING(1, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(1);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_Send(*rpc_io, rpc_par1);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 1;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(1); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::GetRpcTimestamp(stringR &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(2, true)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(2);
 	RPC_THREAD_LOCK
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,0);
 	rpc_Receive(*rpc_io, rpc_par1);
@@ -157,8 +210,36 @@ void CTestboard::GetRpcTimestamp(stringR &rpc_par1)
 	} catch (CRpcError &e) { e.SetFunction(2); throw; };
 }
 
+rpcPending CTestboard::GetRpcTimestamp_Async(stringR &rpc_par1)
+{ RPC_PROFILING(2, false)
+	struct rpc_Reply : public rpcDeferred
+	{
+		stringR *rpc_par1;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,0);
+			rpc_Receive(rpc_io, *rpc_par1);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par1 = &rpc_par1;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(2);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 2;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(2); throw; };
+	return rpcPending(rpc_reply, rpc_queue, *rpc_io);
+}
+
 int32_t CTestboard::GetRpcCallCount()
-{ RPC_PROFILING
+{ RPC_PROFILING(3, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(3);
@@ -166,7 +247,7 @@ int32_t CTestboard::GetRpcCallCount()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -175,8 +256,34 @@ int32_t CTestboard::GetRpcCallCount()
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::GetRpcCallCount_Async()
+{ RPC_PROFILING(3, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(3);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 3;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(3); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 bool CTestboard::GetRpcCallName(int32_t rpc_par1, stringR &rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(4, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(4);
@@ -185,7 +292,7 @@ bool CTestboard::GetRpcCallName(int32_t rpc_par1, stringR &rpc_par2)
 	msg.Create(rpc_clientCallId);
 	msg.Put_INT32(rpc_par1);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_BOOL();
@@ -195,15 +302,45 @@ bool CTestboard::GetRpcCallName(int32_t rpc_par1, stringR &rpc_par2)
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::GetRpcCallName_Async(int32_t rpc_par1, stringR &rpc_par2)
+{ RPC_PROFILING(4, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		stringR *rpc_par2;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_BOOL();
+			rpc_Receive(rpc_io, *rpc_par2);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par2 = &rpc_par2;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(4);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 4;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(4); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::GetInfo(stringR &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(5, true)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(5);
 	RPC_THREAD_LOCK
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,0);
 	rpc_Receive(*rpc_io, rpc_par1);
@@ -211,8 +348,36 @@ void CTestboard::GetInfo(stringR &rpc_par1)
 	} catch (CRpcError &e) { e.SetFunction(5); throw; };
 }
 
+rpcPending CTestboard::GetInfo_Async(stringR &rpc_par1)
+{ RPC_PROFILING(5, false)
+	struct rpc_Reply : public rpcDeferred
+	{
+		stringR *rpc_par1;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,0);
+			rpc_Receive(rpc_io, *rpc_par1);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par1 = &rpc_par1;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(5);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 5;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(5); throw; };
+	return rpcPending(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::GetBoardId()
-{ RPC_PROFILING
+{ RPC_PROFILING(6, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(6);
@@ -220,7 +385,7 @@ uint16_t CTestboard::GetBoardId()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -229,15 +394,41 @@ uint16_t CTestboard::GetBoardId()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::GetBoardId_Async()
+{ RPC_PROFILING(6, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(6);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 6;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(6); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::GetHWVersion(stringR &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(7, true)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(7);
 	RPC_THREAD_LOCK
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,0);
 	rpc_Receive(*rpc_io, rpc_par1);
@@ -245,8 +436,36 @@ void CTestboard::GetHWVersion(stringR &rpc_par1)
 	} catch (CRpcError &e) { e.SetFunction(7); throw; };
 }
 
+rpcPending CTestboard::GetHWVersion_Async(stringR &rpc_par1)
+{ RPC_PROFILING(7, false)
+	struct rpc_Reply : public rpcDeferred
+	{
+		stringR *rpc_par1;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,0);
+			rpc_Receive(rpc_io, *rpc_par1);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par1 = &rpc_par1;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(7);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 7;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(7); throw; };
+	return rpcPending(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::GetFWVersion()
-{ RPC_PROFILING
+{ RPC_PROFILING(8, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(8);
@@ -254,7 +473,7 @@ uint16_t CTestboard::GetFWVersion()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -263,8 +482,34 @@ uint16_t CTestboard::GetFWVersion()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::GetFWVersion_Async()
+{ RPC_PROFILING(8, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(8);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 8;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(8); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::GetSWVersion()
-{ RPC_PROFILING
+{ RPC_PROFILING(9, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(9);
@@ -272,7 +517,7 @@ uint16_t CTestboard::GetSWVersion()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -281,8 +526,34 @@ uint16_t CTestboard::GetSWVersion()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::GetSWVersion_Async()
+{ RPC_PROFILING(9, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(9);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 9;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(9); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::UpgradeGetVersion()
-{ RPC_PROFILING
+{ RPC_PROFILING(10, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(10);
@@ -290,7 +561,7 @@ uint16_t CTestboard::UpgradeGetVersion()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -299,8 +570,34 @@ uint16_t CTestboard::UpgradeGetVersion()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::UpgradeGetVersion_Async()
+{ RPC_PROFILING(10, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(10);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 10;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(10); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint8_t CTestboard::UpgradeStart(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(11, true)
 	uint8_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(11);
@@ -309,7 +606,7 @@ uint8_t CTestboard::UpgradeStart(uint16_t rpc_par1)
 	msg.Create(rpc_clientCallId);
 	msg.Put_UINT16(rpc_par1);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_UINT8();
@@ -318,8 +615,35 @@ uint8_t CTestboard::UpgradeStart(uint16_t rpc_par1)
 	return rpc_par0;
 }
 
+rpcFuture<uint8_t> CTestboard::UpgradeStart_Async(uint16_t rpc_par1)
+{ RPC_PROFILING(11, false)
+	struct rpc_Reply : public rpcReply<uint8_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_UINT8();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(11);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT16(rpc_par1);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 11;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(11); throw; };
+	return rpcFuture<uint8_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint8_t CTestboard::UpgradeData(string &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(12, true)
 	uint8_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(12);
@@ -328,7 +652,7 @@ uint8_t CTestboard::UpgradeData(string &rpc_par1)
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
 	rpc_Send(*rpc_io, rpc_par1);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_UINT8();
@@ -337,8 +661,35 @@ uint8_t CTestboard::UpgradeData(string &rpc_par1)
 	return rpc_par0;
 }
 
+rpcFuture<uint8_t> CTestboard::UpgradeData_Async(string &rpc_par1)
+{ RPC_PROFILING(12, false)
+	struct rpc_Reply : public rpcReply<uint8_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_UINT8();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(12);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_Send(*rpc_io, rpc_par1);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 12;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(12); throw; };
+	return rpcFuture<uint8_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint8_t CTestboard::UpgradeError()
-{ RPC_PROFILING
+{ RPC_PROFILING(13, true)
 	uint8_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(13);
@@ -346,7 +697,7 @@ uint8_t CTestboard::UpgradeError()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_UINT8();
@@ -355,15 +706,41 @@ uint8_t CTestboard::UpgradeError()
 	return rpc_par0;
 }
 
+rpcFuture<uint8_t> CTestboard::UpgradeError_Async()
+{ RPC_PROFILING(13, false)
+	struct rpc_Reply : public rpcReply<uint8_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_UINT8();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(13);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 13;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(13); throw; };
+	return rpcFuture<uint8_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::UpgradeErrorMsg(stringR &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(14, true)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(14);
 	RPC_THREAD_LOCK
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,0);
 	rpc_Receive(*rpc_io, rpc_par1);
@@ -371,8 +748,36 @@ void CTestboard::UpgradeErrorMsg(stringR &rpc_par1)
 	} catch (CRpcError &e) { e.SetFunction(14); throw; };
 }
 
+rpcPending CTestboard::UpgradeErrorMsg_Async(stringR &rpc_par1)
+{ RPC_PROFILING(14, false)
+	struct rpc_Reply : public rpcDeferred
+	{
+		stringR *rpc_par1;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,0);
+			rpc_Receive(rpc_io, *rpc_par1);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par1 = &rpc_par1;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(14);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 14;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(14); throw; };
+	return rpcPending(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::UpgradeExec(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(15, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(15);
 	RPC_THREAD_LOCK
@@ -385,7 +790,7 @@ void CTestboard::UpgradeExec(uint16_t rpc_par1)
 }
 
 void CTestboard::Init()
-{ RPC_PROFILING
+{ RPC_PROFILING(16, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(16);
 	RPC_THREAD_LOCK
@@ -397,7 +802,7 @@ void CTestboard::Init()
 }
 
 void CTestboard::Welcome()
-{ RPC_PROFILING
+{ RPC_PROFILING(17, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(17);
 	RPC_THREAD_LOCK
@@ -409,7 +814,7 @@ void CTestboard::Welcome()
 }
 
 void CTestboard::SetLed(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(18, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(18);
 	RPC_THREAD_LOCK
@@ -422,7 +827,7 @@ void CTestboard::SetLed(uint8_t rpc_par1)
 }
 
 void CTestboard::cDelay(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(19, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(19);
 	RPC_THREAD_LOCK
@@ -435,7 +840,7 @@ void CTestboard::cDelay(uint16_t rpc_par1)
 }
 
 void CTestboard::uDelay(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(20, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(20);
 	RPC_THREAD_LOCK
@@ -448,7 +853,7 @@ void CTestboard::uDelay(uint16_t rpc_par1)
 }
 
 void CTestboard::Sig_SetMode(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(21, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(21);
 	RPC_THREAD_LOCK
@@ -462,7 +867,7 @@ void CTestboard::Sig_SetMode(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::Sig_SetPRBS(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(22, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(22);
 	RPC_THREAD_LOCK
@@ -476,7 +881,7 @@ void CTestboard::Sig_SetPRBS(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::Sig_SetDelay(uint8_t rpc_par1, uint16_t rpc_par2, int8_t rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(23, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(23);
 	RPC_THREAD_LOCK
@@ -491,7 +896,7 @@ void CTestboard::Sig_SetDelay(uint8_t rpc_par1, uint16_t rpc_par2, int8_t rpc_pa
 }
 
 void CTestboard::Sig_SetLevel(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(24, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(24);
 	RPC_THREAD_LOCK
@@ -505,7 +910,7 @@ void CTestboard::Sig_SetLevel(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::Sig_SetOffset(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(25, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(25);
 	RPC_THREAD_LOCK
@@ -518,7 +923,7 @@ void CTestboard::Sig_SetOffset(uint8_t rpc_par1)
 }
 
 void CTestboard::Sig_SetLVDS()
-{ RPC_PROFILING
+{ RPC_PROFILING(26, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(26);
 	RPC_THREAD_LOCK
@@ -530,7 +935,7 @@ void CTestboard::Sig_SetLVDS()
 }
 
 void CTestboard::Sig_SetLCDS()
-{ RPC_PROFILING
+{ RPC_PROFILING(27, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(27);
 	RPC_THREAD_LOCK
@@ -542,7 +947,7 @@ void CTestboard::Sig_SetLCDS()
 }
 
 void CTestboard::SignalProbeD1(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(28, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(28);
 	RPC_THREAD_LOCK
@@ -555,7 +960,7 @@ void CTestboard::SignalProbeD1(uint8_t rpc_par1)
 }
 
 void CTestboard::SignalProbeD2(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(29, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(29);
 	RPC_THREAD_LOCK
@@ -568,7 +973,7 @@ void CTestboard::SignalProbeD2(uint8_t rpc_par1)
 }
 
 void CTestboard::SignalProbeA1(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(30, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(30);
 	RPC_THREAD_LOCK
@@ -581,7 +986,7 @@ void CTestboard::SignalProbeA1(uint8_t rpc_par1)
 }
 
 void CTestboard::SignalProbeA2(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(31, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(31);
 	RPC_THREAD_LOCK
@@ -594,7 +999,7 @@ void CTestboard::SignalProbeA2(uint8_t rpc_par1)
 }
 
 void CTestboard::SignalProbeADC(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(32, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(32);
 	RPC_THREAD_LOCK
@@ -608,7 +1013,7 @@ void CTestboard::SignalProbeADC(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::Pon()
-{ RPC_PROFILING
+{ RPC_PROFILING(33, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(33);
 	RPC_THREAD_LOCK
@@ -620,7 +1025,7 @@ void CTestboard::Pon()
 }
 
 void CTestboard::Poff()
-{ RPC_PROFILING
+{ RPC_PROFILING(34, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(34);
 	RPC_THREAD_LOCK
@@ -632,7 +1037,7 @@ void CTestboard::Poff()
 }
 
 void CTestboard::_SetVD(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(35, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(35);
 	RPC_THREAD_LOCK
@@ -645,7 +1050,7 @@ void CTestboard::_SetVD(uint16_t rpc_par1)
 }
 
 void CTestboard::_SetVA(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(36, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(36);
 	RPC_THREAD_LOCK
@@ -658,7 +1063,7 @@ void CTestboard::_SetVA(uint16_t rpc_par1)
 }
 
 void CTestboard::_SetID(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(37, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(37);
 	RPC_THREAD_LOCK
@@ -671,7 +1076,7 @@ void CTestboard::_SetID(uint16_t rpc_par1)
 }
 
 void CTestboard::_SetIA(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(38, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(38);
 	RPC_THREAD_LOCK
@@ -684,7 +1089,7 @@ void CTestboard::_SetIA(uint16_t rpc_par1)
 }
 
 uint16_t CTestboard::_GetVD()
-{ RPC_PROFILING
+{ RPC_PROFILING(39, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(39);
@@ -692,7 +1097,7 @@ uint16_t CTestboard::_GetVD()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -701,8 +1106,34 @@ uint16_t CTestboard::_GetVD()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::_GetVD_Async()
+{ RPC_PROFILING(39, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(39);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 39;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(39); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::_GetVA()
-{ RPC_PROFILING
+{ RPC_PROFILING(40, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(40);
@@ -710,7 +1141,7 @@ uint16_t CTestboard::_GetVA()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -719,8 +1150,34 @@ uint16_t CTestboard::_GetVA()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::_GetVA_Async()
+{ RPC_PROFILING(40, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(40);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 40;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(40); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::_GetID()
-{ RPC_PROFILING
+{ RPC_PROFILING(41, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(41);
@@ -728,7 +1185,7 @@ uint16_t CTestboard::_GetID()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -737,8 +1194,34 @@ uint16_t CTestboard::_GetID()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::_GetID_Async()
+{ RPC_PROFILING(41, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(41);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 41;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(41); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint16_t CTestboard::_GetIA()
-{ RPC_PROFILING
+{ RPC_PROFILING(42, true)
 	uint16_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(42);
@@ -746,7 +1229,7 @@ uint16_t CTestboard::_GetIA()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_UINT16();
@@ -755,8 +1238,34 @@ uint16_t CTestboard::_GetIA()
 	return rpc_par0;
 }
 
+rpcFuture<uint16_t> CTestboard::_GetIA_Async()
+{ RPC_PROFILING(42, false)
+	struct rpc_Reply : public rpcReply<uint16_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_UINT16();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(42);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 42;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(42); throw; };
+	return rpcFuture<uint16_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::HVon()
-{ RPC_PROFILING
+{ RPC_PROFILING(43, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(43);
 	RPC_THREAD_LOCK
@@ -768,7 +1277,7 @@ void CTestboard::HVon()
 }
 
 void CTestboard::HVoff()
-{ RPC_PROFILING
+{ RPC_PROFILING(44, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(44);
 	RPC_THREAD_LOCK
@@ -780,7 +1289,7 @@ void CTestboard::HVoff()
 }
 
 void CTestboard::ResetOn()
-{ RPC_PROFILING
+{ RPC_PROFILING(45, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(45);
 	RPC_THREAD_LOCK
@@ -792,7 +1301,7 @@ void CTestboard::ResetOn()
 }
 
 void CTestboard::ResetOff()
-{ RPC_PROFILING
+{ RPC_PROFILING(46, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(46);
 	RPC_THREAD_LOCK
@@ -804,7 +1313,7 @@ void CTestboard::ResetOff()
 }
 
 uint8_t CTestboard::GetStatus()
-{ RPC_PROFILING
+{ RPC_PROFILING(47, true)
 	uint8_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(47);
@@ -812,7 +1321,7 @@ uint8_t CTestboard::GetStatus()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_UINT8();
@@ -821,8 +1330,34 @@ uint8_t CTestboard::GetStatus()
 	return rpc_par0;
 }
 
+rpcFuture<uint8_t> CTestboard::GetStatus_Async()
+{ RPC_PROFILING(47, false)
+	struct rpc_Reply : public rpcReply<uint8_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_UINT8();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(47);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 47;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(47); throw; };
+	return rpcFuture<uint8_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::SetRocAddress(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(48, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(48);
 	RPC_THREAD_LOCK
@@ -835,7 +1370,7 @@ void CTestboard::SetRocAddress(uint8_t rpc_par1)
 }
 
 void CTestboard::Pg_SetCmd(uint16_t rpc_par1, uint16_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(49, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(49);
 	RPC_THREAD_LOCK
@@ -849,7 +1384,7 @@ void CTestboard::Pg_SetCmd(uint16_t rpc_par1, uint16_t rpc_par2)
 }
 
 void CTestboard::Pg_Stop()
-{ RPC_PROFILING
+{ RPC_PROFILING(50, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(50);
 	RPC_THREAD_LOCK
@@ -861,7 +1396,7 @@ void CTestboard::Pg_Stop()
 }
 
 void CTestboard::Pg_Single()
-{ RPC_PROFILING
+{ RPC_PROFILING(51, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(51);
 	RPC_THREAD_LOCK
@@ -873,7 +1408,7 @@ void CTestboard::Pg_Single()
 }
 
 void CTestboard::Pg_Trigger()
-{ RPC_PROFILING
+{ RPC_PROFILING(52, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(52);
 	RPC_THREAD_LOCK
@@ -885,7 +1420,7 @@ void CTestboard::Pg_Trigger()
 }
 
 void CTestboard::Pg_Loop(uint16_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(53, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(53);
 	RPC_THREAD_LOCK
@@ -898,7 +1433,7 @@ void CTestboard::Pg_Loop(uint16_t rpc_par1)
 }
 
 uint32_t CTestboard::Daq_Open(uint32_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(54, true)
 	uint32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(54);
@@ -907,7 +1442,7 @@ uint32_t CTestboard::Daq_Open(uint32_t rpc_par1)
 	msg.Create(rpc_clientCallId);
 	msg.Put_UINT32(rpc_par1);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_UINT32();
@@ -916,8 +1451,35 @@ uint32_t CTestboard::Daq_Open(uint32_t rpc_par1)
 	return rpc_par0;
 }
 
+rpcFuture<uint32_t> CTestboard::Daq_Open_Async(uint32_t rpc_par1)
+{ RPC_PROFILING(54, false)
+	struct rpc_Reply : public rpcReply<uint32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_UINT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(54);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT32(rpc_par1);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 54;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(54); throw; };
+	return rpcFuture<uint32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::Daq_Close()
-{ RPC_PROFILING
+{ RPC_PROFILING(55, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(55);
 	RPC_THREAD_LOCK
@@ -929,7 +1491,7 @@ void CTestboard::Daq_Close()
 }
 
 void CTestboard::Daq_Start()
-{ RPC_PROFILING
+{ RPC_PROFILING(56, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(56);
 	RPC_THREAD_LOCK
@@ -941,7 +1503,7 @@ void CTestboard::Daq_Start()
 }
 
 void CTestboard::Daq_Stop()
-{ RPC_PROFILING
+{ RPC_PROFILING(57, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(57);
 	RPC_THREAD_LOCK
@@ -953,7 +1515,7 @@ void CTestboard::Daq_Stop()
 }
 
 uint32_t CTestboard::Daq_GetSize()
-{ RPC_PROFILING
+{ RPC_PROFILING(58, true)
 	uint32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(58);
@@ -961,7 +1523,7 @@ uint32_t CTestboard::Daq_GetSize()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_UINT32();
@@ -970,8 +1532,34 @@ uint32_t CTestboard::Daq_GetSize()
 	return rpc_par0;
 }
 
+rpcFuture<uint32_t> CTestboard::Daq_GetSize_Async()
+{ RPC_PROFILING(58, false)
+	struct rpc_Reply : public rpcReply<uint32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_UINT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(58);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 58;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(58); throw; };
+	return rpcFuture<uint32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint8_t CTestboard::Daq_Read(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(59, true)
 	uint8_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(59);
@@ -980,7 +1568,7 @@ uint8_t CTestboard::Daq_Read(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2)
 	msg.Create(rpc_clientCallId);
 	msg.Put_UINT16(rpc_par2);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_UINT8();
@@ -990,8 +1578,38 @@ uint8_t CTestboard::Daq_Read(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2)
 	return rpc_par0;
 }
 
+rpcFuture<uint8_t> CTestboard::Daq_Read_Async(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2)
+{ RPC_PROFILING(59, false)
+	struct rpc_Reply : public rpcReply<uint8_t>
+	{
+		vectorR<uint16_t> *rpc_par1;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_UINT8();
+			rpc_Receive(rpc_io, *rpc_par1);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par1 = &rpc_par1;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(59);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT16(rpc_par2);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 59;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(59); throw; };
+	return rpcFuture<uint8_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 uint8_t CTestboard::Daq_Read(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2, uint32_t &rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(60, true)
 	uint8_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(60);
@@ -1001,7 +1619,7 @@ uint8_t CTestboard::Daq_Read(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2, uin
 	msg.Put_UINT16(rpc_par2);
 	msg.Put_UINT32(rpc_par3);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,5);
 	rpc_par0 = msg.Get_UINT8();
@@ -1012,8 +1630,42 @@ uint8_t CTestboard::Daq_Read(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2, uin
 	return rpc_par0;
 }
 
+rpcFuture<uint8_t> CTestboard::Daq_Read_Async(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2, uint32_t &rpc_par3)
+{ RPC_PROFILING(60, false)
+	struct rpc_Reply : public rpcReply<uint8_t>
+	{
+		vectorR<uint16_t> *rpc_par1;
+		uint32_t *rpc_par3;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,5);
+			value = msg.Get_UINT8();
+			*rpc_par3 = msg.Get_UINT32();
+			rpc_Receive(rpc_io, *rpc_par1);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par1 = &rpc_par1;
+	rpc_reply->rpc_par3 = &rpc_par3;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(60);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT16(rpc_par2);
+	msg.Put_UINT32(rpc_par3);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 60;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(60); throw; };
+	return rpcFuture<uint8_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::Daq_Select_ADC(uint16_t rpc_par1, uint8_t rpc_par2, uint8_t rpc_par3, uint8_t rpc_par4)
-{ RPC_PROFILING
+{ RPC_PROFILING(61, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(61);
 	RPC_THREAD_LOCK
@@ -1029,7 +1681,7 @@ void CTestboard::Daq_Select_ADC(uint16_t rpc_par1, uint8_t rpc_par2, uint8_t rpc
 }
 
 void CTestboard::Daq_Select_Deser160(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(62, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(62);
 	RPC_THREAD_LOCK
@@ -1042,7 +1694,7 @@ void CTestboard::Daq_Select_Deser160(uint8_t rpc_par1)
 }
 
 void CTestboard::roc_I2cAddr(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(63, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(63);
 	RPC_THREAD_LOCK
@@ -1055,7 +1707,7 @@ void CTestboard::roc_I2cAddr(uint8_t rpc_par1)
 }
 
 void CTestboard::roc_ClrCal()
-{ RPC_PROFILING
+{ RPC_PROFILING(64, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(64);
 	RPC_THREAD_LOCK
@@ -1067,7 +1719,7 @@ void CTestboard::roc_ClrCal()
 }
 
 void CTestboard::roc_SetDAC(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(65, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(65);
 	RPC_THREAD_LOCK
@@ -1081,7 +1733,7 @@ void CTestboard::roc_SetDAC(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::roc_Pix(uint8_t rpc_par1, uint8_t rpc_par2, uint8_t rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(66, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(66);
 	RPC_THREAD_LOCK
@@ -1096,7 +1748,7 @@ void CTestboard::roc_Pix(uint8_t rpc_par1, uint8_t rpc_par2, uint8_t rpc_par3)
 }
 
 void CTestboard::roc_Pix_Trim(uint8_t rpc_par1, uint8_t rpc_par2, uint8_t rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(67, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(67);
 	RPC_THREAD_LOCK
@@ -1111,7 +1763,7 @@ void CTestboard::roc_Pix_Trim(uint8_t rpc_par1, uint8_t rpc_par2, uint8_t rpc_pa
 }
 
 void CTestboard::roc_Pix_Mask(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(68, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(68);
 	RPC_THREAD_LOCK
@@ -1125,7 +1777,7 @@ void CTestboard::roc_Pix_Mask(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::roc_Pix_Cal(uint8_t rpc_par1, uint8_t rpc_par2, bool rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(69, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(69);
 	RPC_THREAD_LOCK
@@ -1140,7 +1792,7 @@ void CTestboard::roc_Pix_Cal(uint8_t rpc_par1, uint8_t rpc_par2, bool rpc_par3)
 }
 
 void CTestboard::roc_Col_Enable(uint8_t rpc_par1, bool rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(70, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(70);
 	RPC_THREAD_LOCK
@@ -1154,7 +1806,7 @@ void CTestboard::roc_Col_Enable(uint8_t rpc_par1, bool rpc_par2)
 }
 
 void CTestboard::roc_Col_Mask(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(71, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(71);
 	RPC_THREAD_LOCK
@@ -1167,7 +1819,7 @@ void CTestboard::roc_Col_Mask(uint8_t rpc_par1)
 }
 
 void CTestboard::roc_Chip_Mask()
-{ RPC_PROFILING
+{ RPC_PROFILING(72, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(72);
 	RPC_THREAD_LOCK
@@ -1179,7 +1831,7 @@ void CTestboard::roc_Chip_Mask()
 }
 
 bool CTestboard::TBM_Present()
-{ RPC_PROFILING
+{ RPC_PROFILING(73, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(73);
@@ -1187,7 +1839,7 @@ bool CTestboard::TBM_Present()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_BOOL();
@@ -1196,8 +1848,34 @@ bool CTestboard::TBM_Present()
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::TBM_Present_Async()
+{ RPC_PROFILING(73, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_BOOL();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(73);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 73;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(73); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::tbm_Enable(bool rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(74, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(74);
 	RPC_THREAD_LOCK
@@ -1210,7 +1888,7 @@ void CTestboard::tbm_Enable(bool rpc_par1)
 }
 
 void CTestboard::tbm_Addr(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(75, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(75);
 	RPC_THREAD_LOCK
@@ -1224,7 +1902,7 @@ void CTestboard::tbm_Addr(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 void CTestboard::mod_Addr(uint8_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(76, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(76);
 	RPC_THREAD_LOCK
@@ -1237,7 +1915,7 @@ void CTestboard::mod_Addr(uint8_t rpc_par1)
 }
 
 void CTestboard::tbm_Set(uint8_t rpc_par1, uint8_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(77, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(77);
 	RPC_THREAD_LOCK
@@ -1251,7 +1929,7 @@ void CTestboard::tbm_Set(uint8_t rpc_par1, uint8_t rpc_par2)
 }
 
 bool CTestboard::tbm_Get(uint8_t rpc_par1, uint8_t &rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(78, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(78);
@@ -1261,7 +1939,7 @@ bool CTestboard::tbm_Get(uint8_t rpc_par1, uint8_t &rpc_par2)
 	msg.Put_UINT8(rpc_par1);
 	msg.Put_UINT8(rpc_par2);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,2);
 	rpc_par0 = msg.Get_BOOL();
@@ -1271,8 +1949,39 @@ bool CTestboard::tbm_Get(uint8_t rpc_par1, uint8_t &rpc_par2)
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::tbm_Get_Async(uint8_t rpc_par1, uint8_t &rpc_par2)
+{ RPC_PROFILING(78, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		uint8_t *rpc_par2;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,2);
+			value = msg.Get_BOOL();
+			*rpc_par2 = msg.Get_UINT8();
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par2 = &rpc_par2;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(78);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT8(rpc_par1);
+	msg.Put_UINT8(rpc_par2);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 78;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(78); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 bool CTestboard::tbm_GetRaw(uint8_t rpc_par1, uint32_t &rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(79, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(79);
@@ -1282,7 +1991,7 @@ bool CTestboard::tbm_GetRaw(uint8_t rpc_par1, uint32_t &rpc_par2)
 	msg.Put_UINT8(rpc_par1);
 	msg.Put_UINT32(rpc_par2);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,5);
 	rpc_par0 = msg.Get_BOOL();
@@ -1292,8 +2001,39 @@ bool CTestboard::tbm_GetRaw(uint8_t rpc_par1, uint32_t &rpc_par2)
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::tbm_GetRaw_Async(uint8_t rpc_par1, uint32_t &rpc_par2)
+{ RPC_PROFILING(79, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		uint32_t *rpc_par2;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,5);
+			value = msg.Get_BOOL();
+			*rpc_par2 = msg.Get_UINT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par2 = &rpc_par2;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(79);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT8(rpc_par1);
+	msg.Put_UINT32(rpc_par2);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 79;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(79); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 bool CTestboard::GetPixelAddressInverted()
-{ RPC_PROFILING
+{ RPC_PROFILING(80, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(80);
@@ -1301,7 +2041,7 @@ bool CTestboard::GetPixelAddressInverted()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_BOOL();
@@ -1310,8 +2050,34 @@ bool CTestboard::GetPixelAddressInverted()
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::GetPixelAddressInverted_Async()
+{ RPC_PROFILING(80, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_BOOL();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(80);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 80;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(80); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::SetPixelAddressInverted(bool rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(81, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(81);
 	RPC_THREAD_LOCK
@@ -1324,7 +2090,7 @@ void CTestboard::SetPixelAddressInverted(bool rpc_par1)
 }
 
 int32_t CTestboard::CountReadouts(int32_t rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(82, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(82);
@@ -1333,7 +2099,7 @@ int32_t CTestboard::CountReadouts(int32_t rpc_par1)
 	msg.Create(rpc_clientCallId);
 	msg.Put_INT32(rpc_par1);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -1342,8 +2108,35 @@ int32_t CTestboard::CountReadouts(int32_t rpc_par1)
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::CountReadouts_Async(int32_t rpc_par1)
+{ RPC_PROFILING(82, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(82);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 82;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(82); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 int32_t CTestboard::CountReadouts(int32_t rpc_par1, int32_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(83, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(83);
@@ -1353,7 +2146,7 @@ int32_t CTestboard::CountReadouts(int32_t rpc_par1, int32_t rpc_par2)
 	msg.Put_INT32(rpc_par1);
 	msg.Put_INT32(rpc_par2);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -1362,8 +2155,36 @@ int32_t CTestboard::CountReadouts(int32_t rpc_par1, int32_t rpc_par2)
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::CountReadouts_Async(int32_t rpc_par1, int32_t rpc_par2)
+{ RPC_PROFILING(83, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(83);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Put_INT32(rpc_par2);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 83;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(83); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 int32_t CTestboard::CountReadouts(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(84, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(84);
@@ -1374,7 +2195,7 @@ int32_t CTestboard::CountReadouts(int32_t rpc_par1, int32_t rpc_par2, int32_t rp
 	msg.Put_INT32(rpc_par2);
 	msg.Put_INT32(rpc_par3);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -1383,8 +2204,37 @@ int32_t CTestboard::CountReadouts(int32_t rpc_par1, int32_t rpc_par2, int32_t rp
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::CountReadouts_Async(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3)
+{ RPC_PROFILING(84, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(84);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Put_INT32(rpc_par2);
+	msg.Put_INT32(rpc_par3);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 84;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(84); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 int32_t CTestboard::PH(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int16_t rpc_par4)
-{ RPC_PROFILING
+{ RPC_PROFILING(85, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(85);
@@ -1396,7 +2246,7 @@ int32_t CTestboard::PH(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int
 	msg.Put_INT32(rpc_par3);
 	msg.Put_INT16(rpc_par4);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -1405,8 +2255,38 @@ int32_t CTestboard::PH(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::PH_Async(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int16_t rpc_par4)
+{ RPC_PROFILING(85, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(85);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Put_INT32(rpc_par2);
+	msg.Put_INT32(rpc_par3);
+	msg.Put_INT16(rpc_par4);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 85;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(85); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 int32_t CTestboard::PixelThreshold(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int32_t rpc_par4, int32_t rpc_par5, int32_t rpc_par6, int32_t rpc_par7, int32_t rpc_par8, int32_t rpc_par9, int32_t rpc_par10)
-{ RPC_PROFILING
+{ RPC_PROFILING(86, true)
 	int32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(86);
@@ -1424,7 +2304,7 @@ int32_t CTestboard::PixelThreshold(int32_t rpc_par1, int32_t rpc_par2, int32_t r
 	msg.Put_INT32(rpc_par9);
 	msg.Put_INT32(rpc_par10);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_INT32();
@@ -1433,8 +2313,44 @@ int32_t CTestboard::PixelThreshold(int32_t rpc_par1, int32_t rpc_par2, int32_t r
 	return rpc_par0;
 }
 
+rpcFuture<int32_t> CTestboard::PixelThreshold_Async(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int32_t rpc_par4, int32_t rpc_par5, int32_t rpc_par6, int32_t rpc_par7, int32_t rpc_par8, int32_t rpc_par9, int32_t rpc_par10)
+{ RPC_PROFILING(86, false)
+	struct rpc_Reply : public rpcReply<int32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_INT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(86);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Put_INT32(rpc_par2);
+	msg.Put_INT32(rpc_par3);
+	msg.Put_INT32(rpc_par4);
+	msg.Put_INT32(rpc_par5);
+	msg.Put_INT32(rpc_par6);
+	msg.Put_INT32(rpc_par7);
+	msg.Put_INT32(rpc_par8);
+	msg.Put_INT32(rpc_par9);
+	msg.Put_INT32(rpc_par10);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 86;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(86); throw; };
+	return rpcFuture<int32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 bool CTestboard::test_pixel_address(int32_t rpc_par1, int32_t rpc_par2)
-{ RPC_PROFILING
+{ RPC_PROFILING(87, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(87);
@@ -1444,7 +2360,7 @@ bool CTestboard::test_pixel_address(int32_t rpc_par1, int32_t rpc_par2)
 	msg.Put_INT32(rpc_par1);
 	msg.Put_INT32(rpc_par2);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_BOOL();
@@ -1453,8 +2369,36 @@ bool CTestboard::test_pixel_address(int32_t rpc_par1, int32_t rpc_par2)
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::test_pixel_address_Async(int32_t rpc_par1, int32_t rpc_par2)
+{ RPC_PROFILING(87, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_BOOL();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(87);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_INT32(rpc_par1);
+	msg.Put_INT32(rpc_par2);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 87;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(87); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 bool CTestboard::testColPixel(uint8_t rpc_par1, uint8_t rpc_par2, vectorR<uint8_t> &rpc_par3)
-{ RPC_PROFILING
+{ RPC_PROFILING(88, true)
 	bool rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(88);
@@ -1464,7 +2408,7 @@ bool CTestboard::testColPixel(uint8_t rpc_par1, uint8_t rpc_par2, vectorR<uint8_
 	msg.Put_UINT8(rpc_par1);
 	msg.Put_UINT8(rpc_par2);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,1);
 	rpc_par0 = msg.Get_BOOL();
@@ -1474,8 +2418,39 @@ bool CTestboard::testColPixel(uint8_t rpc_par1, uint8_t rpc_par2, vectorR<uint8_
 	return rpc_par0;
 }
 
+rpcFuture<bool> CTestboard::testColPixel_Async(uint8_t rpc_par1, uint8_t rpc_par2, vectorR<uint8_t> &rpc_par3)
+{ RPC_PROFILING(88, false)
+	struct rpc_Reply : public rpcReply<bool>
+	{
+		vectorR<uint8_t> *rpc_par3;
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,1);
+			value = msg.Get_BOOL();
+			rpc_Receive(rpc_io, *rpc_par3);
+		}
+	} *rpc_reply = new rpc_Reply;
+	rpc_reply->rpc_par3 = &rpc_par3;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(88);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Put_UINT8(rpc_par1);
+	msg.Put_UINT8(rpc_par2);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 88;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(88); throw; };
+	return rpcFuture<bool>(rpc_reply, rpc_queue, *rpc_io);
+}
+
 void CTestboard::Ethernet_Send(string &rpc_par1)
-{ RPC_PROFILING
+{ RPC_PROFILING(89, false)
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(89);
 	RPC_THREAD_LOCK
@@ -1488,7 +2463,7 @@ void CTestboard::Ethernet_Send(string &rpc_par1)
 }
 
 uint32_t CTestboard::Ethernet_RecvPackets()
-{ RPC_PROFILING
+{ RPC_PROFILING(90, true)
 	uint32_t rpc_par0;
 	try {
 	uint16_t rpc_clientCallId = rpc_GetCallId(90);
@@ -1496,7 +2471,7 @@ uint32_t CTestboard::Ethernet_RecvPackets()
 	rpcMessage msg;
 	msg.Create(rpc_clientCallId);
 	msg.Send(*rpc_io);
-	rpc_io->Flush();
+	rpc_Sync();
 	msg.Receive(*rpc_io);
 	msg.Check(rpc_clientCallId,4);
 	rpc_par0 = msg.Get_UINT32();
@@ -1505,3 +2480,29 @@ uint32_t CTestboard::Ethernet_RecvPackets()
 	return rpc_par0;
 }
 
+rpcFuture<uint32_t> CTestboard::Ethernet_RecvPackets_Async()
+{ RPC_PROFILING(90, false)
+	struct rpc_Reply : public rpcReply<uint32_t>
+	{
+		void Receive(CRpcIo &rpc_io)
+		{
+			rpcMessage msg;
+			msg.Receive(rpc_io);
+			msg.Check(m_callId,4);
+			value = msg.Get_UINT32();
+		}
+	} *rpc_reply = new rpc_Reply;
+	try {
+	uint16_t rpc_clientCallId = rpc_GetCallId(90);
+	RPC_THREAD_LOCK
+	rpcMessage msg;
+	msg.Create(rpc_clientCallId);
+	msg.Send(*rpc_io);
+	rpc_reply->m_callId = rpc_clientCallId;
+	rpc_reply->m_functionId = 90;
+	rpc_queue.Push(rpc_reply);
+	RPC_THREAD_UNLOCK
+	} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(90); throw; };
+	return rpcFuture<uint32_t>(rpc_reply, rpc_queue, *rpc_io);
+}
+
@@ -0,0 +1,40 @@
+// Deferred RPC functions, included in the CTestboard class declaration
+// This is an auto generated file
+// *** DO NOT EDIT THIS FILE ***
+
+	rpcFuture<uint16_t> GetRpcVersion_Async();
+	rpcFuture<int32_t> GetRpcCallId_Async(string &rpc_par1);
+	rpcPending GetRpcTimestamp_Async(stringR &rpc_par1);
+	rpcFuture<int32_t> GetRpcCallCount_Async();
+	rpcFuture<bool> GetRpcCallName_Async(int32_t rpc_par1, stringR &rpc_par2);
+	rpcPending GetInfo_Async(stringR &rpc_par1);
+	rpcFuture<uint16_t> GetBoardId_Async();
+	rpcPending GetHWVersion_Async(stringR &rpc_par1);
+	rpcFuture<uint16_t> GetFWVersion_Async();
+	rpcFuture<uint16_t> GetSWVersion_Async();
+	rpcFuture<uint16_t> UpgradeGetVersion_Async();
+	rpcFuture<uint8_t> UpgradeStart_Async(uint16_t rpc_par1);
+	rpcFuture<uint8_t> UpgradeData_Async(string &rpc_par1);
+	rpcFuture<uint8_t> UpgradeError_Async();
+	rpcPending UpgradeErrorMsg_Async(stringR &rpc_par1);
+	rpcFuture<uint16_t> _GetVD_Async();
+	rpcFuture<uint16_t> _GetVA_Async();
+	rpcFuture<uint16_t> _GetID_Async();
+	rpcFuture<uint16_t> _GetIA_Async();
+	rpcFuture<uint8_t> GetStatus_Async();
+	rpcFuture<uint32_t> Daq_Open_Async(uint32_t rpc_par1);
+	rpcFuture<uint32_t> Daq_GetSize_Async();
+	rpcFuture<uint8_t> Daq_Read_Async(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2);
+	rpcFuture<uint8_t> Daq_Read_Async(vectorR<uint16_t> &rpc_par1, uint16_t rpc_par2, uint32_t &rpc_par3);
+	rpcFuture<bool> TBM_Present_Async();
+	rpcFuture<bool> tbm_Get_Async(uint8_t rpc_par1, uint8_t &rpc_par2);
+	rpcFuture<bool> tbm_GetRaw_Async(uint8_t rpc_par1, uint32_t &rpc_par2);
+	rpcFuture<bool> GetPixelAddressInverted_Async();
+	rpcFuture<int32_t> CountReadouts_Async(int32_t rpc_par1);
+	rpcFuture<int32_t> CountReadouts_Async(int32_t rpc_par1, int32_t rpc_par2);
+	rpcFuture<int32_t> CountReadouts_Async(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3);
+	rpcFuture<int32_t> PH_Async(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int16_t rpc_par4);
+	rpcFuture<int32_t> PixelThreshold_Async(int32_t rpc_par1, int32_t rpc_par2, int32_t rpc_par3, int32_t rpc_par4, int32_t rpc_par5, int32_t rpc_par6, int32_t rpc_par7, int32_t rpc_par8, int32_t rpc_par9, int32_t rpc_par10);
+	rpcFuture<bool> test_pixel_address_Async(int32_t rpc_par1, int32_t rpc_par2);
+	rpcFuture<bool> testColPixel_Async(uint8_t rpc_par1, uint8_t rpc_par2, vectorR<uint8_t> &rpc_par3);
+	rpcFuture<uint32_t> Ethernet_RecvPackets_Async();
@@ -13,6 +13,10 @@ class CRpcIo
 protected:
 	void Dump(const char *msg, const void *buffer, uint32_t size);
 public:
+	// bytes moved by the rpc layer (rpc.cpp), read by the profiler
+	uint64_t m_txBytes, m_rxBytes;
+
+	CRpcIo() : m_txBytes(0), m_rxBytes(0) {}
 	virtual ~CRpcIo() {}
 	virtual void Write(const void *buffer, uint32_t size) = 0;
 	virtual void Flush() = 0;
@@ -0,0 +1,141 @@
+// rpc_profiler.cpp
+
+#include "rpc_profiler.h"
+
+#include <string.h>
+#include <string>
+#include <algorithm>
+
+
+void rpcProfiler::Init(unsigned int cmdCount, const char *cmdName[])
+{
+	m_cmdCount = cmdCount;
+	m_cmdName = cmdName;
+	Reset();
+}
+
+
+void rpcProfiler::Enable(bool on)
+{
+	if (on == m_enabled) return;
+	if (on) m_runStart = Now();
+	else m_runTime += Now() - m_runStart;
+	m_enabled = on;
+}
+
+
+void rpcProfiler::Reset()
+{
+	Entry e;
+	memset(&e, 0, sizeof(e));
+	m_entry.assign(m_cmdCount, e);
+	m_deferredRx = 0;
+	m_runTime = 0;
+	m_runStart = Now();
+}
+
+
+void rpcProfiler::AddCall(uint16_t cmd, uint64_t txBytes, uint64_t rxBytes, bool wait, uint64_t t)
+{
+	if (cmd >= m_entry.size()) return;
+	Entry &e = m_entry[cmd];
+	e.calls++;
+	e.txBytes += txBytes;
+	e.rxBytes += rxBytes;
+	if (!wait) return;
+
+	e.waits++;
+	e.waitTime += t;
+	if (t > e.waitMax) e.waitMax = t;
+	unsigned int bin = 0;
+	for (uint64_t us = t/1000; us > 1 && bin < RPC_PROFILER_BINS-1; us >>= 1) bin++;
+	e.hist[bin]++;
+}
+
+
+void rpcProfiler::AddDeferredReply(int cmd, uint64_t rxBytes)
+{
+	m_deferredRx += rxBytes;
+	if (cmd < 0 || (unsigned int)cmd >= m_entry.size()) return;
+	m_entry[cmd].deferred++;
+	m_entry[cmd].rxBytes += rxBytes;
+}
+
+
+// upper edge in us of the bin holding the p-quantile of the round trips,
+// limited to the longest round trip seen
+unsigned int rpcProfiler::Percentile(const Entry &e, double p)
+{
+	unsigned int max = (unsigned int)((e.waitMax + 999)/1000);
+	uint64_t n = 0, limit = uint64_t(p*e.waits + 0.5);
+	if (limit < 1) limit = 1;
+	for (unsigned int bin = 0; bin < RPC_PROFILER_BINS-1; bin++)
+	{
+		n += e.hist[bin];
+		if (n >= limit) return std::min(2u << bin, max);
+	}
+	return max;
+}
+
+
+typedef std::pair<std::pair<uint64_t, uint64_t>, unsigned int> rpcProfileKey;
+
+static bool rpc_ProfileOrder(const rpcProfileKey &a, const rpcProfileKey &b)
+{
+	return a.first > b.first;
+}
+
+
+void rpcProfiler::Report(FILE *f)
+{
+	uint64_t runTime = m_runTime + (m_enabled ? Now() - m_runStart : 0);
+
+	// commands sorted by time spent waiting, then by number of calls
+	std::vector<rpcProfileKey> order;
+	uint64_t calls = 0, waits = 0, waitTime = 0, txBytes = 0, rxBytes = 0;
+	for (unsigned int i = 0; i < m_entry.size(); i++)
+	{
+		Entry &e = m_entry[i];
+		if (e.calls == 0 && e.deferred == 0) continue;
+		order.push_back(std::make_pair(std::make_pair(e.waitTime, e.calls + e.deferred), i));
+		calls += e.calls;
+		waits += e.waits;
+		waitTime += e.waitTime;
+		txBytes += e.txBytes;
+		rxBytes += e.rxBytes;
+	}
+	std::stable_sort(order.begin(), order.end(), rpc_ProfileOrder);
+
+	fprintf(f, "--- RPC profile -----------------------------------------------------------------------------------------\n");
+	fprintf(f, "%.3f s profiled, %llu calls, %llu round trips taking %.3f s (%.1f%%), %llu bytes sent, %llu bytes received\n",
+		runTime*1e-9, (unsigned long long)calls, (unsigned long long)waits, waitTime*1e-9,
+		runTime ? 100.0*waitTime/runTime : 0.0,
+		(unsigned long long)txBytes, (unsigned long long)rxBytes);
+	if (order.empty())
+	{
+		fprintf(f, "no calls recorded\n");
+		return;
+	}
+
+	fprintf(f, " id  %-28s %9s %8s %11s %11s %9s %9s %7s %7s %7s %7s %7s %6s\n",
+		"command", "calls", "deferred", "sent", "received", "waits", "wait ms",
+		"mean us", "p50 us", "p90 us", "p99 us", "max us", "share");
+	for (unsigned int k = 0; k < order.size(); k++)
+	{
+		unsigned int i = order[k].second;
+		Entry &e = m_entry[i];
+		std::string name(m_cmdName ? m_cmdName[i] : "?");
+		if (name.size() > 28) name = name.substr(0, 27) + "~";
+		fprintf(f, "%3u  %-28s %9llu %8llu %11llu %11llu %9llu",
+			i, name.c_str(), (unsigned long long)e.calls, (unsigned long long)e.deferred,
+			(unsigned long long)e.txBytes, (unsigned long long)e.rxBytes, (unsigned long long)e.waits);
+		if (e.waits)
+			fprintf(f, " %9.1f %7.0f %7u %7u %7u %7.0f %5.1f%%\n",
+				e.waitTime*1e-6, e.waitTime*1e-3/e.waits,
+				Percentile(e, 0.5), Percentile(e, 0.9), Percentile(e, 0.99),
+				e.waitMax*1e-3, runTime ? 100.0*e.waitTime/runTime : 0.0);
+		else
+			fprintf(f, "\n");
+	}
+	fprintf(f, "(percentiles are bin edges of a log2 histogram, share is wait time / profiled time)\n");
+}
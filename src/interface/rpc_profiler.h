@@ -0,0 +1,96 @@
+// rpc_profiler.h
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include <atomic>
+
+#include "rpc_io.h"
+
+
+// number of latency histogram bins, bin i counts round trips
+// of 2^i .. 2^(i+1) us, the last bin takes everything above
+#define RPC_PROFILER_BINS 24
+
+
+class rpcProfiler
+{
+public:
+	struct Entry
+	{
+		uint64_t calls;      // stub calls (blocking and _Async)
+		uint64_t deferred;   // replies collected from the deferred queue
+		uint64_t txBytes;
+		uint64_t rxBytes;
+		uint64_t waits;      // blocking calls that waited for a reply
+		uint64_t waitTime;   // ns spent in those calls
+		uint64_t waitMax;    // ns
+		uint32_t hist[RPC_PROFILER_BINS];
+	};
+
+private:
+	std::atomic<bool> m_enabled; // read by every thread making calls
+	unsigned int m_cmdCount;
+	const char **m_cmdName;
+	std::vector<Entry> m_entry;
+	uint64_t m_deferredRx; // reply bytes already booked by the deferred queue
+	uint64_t m_runTime;    // ns profiled before m_runStart
+	uint64_t m_runStart;
+
+	unsigned int Percentile(const Entry &e, double p);
+public:
+	static uint64_t Now()
+	{
+		timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return uint64_t(t.tv_sec)*1000000000 + t.tv_nsec;
+	}
+
+	rpcProfiler() : m_enabled(false), m_cmdCount(0), m_cmdName(0),
+		m_deferredRx(0), m_runTime(0), m_runStart(0) {}
+	void Init(unsigned int cmdCount, const char *cmdName[]);
+
+	void Enable(bool on);
+	bool IsEnabled() { return m_enabled; }
+	void Reset();
+	void Report(FILE *f = stdout);
+
+	uint64_t DeferredRx() { return m_deferredRx; }
+	void AddCall(uint16_t cmd, uint64_t txBytes, uint64_t rxBytes, bool wait, uint64_t t);
+	void AddDeferredReply(int cmd, uint64_t rxBytes);
+};
+
+
+// Placed at the top of each generated stub by RPC_PROFILING. Books the
+// traffic of the call when it leaves, and for calls that wait for a reply
+// also the time spent in the stub.
+class rpcProfileCall
+{
+	rpcProfiler &m_prof;
+	CRpcIo &m_io;
+	uint16_t m_cmd;
+	bool m_active;
+	bool m_wait;
+	uint64_t m_t0, m_tx0, m_rx0, m_deferredRx0;
+public:
+	rpcProfileCall(rpcProfiler &prof, CRpcIo &io, uint16_t cmd, bool wait)
+		: m_prof(prof), m_io(io), m_cmd(cmd), m_active(prof.IsEnabled()), m_wait(wait),
+		  m_t0(0), m_tx0(0), m_rx0(0), m_deferredRx0(0)
+	{
+		if (!m_active) return;
+		m_tx0 = m_io.m_txBytes;
+		m_rx0 = m_io.m_rxBytes;
+		m_deferredRx0 = m_prof.DeferredRx();
+		m_t0 = m_wait ? rpcProfiler::Now() : 0;
+	}
+	~rpcProfileCall()
+	{
+		if (!m_active) return;
+		uint64_t rx = (m_io.m_rxBytes - m_rx0) - (m_prof.DeferredRx() - m_deferredRx0);
+		m_prof.AddCall(m_cmd, m_io.m_txBytes - m_tx0, rx, m_wait,
+			m_wait ? rpcProfiler::Now() - m_t0 : 0);
+	}
+};
@@ -0,0 +1,313 @@
+// rpc_record.cpp
+
+#include "rpc_record.h"
+#include "rpc_profiler.h"
+
+#include <string.h>
+#include <unistd.h>
+
+
+static const char rpc_recordMagic[8] = { 'P','S','I','4','6','R','P','C' };
+
+
+static void rpc_PutLE(std::vector<uint8_t> &b, uint64_t x, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; i++) { b.push_back(uint8_t(x)); x >>= 8; }
+}
+
+
+static uint64_t rpc_GetLE(const uint8_t *p, unsigned int n)
+{
+	uint64_t x = 0;
+	for (unsigned int i = n; i > 0; i--) x = (x << 8) | p[i-1];
+	return x;
+}
+
+
+// === recorder =============================================================
+
+bool CRpcIoRecorder::Start(const char *fileName, CRpcIo &io, const char *linkName)
+{
+	Stop();
+	m_f = fopen(fileName, "wb");
+	if (!m_f)
+	{
+		m_error = std::string("could not create session file ") + fileName;
+		return false;
+	}
+	std::vector<uint8_t> h(rpc_recordMagic, rpc_recordMagic + 8);
+	uint32_t n = strlen(linkName);
+	rpc_PutLE(h, RPC_RECORD_VERSION, 4);
+	rpc_PutLE(h, n, 4);
+	h.insert(h.end(), linkName, linkName + n);
+	fwrite(&h[0], 1, h.size(), m_f);
+
+	m_io = &io;
+	m_start = rpcProfiler::Now();
+	m_type = 0;
+	m_error.clear();
+	return true;
+}
+
+
+void CRpcIoRecorder::Emit()
+{
+	if (!m_type) return;
+	std::vector<uint8_t> h;
+	h.push_back(m_type);
+	rpc_PutLE(h, m_time - m_start, 8);
+	rpc_PutLE(h, m_busy/1000, 4);
+	rpc_PutLE(h, m_data.size(), 4);
+	fwrite(&h[0], 1, h.size(), m_f);
+	if (!m_data.empty()) fwrite(&m_data[0], 1, m_data.size(), m_f);
+	m_type = 0;
+	m_data.clear();
+	m_busy = 0;
+}
+
+
+void CRpcIoRecorder::Put(uint8_t type, const void *data, uint32_t size, uint64_t t0, uint64_t t1)
+{
+	if (!m_f) return;
+	if (type != m_type || (type != RPC_RECORD_WRITE && type != RPC_RECORD_READ)) Emit();
+	m_type = type;
+	m_data.insert(m_data.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+	m_busy += t1 - t0;
+	m_time = t1;
+}
+
+
+void CRpcIoRecorder::Stop()
+{
+	if (!m_f) return;
+	Emit();
+	fclose(m_f);
+	m_f = 0;
+}
+
+
+void CRpcIoRecorder::Write(const void *buffer, uint32_t size)
+{
+	uint64_t t0 = rpcProfiler::Now();
+	m_io->Write(buffer, size);
+	Put(RPC_RECORD_WRITE, buffer, size, t0, rpcProfiler::Now());
+}
+
+
+void CRpcIoRecorder::Flush()
+{
+	uint64_t t0 = rpcProfiler::Now();
+	m_io->Flush();
+	Put(RPC_RECORD_FLUSH, 0, 0, t0, rpcProfiler::Now());
+}
+
+
+void CRpcIoRecorder::Clear()
+{
+	uint64_t t0 = rpcProfiler::Now();
+	m_io->Clear();
+	Put(RPC_RECORD_CLEAR, 0, 0, t0, rpcProfiler::Now());
+}
+
+
+void CRpcIoRecorder::Read(void *buffer, uint32_t size)
+{
+	uint64_t t0 = rpcProfiler::Now();
+	try
+	{
+		m_io->Read(buffer, size);
+	}
+	catch (CRpcError &e)
+	{
+		uint8_t id[4] = { uint8_t(e.error), 0, 0, 0 };
+		Put(RPC_RECORD_ERROR, id, 4, t0, rpcProfiler::Now());
+		throw;
+	}
+	Put(RPC_RECORD_READ, buffer, size, t0, rpcProfiler::Now());
+}
+
+
+void CRpcIoRecorder::Close()
+{
+	Stop();
+	if (m_io) m_io->Close();
+}
+
+
+// === replay ===============================================================
+
+bool CRpcIoReplay::Load(const char *fileName)
+{
+	FILE *f = fopen(fileName, "rb");
+	if (!f)
+	{
+		m_error = std::string("could not open session file ") + fileName;
+		return false;
+	}
+	std::vector<uint8_t> file;
+	uint8_t buffer[65536];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) file.insert(file.end(), buffer, buffer + n);
+	fclose(f);
+
+	const uint8_t *p = file.empty() ? 0 : &file[0], *end = p + file.size();
+	if (file.size() < 16 || memcmp(p, rpc_recordMagic, 8) != 0
+		|| rpc_GetLE(p + 8, 4) != RPC_RECORD_VERSION)
+	{
+		m_error = std::string(fileName) + " is not an RPC session file";
+		return false;
+	}
+	uint32_t nameSize = rpc_GetLE(p + 12, 4);
+	if (16 + uint64_t(nameSize) > file.size()) { m_error = "truncated session file"; return false; }
+	m_linkName.assign((const char*)p + 16, nameSize);
+
+	for (p += 16 + nameSize; p < end;)
+	{
+		if (end - p < 17) { m_error = "truncated session file"; return false; }
+		uint8_t type = p[0];
+		uint64_t t = rpc_GetLE(p + 1, 8);
+		uint32_t busy = rpc_GetLE(p + 9, 4);
+		uint32_t size = rpc_GetLE(p + 13, 4);
+		p += 17;
+		if (uint64_t(end - p) < size) { m_error = "truncated session file"; return false; }
+
+		Segment s = { m_read.size(), 0, busy, CRpcError::OK };
+		switch (type)
+		{
+			case RPC_RECORD_WRITE:
+				m_write.insert(m_write.end(), p, p + size);
+				break;
+			case RPC_RECORD_READ:
+				s.size = size;
+				m_read.insert(m_read.end(), p, p + size);
+				m_segment.push_back(s);
+				break;
+			case RPC_RECORD_ERROR:
+				s.error = size >= 4 ? int(rpc_GetLE(p, 4)) : CRpcError::READ_ERROR;
+				m_segment.push_back(s);
+				break;
+			case RPC_RECORD_FLUSH:
+				m_flushBusy.push_back(busy);
+				break;
+		}
+		m_duration = t;
+		p += size;
+	}
+	return true;
+}
+
+
+bool CRpcIoReplay::Open(const char *name)
+{
+	Close();
+	std::string fileName(name);
+	m_realtime = false;
+	size_t pos = fileName.rfind(",realtime");
+	if (pos != std::string::npos && pos + 9 == fileName.size())
+	{
+		fileName.erase(pos);
+		m_realtime = true;
+	}
+
+	m_write.clear();
+	m_read.clear();
+	m_segment.clear();
+	m_flushBusy.clear();
+	m_writePos = 0;
+	m_seg = m_segPos = m_flush = 0;
+	m_duration = 0;
+	m_overslept = 0;
+	m_error.clear();
+	if (!Load(fileName.c_str())) return false;
+	m_fileName = fileName;
+	m_open = true;
+	return true;
+}
+
+
+bool CRpcIoReplay::Show()
+{
+	printf("RPC session replay: %s\n", m_open ? m_fileName.c_str() : "closed");
+	if (!m_open) return true;
+	uint64_t readPos = m_seg < m_segment.size() ? m_segment[m_seg].pos + m_segPos : m_read.size();
+	printf("  recorded on %s, %.3f s%s\n", m_linkName.c_str(), m_duration*1e-9,
+		m_realtime ? ", replayed in real time" : "");
+	printf("  written %llu of %llu bytes, read %llu of %llu bytes\n",
+		(unsigned long long)m_writePos, (unsigned long long)m_write.size(),
+		(unsigned long long)readPos, (unsigned long long)m_read.size());
+	if (!m_error.empty()) printf("  %s\n", m_error.c_str());
+	return true;
+}
+
+
+void CRpcIoReplay::Write(const void *buffer, uint32_t size)
+{
+	if (!m_open) throw CRpcError(CRpcError::WRITE_ERROR);
+	if (size == 0) return;
+	const uint8_t *p = (const uint8_t*)buffer;
+	if (m_writePos + size > m_write.size() || memcmp(&m_write[m_writePos], p, size) != 0)
+	{
+		if (m_error.empty())
+		{
+			char s[128];
+			snprintf(s, sizeof(s), "host diverged from the recorded session at byte %llu",
+				(unsigned long long)m_writePos);
+			m_error = s;
+		}
+		throw CRpcError(CRpcError::WRITE_ERROR);
+	}
+	m_writePos += size;
+}
+
+
+// sleeps for the recorded link time, short delays are
+// far below the sleep resolution so the excess is carried over
+void CRpcIoReplay::Pace(uint32_t busy)
+{
+	uint64_t t = uint64_t(busy)*1000;
+	if (t <= m_overslept) { m_overslept -= t; return; }
+	t -= m_overslept;
+	uint64_t t0 = rpcProfiler::Now();
+	usleep(t/1000);
+	uint64_t slept = rpcProfiler::Now() - t0;
+	m_overslept = slept > t ? slept - t : 0;
+}
+
+
+void CRpcIoReplay::Flush()
+{
+	if (m_flush >= m_flushBusy.size()) return;
+	if (m_realtime) Pace(m_flushBusy[m_flush]);
+	m_flush++;
+}
+
+
+void CRpcIoReplay::Read(void *buffer, uint32_t size)
+{
+	if (!m_open) throw CRpcError(CRpcError::READ_ERROR);
+	uint8_t *p = (uint8_t*)buffer;
+	while (size)
+	{
+		if (m_seg >= m_segment.size()) throw CRpcError(CRpcError::READ_TIMEOUT);
+		Segment &s = m_segment[m_seg];
+		if (m_segPos == 0 && m_realtime) Pace(s.busy);
+		if (s.error != CRpcError::OK)
+		{
+			m_seg++;
+			throw CRpcError(CRpcError::errorId(s.error));
+		}
+		uint32_t n = s.size - m_segPos;
+		if (n > size) n = size;
+		memcpy(p, &m_read[s.pos + m_segPos], n);
+		p += n;
+		size -= n;
+		m_segPos += n;
+		if (m_segPos == s.size) { m_seg++; m_segPos = 0; }
+	}
+}
+
+
+void CRpcIoReplay::Close()
+{
+	m_open = false;
+}
@@ -0,0 +1,112 @@
+// rpc_record.h
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "rpc_io.h"
+
+
+// Session file: a header followed by one record per link event
+//
+//   header  "PSI46RPC", uint32 version, uint32 n, n bytes link name
+//   record  uint8 type, uint64 time, uint32 busy, uint32 size, size bytes data
+//
+// time is ns since the start of the session at the end of the event, busy
+// the us spent in the link for it. Consecutive writes and consecutive reads
+// are merged into one record. All numbers are little endian.
+
+#define RPC_RECORD_VERSION 1
+
+#define RPC_RECORD_WRITE 'W'  // bytes written by the host
+#define RPC_RECORD_READ  'R'  // bytes read by the host
+#define RPC_RECORD_ERROR 'E'  // failed read, data: uint32 CRpcError::errorId
+#define RPC_RECORD_FLUSH 'F'
+#define RPC_RECORD_CLEAR 'C'
+
+
+// Passes all calls to the link and logs them to a session file.
+class CRpcIoRecorder : public CRpcIo
+{
+	CRpcIo *m_io;
+	FILE *m_f;
+	std::string m_error;
+	uint64_t m_start;
+
+	uint8_t m_type;  // record being merged, 0: none
+	std::vector<uint8_t> m_data;
+	uint64_t m_busy;
+	uint64_t m_time;
+
+	void Put(uint8_t type, const void *data, uint32_t size, uint64_t t0, uint64_t t1);
+	void Emit();
+public:
+	CRpcIoRecorder() : m_io(0), m_f(0), m_start(0), m_type(0), m_busy(0), m_time(0) {}
+	~CRpcIoRecorder() { Stop(); }
+
+	bool Start(const char *fileName, CRpcIo &io, const char *linkName);
+	void Stop();
+	bool Recording() { return m_f != 0; }
+	const char* GetErrorMsg() { return m_error.c_str(); }
+
+	void Write(const void *buffer, uint32_t size);
+	void Flush();
+	void Clear();
+	void Read(void *buffer, uint32_t size);
+	void Close();
+};
+
+
+// Serves a recorded session without hardware. The host has to write the
+// same byte stream as during the recording, it gets the recorded replies.
+// With realtime set each recorded flush and read is delayed by the time it
+// took on the real link.
+class CRpcIoReplay : public CRpcIo
+{
+	struct Segment
+	{
+		uint64_t pos;   // in m_read
+		uint32_t size;
+		uint32_t busy;  // us
+		int error;      // CRpcError::errorId, OK for data
+	};
+
+	bool m_open;
+	bool m_realtime;
+	std::string m_error;
+	std::string m_fileName;
+	std::string m_linkName;
+
+	std::vector<uint8_t> m_write;
+	uint64_t m_writePos;
+	std::vector<uint8_t> m_read;
+	std::vector<Segment> m_segment;
+	unsigned int m_seg;
+	uint32_t m_segPos;
+	std::vector<uint32_t> m_flushBusy;  // us
+	unsigned int m_flush;
+	uint64_t m_duration;  // ns
+	uint64_t m_overslept; // ns, credited to the next delays
+
+	bool Load(const char *fileName);
+	void Pace(uint32_t busy);
+public:
+	CRpcIoReplay() : m_open(false), m_realtime(false), m_writePos(0),
+		m_seg(0), m_segPos(0), m_flush(0), m_duration(0), m_overslept(0) {}
+
+	// name: file name, optionally followed by ",realtime"
+	bool Open(const char *name);
+	bool Connected() { return m_open; }
+	const char* GetErrorMsg() { return m_error.c_str(); }
+	void SetRealtime(bool on) { m_realtime = on; }
+	bool Show();
+
+	void Write(const void *buffer, uint32_t size);
+	void Flush();
+	void Clear() {}
+	void Read(void *buffer, uint32_t size);
+	void Close();
+};
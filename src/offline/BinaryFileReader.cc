@@ -12,6 +12,8 @@ using namespace std;
 
 #include "BinaryFileReader.h"
 #include "PHCalibration.h"
+#include "interface/MtbFile.h"
+#include "interface/MtbIndex.h"
 
 
 BinaryFileReader::BinaryFileReader(const char* f,int nroc,int ref){
@@ -61,6 +63,8 @@ void BinaryFileReader::init(){
   fMaxEvent = 9999999;
   fHeader = fNextHeader = -1;
   fEOF = 0;
+  fInputBinaryFile = 0;
+  fIndex = 0;
   // init run statistics
   fnRecord            = 0;
   fnTrig              = 0;
@@ -321,6 +325,7 @@ void BinaryFileReader::init(){
 
 // ----------------------------------------------------------------------
 BinaryFileReader::~BinaryFileReader(){
+  delete fIndex;
   // delete the biggest chunks
   for(int i=0; i<fNROC; i++){
 	 delete hRocMap[i];
@@ -339,9 +344,23 @@ BinaryFileReader::~BinaryFileReader(){
 // ----------------------------------------------------------------------
 int BinaryFileReader::open() {
 
-  fInputBinaryFile = new ifstream(fInputFileName);
+  // plain raw files and compressed containers; the index belongs to the
+  // file read before
+  delete fInputBinaryFile;
+  delete fIndex;
+  fIndex = 0;
+  CMtbHeader header;
+  fInputBinaryFile = OpenMtbFile(fInputFileName, &header);
+
+  if (fInputBinaryFile && header.dataFormat != MTB_RECORDS) {
+    // streamed from the DTB DAQ, there are no records to read
+    cout << "--> ERROR: " << fInputFileName << " holds deser160 samples, not board memory records" << endl;
+    delete fInputBinaryFile;
+    fInputBinaryFile = 0;
+    return 1;
+  }
 
-  if (fInputBinaryFile->is_open()) {
+  if (fInputBinaryFile) {
 
     cout << "--> reading from file " << fInputFileName << endl;
 
@@ -368,6 +387,58 @@ int BinaryFileReader::open() {
 };
 
 
+// ----------------------------------------------------------------------
+int BinaryFileReader::openIndex() {
+
+  if (fIndex) return 0;
+  fIndex = new CMtbIndex();
+  if (!MtbIndexOpen(fInputFileName, *fIndex)) {
+    cout << "--> ERROR: no record index for " << fInputFileName << endl;
+    delete fIndex;
+    fIndex = 0;
+    return 1;
+  }
+  return 0;
+}
+
+
+// ----------------------------------------------------------------------
+long long BinaryFileReader::getRecordCount() {
+
+  if (openIndex()) return -1;
+  return fIndex->Size();
+}
+
+
+// ----------------------------------------------------------------------
+int BinaryFileReader::seekRecord(long long n) {
+  /* position the file behind the header word of record n (counted from
+     0, as in the index), so the next readRecord() returns it.
+     The trigger stack starts empty again.
+  */
+
+  if (!fInputBinaryFile || openIndex()) return 1;
+  if ((n < 0) || (n >= (long long)fIndex->Size())) return 1;
+
+  const MtbIndexEntry &e = (*fIndex)[n];
+  fInputBinaryFile->clear();
+  fInputBinaryFile->seekg(e.offset + 2);
+  if (fInputBinaryFile->fail()) return 1;
+  fNextHeader = e.header;
+  fEOF = 0;
+  trigger.clear();
+  return 0;
+}
+
+
+// ----------------------------------------------------------------------
+int BinaryFileReader::seekTime(long long t) {
+
+  if (openIndex()) return 1;
+  return seekRecord(fIndex->FindTime(t));
+}
+
+
 // ----------------------------------------------------------------------
 unsigned short BinaryFileReader::readBinaryWord() {
  
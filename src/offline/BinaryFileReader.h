@@ -14,6 +14,8 @@ using namespace std;
 
 
 #include "pixelForReadout.h"
+
+class CMtbIndex;
 class PHCalibration;
 class TH1F;
 class TH2F;
@@ -146,6 +148,10 @@ class BinaryFileReader {
   int  readRecord();              // read one record(=header+data) from file (Beat's format with TB header)
   int  readDataEvent();          // read next data event ( do not return triggers)
   int readGoodDataEvent();       // same but skip bad events
+  // random access through the record index (<file>.idx, made on first use)
+  long long getRecordCount();     // -1 without index
+  int  seekRecord(long long n);   // next readRecord() reads record n, 0 if ok
+  int  seekTime(long long t);     // same for the first record at or after time t
 
   unsigned short readBinaryWord();     // read two chars and swap order
   void  nextBinaryHeader();            // starting from present position, find next header
@@ -214,7 +220,9 @@ class BinaryFileReader {
   static const int MAX_PIXELS=1000;
   int        fBuffer[NUM_DATA];
   int        fData[NUM_DATA];
-  ifstream   *fInputBinaryFile;
+  istream    *fInputBinaryFile;
+  CMtbIndex  *fIndex;
+  int  openIndex();
   char       fInputFileName[1000];
   char       fTag[20];
   char       fLevelFileName[1000];
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#include "interface/MtbFile.h"
 using namespace std;
 
 
@@ -33,11 +34,22 @@ int main(int argc, char **argv)
 	 sprintf(fileName,"%s/mtb.bin",path);
   }
 
-  ifstream *in = new ifstream(fileName);
+  CMtbHeader header;
+  istream *in = OpenMtbFile(fileName, &header);
+  if(!in){
+	 cout << "unable to open " << fileName << endl;
+	 return 1;
+  }
+  // samples streamed from the DTB DAQ: no records, a readout per line
+  bool deser160 = header.dataFormat == MTB_DESER160;
+  if(deser160 && decode){
+	 cout << fileName << " holds deser160 samples, -d only decodes board memory records" << endl;
+	 return 1;
+  }
   int k=0;
 
   if(decode==0){
-	 while(in->is_open()&&!in->eof()){
+	 while(!in->eof()){
 		
 		unsigned char a = in->get();
 		if (in->eof()) break;
@@ -45,6 +57,17 @@ int main(int argc, char **argv)
 		if (in->eof()) break;
 		unsigned short word  =  (b << 8) | a;
 		
+		if(deser160){
+		  if( (word&0x8000) && (k>0) ) {
+			 cout << endl;
+			 k=0;
+		  }
+		  sprintf(buf,"%03x ",word & 0x0fff);
+		  cout << buf;
+		  k++;
+		  continue;
+		}
+
 		if( ((word&0x8000)>0)&&(k>3) ) {
 		  cout << endl;
 		  k=0;
@@ -93,7 +116,7 @@ int main(int argc, char **argv)
 	   }
 	 }
 
-	 while(in->is_open()&&!in->eof()){
+	 while(!in->eof()){
 
 		int k=0;
 		// header
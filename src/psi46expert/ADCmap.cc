@@ -199,23 +199,14 @@ void ADCmap::RocAction()
   cout << "[ADCmap] Mem_ReadOut for " << filledMem1 << " bytes" << endl;
 
   unsigned char dbuffer[MemSize];
-
-  unsigned int rest = filledMem1;
-  int jj = 0;
-
-  while( rest > 0 ) {
-
-    unsigned short BLOCKSIZE = 50000;
-    unsigned char cbuffer[BLOCKSIZE];
-    unsigned short readBytes = BLOCKSIZE;
-    if( rest < BLOCKSIZE ) readBytes = rest;
-
-    tbInterface->getCTestboard()->MemRead( dataBuffer_fpga1, readBytes, cbuffer );
-
-    for( int ii = 0; ii < readBytes; ++ii )
-      dbuffer[jj++] = cbuffer[ii];
-
-    rest -= readBytes;
+  if( filledMem1 > MemSize ) filledMem1 = MemSize;
+
+  // straight into dbuffer, block by block
+  const unsigned short BLOCKSIZE = 50000;
+  for( unsigned int done = 0; done < filledMem1; ) {
+    unsigned short readBytes = filledMem1 - done < BLOCKSIZE ? filledMem1 - done : BLOCKSIZE;
+    tbInterface->getCTestboard()->MemRead( dataBuffer_fpga1 + done, readBytes, dbuffer + done );
+    done += readBytes;
   }
 
   tbInterface->getCTestboard()->Daq_Done();
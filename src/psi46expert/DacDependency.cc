@@ -58,18 +58,17 @@ void DacDependency::PixelAction()
     //  }
     //  DisarmPixel();
 
-    int result[dacRange1 * dacRange2];
-    roc->DacDac(dac1, dacRange1, dac2, dacRange2, nTrig, result);
+    // result[i * dacRange2 + k] is the count at dac1 = i, dac2 = k
+    vector<int> result(dacRange1 * dacRange2);
+    roc->DacDac(dac1, dacRange1, dac2, dacRange2, nTrig, &result[0]);
 
     DisarmPixel();
 
-    int n = 0;
     for (int i = 0; i < dacRange1; i++)
     {
         for (int k = 0; k < dacRange2; k++)
         {
-            histo->SetBinContent(i + 1, k + 1, result[n]);
-            n++;
+            histo->SetBinContent(i + 1, k + 1, result[i * dacRange2 + k]);
         }
     }
 
@@ -66,6 +66,14 @@ void FullTest::ModuleAction()
 
     if (Scurve != 0)
     {
+        if (testParameters->PixelMapModule)
+        {   // all ROCs at once, RocAction skips it
+            gDelay->Timestamp();
+            test = new PixelAlive(testRange, testParameters, tbInterface);
+            test->ModuleAction(module);
+            TIter next(test->GetHistos());
+            while (TH1 * histo = (TH1 *)next()) histograms->Add(histo);
+        }
         Test::ModuleAction();
         DoTemperatureTest();
 
@@ -85,7 +93,7 @@ void FullTest::RocAction()
 
         histograms->Add(roc->DACHisto());
 
-        for (int iTest = 0; iTest < 6; iTest++)
+        for (int iTest = testParameters->PixelMapModule ? 1 : 0; iTest < 6; iTest++)
         {
             gDelay->Timestamp();
             if (iTest == 0) test = new PixelAlive(testRange, testParameters, tbInterface);
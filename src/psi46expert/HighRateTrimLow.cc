@@ -156,7 +156,7 @@ void HRTrimLow::PixelAction(void)
         for (int col = COLA; col < COLB; col += 1) {
             if (trim[col] > breakdown[col]) {
                 cout << "Setting trim bit of pixel " << col << ":" << row << " to " << trim[col] << endl;
-                tbInterface->RocPixTrim(col, row, trim[col]);
+                roc->PixTrim(col, row, trim[col]);
             }
             done = done && (trim[col] <= breakdown[col]);
         }
@@ -215,7 +215,7 @@ void HRTrimLow::PixelAction(void)
     for (int col = COLA; col < COLB; col += 1) {
         cout << "Found trim bit of pixel " << col << ":" << row << " : " << breakdown[col] + 1 << endl;
         histograms->Add(trim_scan[col]);
-        tbInterface->RocPixTrim(col, row, breakdown[col] + 1);
+        roc->PixTrim(col, row, breakdown[col] + 1);
         roc->SetTrim(col, row, breakdown[col] + 1);
     }
 }
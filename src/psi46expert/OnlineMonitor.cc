@@ -0,0 +1,156 @@
+#include <algorithm>
+
+#include "psi46expert/OnlineMonitor.h"
+#include "psi46expert/histogrammer.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------------
+OnlineMonitor::Counts::Counts()
+    : hits(nRocs * ROCNUMCOLS * ROCNUMROWS), ph(nRocs * nPH) {
+    clear();
+}
+
+
+// ----------------------------------------------------------------------
+void OnlineMonitor::Counts::clear() {
+    std::fill(hits.begin(), hits.end(), 0);
+    std::fill(ph.begin(), ph.end(), 0);
+    events = sampled = errors = 0;
+}
+
+
+// ----------------------------------------------------------------------
+OnlineMonitor::OnlineMonitor(double fraction, unsigned int publishInterval, int nBuffers)
+    : fFraction(fraction), fCredit(0), fPublishInterval(publishInterval),
+      fOffered(0), fDropped(0), fEvents(0), fSampled(0), fErrors(0), fStop(false) {
+    if (fFraction > 1.) fFraction = 1.;
+    fFree.resize(nBuffers > 0 ? nBuffers : 1);
+    fLastPublish = std::chrono::steady_clock::now();
+}
+
+
+// ----------------------------------------------------------------------
+OnlineMonitor::~OnlineMonitor() {
+    stop();
+}
+
+
+// ----------------------------------------------------------------------
+void OnlineMonitor::start() {
+    if (fThread.joinable()) return;
+    fStop = false;
+    fThread = std::thread(&OnlineMonitor::run, this);
+}
+
+
+// ----------------------------------------------------------------------
+void OnlineMonitor::stop() {
+    if (!fThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(fQueueMutex);
+        fStop = true;
+        fQueued.notify_all();
+    }
+    fThread.join();
+}
+
+
+// ----------------------------------------------------------------------
+// The queue mutex is only held for moving a buffer, never while decoding.
+bool OnlineMonitor::offer(const std::vector<uint16_t> & data, size_t n) {
+    if (n == 0 || fFraction <= 0.) return false;
+    ++fOffered;
+
+    std::vector<uint16_t> buffer;
+    {
+        std::lock_guard<std::mutex> lock(fQueueMutex);
+        if (fFree.empty() || !fThread.joinable()) {
+            ++fDropped;
+            return false;
+        }
+        buffer.swap(fFree.front());
+        fFree.pop_front();
+    }
+    buffer.assign(data.begin(), data.begin() + n);
+
+    std::lock_guard<std::mutex> lock(fQueueMutex);
+    fQueue.push_back(std::vector<uint16_t>());
+    fQueue.back().swap(buffer);
+    fQueued.notify_all();
+    return true;
+}
+
+
+// ----------------------------------------------------------------------
+void OnlineMonitor::run() {
+    std::vector<uint16_t> buffer;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(fQueueMutex);
+            if (buffer.capacity()) { // not the first round
+                fFree.push_back(std::vector<uint16_t>());
+                fFree.back().swap(buffer);
+            }
+            fQueued.wait(lock, [this] { return fStop || !fQueue.empty(); });
+            if (fQueue.empty()) break;
+            buffer.swap(fQueue.front());
+            fQueue.pop_front();
+        }
+        count(buffer);
+        buffer.clear();
+    }
+}
+
+
+// ----------------------------------------------------------------------
+// Decodes every 1/fFraction-th readout of the chunk. The last readout may
+// continue in the next chunk and is not sampled.
+void OnlineMonitor::count(const std::vector<uint16_t> & data) {
+    ScanReadouts(&data[0], data.size(), fIndex);
+    unsigned int nEvents = fIndex.Events();
+    if (nEvents > 0) --nEvents;
+
+    fSample.clear();
+    for (unsigned int e = 0; e < nEvents; e++) {
+        fCredit += fFraction;
+        if (fCredit < 1.) continue;
+        fCredit -= 1.;
+        const uint16_t * p = &data[fIndex.EventBegin(e)];
+        fSample.insert(fSample.end(), p, p + fIndex.EventSize(e, data.size()));
+    }
+
+    fHits.Clear();
+    if (!fSample.empty()) DecodeReadouts(fSample, fHits);
+
+    std::lock_guard<std::mutex> lock(fCountMutex);
+    fCounts.events += nEvents;
+    fCounts.sampled += fHits.Events();
+    for (unsigned int e = 0; e < fHits.Events(); e++)
+        if (fHits.eventFlags[e]) ++fCounts.errors;
+    for (unsigned int i = 0; i < fHits.Hits(); i++) {
+        int roc = fHits.roc[i], col = fHits.col[i], row = fHits.row[i];
+        if (fHits.flags[i] || roc >= nRocs || col >= ROCNUMCOLS || row >= ROCNUMROWS) continue;
+        ++fCounts.hits[(roc * ROCNUMCOLS + col) * ROCNUMROWS + row];
+        ++fCounts.ph[roc * nPH + (fHits.ph[i] < nPH ? fHits.ph[i] : nPH - 1)];
+    }
+}
+
+
+// ----------------------------------------------------------------------
+bool OnlineMonitor::publish(histogrammer * h, bool force) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!force && now - fLastPublish < fPublishInterval) return false;
+    fLastPublish = now;
+
+    {
+        std::lock_guard<std::mutex> lock(fCountMutex);
+        std::swap(fPublished, fCounts);
+        fCounts.clear();
+    }
+    h->fillHitHistograms(nRocs, &fPublished.hits[0], nPH, &fPublished.ph[0]);
+    fEvents += fPublished.events;
+    fSampled += fPublished.sampled;
+    fErrors += fPublished.errors;
+    return true;
+}
@@ -0,0 +1,92 @@
+// Live hit maps and pulse heights during a streamed run.
+//
+// The acquisition hands each chunk of DAQ samples to offer(), which only
+// copies it into a free buffer: with all buffers busy the chunk is left out
+// of the monitoring, the acquisition never waits for the monitor. A thread
+// decodes a fraction of the readouts of each chunk (DecodeReadouts, see
+// interface/analyzer.h) and counts the hits and pulse heights per ROC.
+// publish(), called from the GUI thread, adds the counts collected since its
+// last call to the histograms of the histogrammer, at most once per publish
+// interval, so ROOT is only used by the GUI thread.
+
+#ifndef ONLINEMONITOR_H
+#define ONLINEMONITOR_H
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "BasePixel/DecodedReadout.h"
+#include "BasePixel/GlobalConstants.h"
+#include "interface/ReadoutScanner.h"
+#include "interface/analyzer.h"
+
+class histogrammer;
+
+class OnlineMonitor {
+public:
+    OnlineMonitor(double fraction = 0.1, unsigned int publishInterval = 1000, int nBuffers = 4);
+    ~OnlineMonitor();
+
+    void start();
+    void stop();   // decodes what is queued, then ends the thread
+
+    // takes the first n samples of data, false if they are left out
+    bool offer(const std::vector<uint16_t> & data, size_t n);
+    // fills h with the counts since the last call, false (and nothing
+    // done) while the publish interval has not passed, unless forced
+    bool publish(histogrammer * h, bool force = false);
+
+    // chunks offered and left out, readouts seen, decoded and with
+    // decoding errors, up to the last publish
+    uint64_t getOffered() { return fOffered; }
+    uint64_t getDropped() { return fDropped; }
+    uint64_t getEvents() { return fEvents; }
+    uint64_t getSampled() { return fSampled; }
+    uint64_t getErrors() { return fErrors; }
+
+    static const int nRocs = DecodedReadoutConstants::NUM_ROCSMODULE;
+    static const int nPH = 256;
+
+    // counts since the last publish
+    struct Counts {
+        std::vector<uint32_t> hits;   // [roc][col][row]
+        std::vector<uint32_t> ph;     // [roc][pulse height]
+        uint64_t events, sampled, errors;
+        Counts();
+        void clear();
+    };
+
+private:
+    void run();
+    void count(const std::vector<uint16_t> & data);
+
+    double fFraction, fCredit;
+    std::chrono::milliseconds fPublishInterval;
+    std::chrono::steady_clock::time_point fLastPublish;
+    uint64_t fOffered, fDropped;
+    uint64_t fEvents, fSampled, fErrors;
+    Counts fPublished;
+
+    // chunks, guarded by fQueueMutex
+    std::deque< std::vector<uint16_t> > fQueue, fFree;
+    bool fStop;
+    std::mutex fQueueMutex;
+    std::condition_variable fQueued;
+    std::thread fThread;
+
+    // results, guarded by fCountMutex
+    Counts fCounts;
+    std::mutex fCountMutex;
+
+    // used by the thread only
+    ReadoutIndex fIndex;
+    std::vector<uint16_t> fSample;
+    PixelHitList fHits;
+};
+
+#endif
@@ -283,13 +283,18 @@ void PHCalibration::PulseHeightRocDigital(int data [])
 {
 
   tbInterface->Flush();
+  CTestboard * tb = tbInterface->getCTestboard();
 
+    // queue the requests of a whole column and collect the replies in one go
+    rpcFuture<int32_t> ph[80];
     for (int col = 0; col < 52; col++) {
         for (int row = 0; row < 80; row++) {
             int32_t trim = roc->GetPixel(col, row)->GetTrim();
-            data[80 * col + row] = tbInterface->PH(col, row, trim, nTrig);
+            ph[row] = tb->PH_Async(col, row, trim, nTrig);
         }
+        for (int row = 0; row < 80; row++) data[80 * col + row] = ph[row].Get();
     }
+    tbInterface->InvalidateShadow(); // PH programs the pixels behind its back
 
     return;
 }
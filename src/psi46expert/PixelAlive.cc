@@ -2,6 +2,7 @@
 
 #include "PixelAlive.h"
 #include "TestRoc.h"
+#include "TestModule.h"
 #include "BasePixel/GlobalConstants.h"
 #include "BasePixel/TBInterface.h"
 
@@ -19,6 +20,64 @@ void PixelAlive::ReadTestParameters(TestParameters * testParameters)
 {
     nTrig = (*testParameters).PixelMapReadouts;
     efficiency = (double)(*testParameters).PixelMapEfficiency / 100. ;
+    moduleMode = (*testParameters).PixelMapModule != 0;
+}
+
+
+// In module mode the efficiency of all ROCs in the test range is measured
+// in one scan, the same pixel is pulsed on each of them. The testboard
+// tells the ROCs apart by their position in the readout, so chip ids, trims
+// and results are arranged by readout position. The mask test still runs
+// ROC by ROC.
+void PixelAlive::ModuleAction()
+{
+    int nRocs = module->NRocs(), nTested = 0;
+    bool positionUsed[MODULENUMROCS] = { false }, positionsValid = true;
+    for (int i = 0; i < nRocs; i++)
+    {
+        int position = module->GetRoc(i)->GetAoutChipPosition();
+        if (position < 0 || position >= nRocs || positionUsed[position]) positionsValid = false;
+        else positionUsed[position] = true;
+        if (testRange->IncludesRoc(module->GetRoc(i)->GetChipId())) nTested++;
+    }
+    if (!moduleMode || nTested < 2 || !positionsValid)
+    {
+        Test::ModuleAction();
+        return;
+    }
+
+    psi::LogInfo() << "[PixelAlive] Measuring calibration efficiency for " << nTested << " Rocs at once ..." << psi::endl;
+
+    const int nPixels = ROC_NUMROWS * ROC_NUMCOLS;
+    TH2D * histo[MODULENUMROCS];
+    int chipIds[MODULENUMROCS];   // by readout position
+    int * trim = new int[nRocs * nPixels];
+    double * data = new double[nRocs * nPixels];
+
+    for (int i = 0; i < nRocs; i++) chipIds[i] = -1;
+    for (int i = 0; i < nRocs; i++)
+    {
+        SetRoc(module->GetRoc(i));
+        histo[i] = 0;
+        if (!testRange->IncludesRoc(chipId)) continue;
+        chipIds[aoutChipPosition] = chipId;
+        histo[i] = GetMap("PixelMap");
+        MaskMap(histo[i]);
+        roc->GetTrimValues(trim + aoutChipPosition * nPixels);
+    }
+
+    Flush();
+    tbInterface->ModuleEfficiency(nTrig, nRocs, chipIds, trim, data, 0);
+
+    for (int i = 0; i < nRocs; i++)
+    {
+        if (!histo[i]) continue;
+        SetRoc(module->GetRoc(i));
+        AliveMap(histo[i], data + aoutChipPosition * nPixels);
+    }
+
+    delete[] trim;
+    delete[] data;
 }
 
 
@@ -27,6 +86,17 @@ void PixelAlive::RocAction()
     psi::LogInfo() << "[PixelAlive] Measuring calibration efficiency for Roc " << chipId << " ..." << psi::endl;
 
     TH2D * histo = GetMap("PixelMap");
+    MaskMap(histo);
+
+    double data[ROC_NUMROWS * ROC_NUMCOLS];
+    roc->ChipEfficiency(nTrig, data);
+    AliveMap(histo, data);
+}
+
+
+// mask defects of the current ROC as -1
+void PixelAlive::MaskMap(TH2D * histo)
+{
     histo->SetMaximum(nTrig);
     histo->SetMinimum(0);
 
@@ -50,10 +120,12 @@ void PixelAlive::RocAction()
             else histo->SetBinContent(i + 1, k + 1, 0);
         }
     }
+}
 
-    double data[ROC_NUMROWS * ROC_NUMCOLS];
-    roc->ChipEfficiency(nTrig, data);
 
+// readouts per pixel of the current ROC, data is the efficiency
+void PixelAlive::AliveMap(TH2D * histo, double data[])
+{
     for (int i = 0; i < ROC_NUMROWS * ROC_NUMCOLS; i++)
     {
         double value = data[i] * nTrig;
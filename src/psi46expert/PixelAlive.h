@@ -12,12 +12,17 @@ public:
     PixelAlive(TestRange * testRange, TestParameters * testParameters, TBInterface * aTBInterface);
 
     virtual void ReadTestParameters(TestParameters * testParameters);
+    virtual void ModuleAction();
     virtual void RocAction();
 
 protected:
 
+    void MaskMap(TH2D * histo);
+    void AliveMap(TH2D * histo, double data[]);
+
     int nTrig;
     double efficiency;
+    bool moduleMode;
 
 };
 
@@ -114,19 +114,21 @@ void SCurveTest::DoubleColumnAction()
 
             for (int iRow = 0; iRow < ROCNUMROWS; iRow++)
             {
+                // chip ids, thresholds, trims and S-curves by readout position
                 for (int iRoc = 0; iRoc < nRocs; iRoc++)
                 {
-                    chipId[iRoc] = module->GetRoc(iRoc)->GetChipId();
-                    thr[iRow * nRocs + iRoc] = 80; //default value
-                    if (testRange->IncludesRoc(chipId[iRoc]))
+                    int k = module->GetRoc(iRoc)->GetAoutChipPosition();
+                    chipId[k] = module->GetRoc(iRoc)->GetChipId();
+                    thr[iRow * nRocs + k] = 80; //default value
+                    if (testRange->IncludesRoc(chipId[k]))
                     {
-                        thr[iRow * nRocs + iRoc] = static_cast<int>(map[iRoc]->GetBinContent(iCol + 1, iRow + 1));
-                        trims[iRow * nRocs + iRoc] = module->GetRoc(iRoc)->GetPixel(iCol, iRow)->GetTrim();
+                        thr[iRow * nRocs + k] = static_cast<int>(map[iRoc]->GetBinContent(iCol + 1, iRow + 1));
+                        trims[iRow * nRocs + k] = module->GetRoc(iRoc)->GetPixel(iCol, iRow)->GetTrim();
                     }
                 }
             }
 
-            tbInterface->SCurveColumn(iCol, nTrig, dacReg, thr, trims, chipId, sCurve);
+            tbInterface->SCurveColumn(iCol, nTrig, dacReg, nRocs, thr, trims, chipId, sCurve);
             //      for (int k = 0; k < 2*ROCNUMROWS*256; k++) printf("%i ", sCurve[k]);
 
             double x[255], y[255];
@@ -136,11 +138,12 @@ void SCurveTest::DoubleColumnAction()
             {
                 for (int iRoc = 0; iRoc < nRocs; iRoc++)
                 {
-                    if (testRange->IncludesPixel(chipId[iRoc], iCol, iRow))
+                    int k = module->GetRoc(iRoc)->GetAoutChipPosition();
+                    if (testRange->IncludesPixel(chipId[k], iCol, iRow))
                     {
                         n = 0;
-                        start = thr[iRow * nRocs + iRoc] - 16;
-                        stop = thr[iRow * nRocs + iRoc] + 16;
+                        start = thr[iRow * nRocs + k] - 16;
+                        stop = thr[iRow * nRocs + k] + 16;
                         if (start < 0) start = 0;
                         if (stop > 255) stop = 255;
 
@@ -148,14 +151,14 @@ void SCurveTest::DoubleColumnAction()
                         {
                             if (mode == 1) x[n] = gCalibrationTable->VcalDAC(0, vthr);
                             else x[n] = vthr;
-                            y[n] = sCurve[position + (vthr - start) * nRocs + iRoc];
+                            y[n] = sCurve[position + (vthr - start) * nRocs + k];
                             n++;
                         }
 
                         if ((*ConfigParameters::Singleton()).guiMode)
                         {
                             graph = new TGraph(n, x, y);
-                            graph->SetNameTitle(Form("SCurve_c%ir%i_C%d", iCol, iRow, chipId[iRoc]), Form("SCurve_c%ir%i_C%d", iCol, iRow, chipId[iRoc]));
+                            graph->SetNameTitle(Form("SCurve_c%ir%i_C%d", iCol, iRow, chipId[k]), Form("SCurve_c%ir%i_C%d", iCol, iRow, chipId[k]));
                             histograms->Add(graph);
                             graph->Write();
                         }
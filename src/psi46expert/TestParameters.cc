@@ -11,6 +11,7 @@
 TestParameters::TestParameters(const char * _file)
     :   PixelMapReadouts(20),
         PixelMapEfficiency(60),
+        PixelMapModule(1),
 
         SCurveMode(1),
         SCurveNTrig(0),
@@ -147,6 +148,7 @@ bool TestParameters::ReadTestParameterFile(const char * _file)
 
         if (0 == _name.compare("PixelMapReadouts")) { PixelMapReadouts   = static_cast<int>(_value); }
         else if (0 == _name.compare("PixelMapEfficiency")) { PixelMapEfficiency = static_cast<int>(_value); }
+        else if (0 == _name.compare("PixelMapModule")) { PixelMapModule = static_cast<int>(_value); }
 
         else if (0 == _name.compare("SCurveVcal")) { SCurveVcal      = static_cast<int>(_value); }
         else if (0 == _name.compare("SCurveVthr")) { SCurveVthr      = static_cast<int>(_value); }
@@ -12,6 +12,7 @@ public:
 
     int PixelMapReadouts;
     int PixelMapEfficiency;
+    int PixelMapModule;
 
     int SCurveMode;
     int SCurveNTrig;
@@ -7,6 +7,7 @@
 ThresholdMap::ThresholdMap()
 {
     doubleWbc = false;
+    parallel = true;
 }
 
 
@@ -90,7 +91,7 @@ void ThresholdMap::MeasureMap(const char * mapName, TestRoc * roc, TestRange * t
     if (reverseMode) sign = -1;
 
     int data[4160];
-    roc->ChipThreshold(100, sign, nTrig / 2, nTrig, dacReg, xtalk, cals, data);
+    MeasureThresholds(roc, sign, nTrig, data);
 
     for (int iCol = 0; iCol < ROCNUMCOLS ; iCol++)
     {
@@ -111,7 +112,7 @@ void ThresholdMap::MeasureMap(const char * mapName, TestRoc * roc, TestRange * t
         if (histo->GetMaximum() == 255)  // if there are pixels where no threshold could be found, test other wbc
         {
             int data2[4160];
-            roc->ChipThreshold(100, sign, nTrig / 2, nTrig, dacReg, xtalk, cals, data2);
+            MeasureThresholds(roc, sign, nTrig, data2);
 
             for (int iCol = 0; iCol < ROCNUMCOLS ; iCol++)
             {
@@ -131,6 +132,15 @@ void ThresholdMap::MeasureMap(const char * mapName, TestRoc * roc, TestRange * t
 }
 
 
+// parallel: one DAC sweep for many pixels at once, serial: a search on the
+// testboard pixel by pixel
+void ThresholdMap::MeasureThresholds(TestRoc * roc, int sign, int nTrig, int data[])
+{
+    if (parallel) roc->ChipThresholdParallel(100, sign, nTrig / 2, nTrig, dacReg, xtalk, cals, data);
+    else roc->ChipThreshold(100, sign, nTrig / 2, nTrig, dacReg, xtalk, cals, data);
+}
+
+
 void ThresholdMap::SetCals()
 {
     cals = true;
@@ -159,3 +169,15 @@ void ThresholdMap::SetReverseMode()
     reverseMode = true;
 }
 
+
+void ThresholdMap::SetParallel()
+{
+    parallel = true;
+}
+
+
+void ThresholdMap::SetSerial()
+{
+    parallel = false;
+}
+
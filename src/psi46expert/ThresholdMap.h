@@ -17,17 +17,20 @@ public:
     //  bool CheckMap();
     void MeasureMap(const char * mapName, TestRoc * roc, TestRange * testRange, int nTrig);
     void SetParameters(const char * mapName, int mode = -1);
+    void MeasureThresholds(TestRoc * roc, int sign, int nTrig, int data[]);
     void SetCals();
     void SetXTalk();
     void SetDoubleWbc();
     void SetSingleWbc();
     void SetReverseMode();
+    void SetParallel();
+    void SetSerial();
 
 protected:
 
     TH2D * histo;
     int dacReg;
-    bool cals, reverseMode, xtalk, doubleWbc;
+    bool cals, reverseMode, xtalk, doubleWbc, parallel;
 
 };
 
@@ -38,12 +38,7 @@ void ThrvsDACs::PixelAction()
        << ", row = " << row
        << endl;
 
-  int strt = 40;
-  int step = 1;
   int tdac = 25; // 25 = Vcal
-  int xtlk = 0;
-  int cals = 0;
-  int trim = pixel->GetTrim();
 
   // Set local trigger and channel:
 
@@ -66,6 +61,8 @@ void ThrvsDACs::PixelAction()
       }
     }
 
+    if( DacRegister == tdac ) continue; // the threshold DAC itself
+
     // Get the name of the DAC:
 
     DACParameters * parameters = new DACParameters();
@@ -103,17 +100,23 @@ void ThrvsDACs::PixelAction()
     histo->SetMinimum(0);
     histo->SetMaximum(256);
 
-    //ArmPixel(); // arm = enable + cal = settrim + cal
-    Cal();
+    ArmPixel(); // arm = enable + cal = settrim + cal
+
+    // one DacDac scan for the whole DAC range, count[idac*256 + vcal]:
+    // the threshold is the first Vcal with more than half of the 2*nTrig
+    // triggers seen, as in PixelThreshold
+
+    vector<int> count( scanMax * 256 );
+    roc->DacDac( DacRegister, scanMax, tdac, 256, 2*nTrig, &count[0] );
 
     for( int idac = 0; idac < scanMax; idac++ ) {
 
-      SetDAC( DacRegister, idac );
-      //Flush();
-      // PixelThreshold does enable = trim and flush
-      int thr = tbInterface->PixelThreshold( column, row, strt, step, nTrig, 2*nTrig,
-				    tdac, xtlk, cals, trim );
-      // PixelThreshold ends with disable = mask
+      int thr = 255;
+      for( int vcal = 0; vcal < 256; vcal++ )
+	if( count[idac*256 + vcal] > nTrig ) {
+	  thr = vcal;
+	  break;
+	}
 
       histo->Fill( idac, thr );
 
@@ -122,6 +125,7 @@ void ThrvsDACs::PixelAction()
     } // idac loop
 
     SetDAC( DacRegister, defaultValue );
+    roc->RocSetDAC( tdac, GetDAC(tdac) ); // DacDac leaves it at 255
 
     histograms->Add(histo);
 
@@ -9,6 +9,8 @@
 using namespace std;
 
 #include "psi46expert/UsbDaq.h"
+#include "interface/MtbFile.h"
+#include "interface/MtbIndex.h"
 
 const int LENGTH = 1048576;
 
@@ -19,6 +21,8 @@ UsbDaq::UsbDaq(int mode)
     fMaxEvent = 9999999;
     fHeader = fNextHeader = -1;
     fEOF = 0;
+    fInputBinaryFile = 0;
+    fIndex = 0;
 
     cout << " constructed USB DAQ module " << fRunMode << endl;
 }
@@ -26,6 +30,7 @@ UsbDaq::UsbDaq(int mode)
 UsbDaq::~UsbDaq()
 {
     cout << " delete USB DAQ module " << endl;
+    delete fIndex;
 }
 
 
@@ -42,10 +47,26 @@ int UsbDaq::clear()
 // ----------------------------------------------------------------------
 int UsbDaq::openBinaryFile()
 {
-    fInputBinaryFile = new ifstream(fInputFileName);
+    // plain raw files and containers written by daqFrame; the index
+    // belongs to the file read before
+    delete fInputBinaryFile;
+    delete fIndex;
+    fIndex = 0;
+    CMtbHeader header;
+    fInputBinaryFile = OpenMtbFile(fInputFileName, &header);
+    if (fInputBinaryFile && header.dataFormat != MTB_RECORDS)
+    {
+        // streamed from the DTB DAQ, there are no records to read
+        cout << "--> ERROR: " << getInputFileName() << " holds deser160 samples, not board memory records" << endl;
+        delete fInputBinaryFile;
+        fInputBinaryFile = 0;
+        return 1;
+    }
     if (fInputBinaryFile)
     {
         cout << "--> DAQ will be reading from file " << getInputFileName() << " at " << fInputBinaryFile << endl;
+        if (header.nRocs > 0)
+            cout << "--> run " << header.runNumber << ", " << header.nRocs << " ROCs, board " << header.boardId << endl;
         return 0;
     }
     else
@@ -87,6 +108,56 @@ unsigned short UsbDaq::readBinaryWordFromFile()
 }
 
 
+// ----------------------------------------------------------------------
+int UsbDaq::openIndex()
+{
+    if (fIndex) return 0;
+    fIndex = new CMtbIndex();
+    if (!MtbIndexOpen(fInputFileName, *fIndex))
+    {
+        cout << "--> ERROR: no record index for " << getInputFileName() << endl;
+        delete fIndex;
+        fIndex = 0;
+        return 1;
+    }
+    return 0;
+}
+
+
+// ----------------------------------------------------------------------
+long long UsbDaq::getRecordCount()
+{
+    if (fRunMode != 0 || openIndex()) return -1;
+    return fIndex->Size();
+}
+
+
+// ----------------------------------------------------------------------
+// Places the file behind the header word of record n, as if
+// nextBinaryHeader() had just found it.
+int UsbDaq::seekRecord(long long n)
+{
+    if (fRunMode != 0 || !fInputBinaryFile || openIndex()) return 1;
+    if (n < 0 || n >= (long long)fIndex->Size()) return 1;
+
+    const MtbIndexEntry & e = (*fIndex)[n];
+    fInputBinaryFile->clear();
+    fInputBinaryFile->seekg(e.offset + 2);
+    if (fInputBinaryFile->fail()) return 1;
+    fNextHeader = e.header == 0x80 ? 80 : e.header;
+    fEOF = 0;
+    return 0;
+}
+
+
+// ----------------------------------------------------------------------
+int UsbDaq::seekTime(long long t)
+{
+    if (fRunMode != 0 || openIndex()) return 1;
+    return seekRecord(fIndex->FindTime(t));
+}
+
+
 // ----------------------------------------------------------------------
 void UsbDaq::setBinaryBuffer(int size, unsigned char * p)
 {
@@ -478,7 +549,10 @@ void UsbDaq::stop()
 {
     fRunState = 3;
 
-    if (fInputBinaryFile) fInputBinaryFile->close();
+    delete fInputBinaryFile;
+    fInputBinaryFile = 0;
+    delete fIndex;
+    fIndex = 0;
     if (fpHistogrammer) fpHistogrammer->close();
 }
 
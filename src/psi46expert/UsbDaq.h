@@ -9,6 +9,8 @@
 #include "BasePixel/RawPacketDecoder.h"
 #include "psi46expert/histogrammer.h"
 
+class CMtbIndex;
+
 class UsbDaq {
 public:
     UsbDaq(int mode = 1);      // mode = 1: File input
@@ -35,6 +37,11 @@ public:
     int  nextBinaryHeader();                    // starting from present position, find next header
     int  decodeBinaryData();                    // called after header has been found => time and fData
 
+    // random access through the record index (<file>.idx, made on first use)
+    long long getRecordCount();                 // -1 without index
+    int  seekRecord(long long n);               // next readBinaryEvent() reads record n, 0 if ok
+    int  seekTime(long long t);                 // same for the first record at or after time t
+
     //  unsigned short readBinaryWord();            // read two chars and swap order
     unsigned short readBinaryWordFromFile();    // read two chars and swap order
 
@@ -89,7 +96,9 @@ private:
     int short  sData[DecodedReadoutConstants::MAX_PIXELSROC];
     char       fInputFileName[1000];
     FILE    *   fInputFile;
-    std::ifstream  * fInputBinaryFile;
+    std::istream   * fInputBinaryFile;
+    CMtbIndex      * fIndex;
+    int  openIndex();
 
     // -- Binary buffer input (when spying on TB memory)
     int            fBinaryBufferSize, fBinaryBufferCnt;
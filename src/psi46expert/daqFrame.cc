@@ -4,6 +4,8 @@
 #include <BasePixel/Keithley.h>
 
 #include "BasePixel/TBInterface.h"
+#include "BasePixel/DaqDrain.h"
+#include "psi46expert/OnlineMonitor.h"
 #include "BasePixel/ConfigParameters.h"
 #include "psi46expert/TestControlNetwork.h"
 
@@ -20,6 +22,7 @@
 #include <fstream>
 
 #include "interface/Log.h"
+#include "interface/MtbFile.h"
 
 #include "daqFrame.hh"
 
@@ -37,6 +40,8 @@ daqFrame::daqFrame(const TGWindow * p, UInt_t w, UInt_t h, daqLoggingManager * p
     fExternalTrigger = 1; //
     fMtbLogging      = 1;
     fFillMem         = 0;
+    fStreaming       = 0;
+    fMonitorFraction = 0.;
     fTemperature     = 0;
     fRunDuration     = 3600;
     fRunning         = 0;
@@ -132,6 +137,16 @@ daqFrame::daqFrame(const TGWindow * p, UInt_t w, UInt_t h, daqLoggingManager * p
     //   wFillMem->SetOn();
     wRunCtrl->AddFrame(wFillMem);
 
+    TGCheckButton * wStreaming = new TGCheckButton(wRunCtrl, "Stream", 70);
+    wStreaming->MoveResize(355, 130, 95, 15);
+    wStreaming->Connect("Clicked()", "daqFrame", this, "doStreaming()");
+    wRunCtrl->AddFrame(wStreaming);
+
+    TGCheckButton * wMonitor = new TGCheckButton(wRunCtrl, "Monitor", 70);
+    wMonitor->MoveResize(355, 160, 95, 15);
+    wMonitor->Connect("Clicked()", "daqFrame", this, "doMonitor()");
+    wRunCtrl->AddFrame(wMonitor);
+
 
     // -- Run Control Buttons
     TGTextButton * wStart = new TGTextButton(wRunCtrl, "Start");
@@ -655,8 +670,16 @@ void daqFrame::runStart() {
 
     int tbmc = fpLM->getMTBConfigParameters()->tbmChannel;
     fTB->Flush();
-    dataBuffer_fpga1 = fTB->getCTestboard()->Daq_Init(dataBuffer_numWords);
-    fTB->getCTestboard()->Daq_Enable();
+    if (fStreaming) {
+        // the board memory is only a FIFO, see streamRuns()
+        fTB->getCTestboard()->Daq_Open(dataBuffer_numWords);
+        fTB->getCTestboard()->Daq_Select_Deser160(fTB->getCTestboard()->deserAdjust);
+        fTB->getCTestboard()->Daq_Start();
+    }
+    else {
+        dataBuffer_fpga1 = fTB->getCTestboard()->Daq_Init(dataBuffer_numWords);
+        fTB->getCTestboard()->Daq_Enable();
+    }
     fTB->getCTestboard()->DataCtrl(tbmc, false, false, true); // go
     fTB->Flush();
 
@@ -707,16 +730,11 @@ void daqFrame::doStart() {
     for (int i = 0; i < fCN->GetModule(0)->NRocs(); i++) fCN->SetDAC(0, i, 27, 2); //Set TempReg DAC
     fTB->Flush();
 
-    FILE * f;
+    CMtbWriter * f = NULL;
 
     if (!fFillMem) {
-        f = fopen(Form("%s/mtb.bin", fpLM->getOutputDir()), "wb");
-        if (f == NULL) {
-            psi::LogInfo() << psi::endl
-                           << "Could not open file " << fpLM->getOutputDir()
-                           << "/mtb.bin" << psi::endl;
-            return;
-        }
+        f = openMtbFile(0, fStreaming ? MTB_DESER160 : MTB_RECORDS);
+        if (f == NULL) return;
     }
 
     //??  fRunDuration = atoi(fwDurationBuffer->GetString());
@@ -727,17 +745,14 @@ void daqFrame::doStart() {
         cout << " recording " << fRunDuration << " runs " << endl;
     }
 
-    for (int k = 0; k < nRuns; k++) {
+    if (fStreaming) streamRuns(f, nRuns);
+
+    for (int k = 0; k < nRuns && !fStreaming; k++) {
         if (fFillMem) {
             fpLM->setupRun();
             fpLM->dumpHardwareConfiguration(0, fCN, fTB);
-            f = fopen(Form("%s/mtb.bin", fpLM->getOutputDir()), "wb");
-            if (f == NULL) {
-                psi::LogInfo() << psi::endl
-                               << "Could not open file " << fpLM->getOutputDir()
-                               << "/mtb.bin" << psi::endl;
-                return;
-            }
+            f = openMtbFile();
+            if (f == NULL) return;
         }
 
         runStart();
@@ -754,7 +769,7 @@ void daqFrame::doStart() {
 	uint32_t oldFilledMem = 0; // remember previous state of filledMem to recognize a blocked state
         while (1) {
             if (fRunning == 0) break;
-            sleep(1);
+            idle(1000);
             seconds++;
 
 	  filledMem1 = fTB->getCTestboard()->Daq_GetPointer() - dataBuffer_fpga1;
@@ -877,37 +892,26 @@ void daqFrame::doStart() {
 
 	fpLM->log( Form( "==>daqf: read out Run %i", fpLM->getRunNumber() ) );
         if (fFillMem) {
-            fclose(f);
+            closeMtbFile(f);
             seconds = fpLM->incrementRunNumber();
 	}
 	else {
-
-	  int nextrunnumber = fpLM->incrementRunNumber();
-	  fRunTextBuffer->Clear();
-	  fRunTextBuffer->AddText(0, Form("%i", nextrunnumber));
-	  fwRunNumber->TextChanged();
-	  gClient->NeedRedraw(fwRunNumber);
-
-	  fwOutputDirBuffer->Clear();
-	  fwOutputDirBuffer->AddText(0, fpLM->getOutputDir());
-	  fwOutputDir->TextChanged();
-	  gClient->NeedRedraw(fwOutputDir);
-  
-	  doRefreshWindowTitle();
+	  showRunNumber(fpLM->incrementRunNumber());
         }
 
     }
 
     if (!fFillMem) {
-        fclose(f);
+        closeMtbFile(f);
     }
 
     stopTriggers();  // Disable triggers
 
-    fCanvas1->cd();
-    fCanvas1->Clear();
+    // the online monitor plots stay
     TH1 * h = fpDAQ->getHistogrammer()->getHistogram("h0");
-    if (h) {
+    if (h && !(fStreaming && fMonitorFraction > 0.)) {
+        fCanvas1->cd();
+        fCanvas1->Clear();
         h->Draw("e");
         TLatex * tl = new TLatex(); tl->SetNDC(kTRUE); tl->SetTextSize(0.15);
         double eff = h->GetBinContent(2) / h->GetBinContent(4);
@@ -923,6 +927,207 @@ void daqFrame::doStart() {
 }
 
 
+// ----------------------------------------------------------------------
+// Raw data go into a compressed container (interface/MtbFile.h), the
+// compression runs on a thread of the writer. fileName defaults to
+// mtb.bin in the output directory.
+CMtbWriter * daqFrame::openMtbFile(const char * fileName, int dataFormat) {
+
+    TString name = fileName ? TString(fileName) : Form("%s/mtb.bin", fpLM->getOutputDir());
+    CMtbHeader header;
+    header.runNumber = fpLM->getRunNumber();
+    header.nRocs = fCN->GetModule(0)->NRocs();
+    header.dataFormat = dataFormat;
+    header.boardId = fpLM->getMTBConfigParameters()->testboardName;
+
+    CMtbWriter * f = new CMtbWriter();
+    if (!f->Open(name.Data(), header)) {
+        psi::LogInfo() << psi::endl
+                       << "Could not open file " << name.Data() << psi::endl;
+        delete f;
+        return NULL;
+    }
+    return f;
+}
+
+
+// ----------------------------------------------------------------------
+void daqFrame::closeMtbFile(CMtbWriter * f) {
+
+    if (f == NULL) return;
+    if (!f->Close()) fpLM->log(" ERROR: writing the raw data file failed!");
+    else if (f->FileBytes() > 0)
+        fpLM->log(Form("==>daqf: raw data %llu bytes, on disk %llu bytes (%.1f:1)",
+                       (unsigned long long)f->RawBytes(), (unsigned long long)f->FileBytes(),
+                       (double)f->RawBytes() / f->FileBytes()));
+    delete f;
+}
+
+
+// ----------------------------------------------------------------------
+void daqFrame::showRunNumber(int run) {
+
+    fRunTextBuffer->Clear();
+    fRunTextBuffer->AddText(0, Form("%i", run));
+    fwRunNumber->TextChanged();
+    gClient->NeedRedraw(fwRunNumber);
+
+    fwOutputDirBuffer->Clear();
+    fwOutputDirBuffer->AddText(0, fpLM->getOutputDir());
+    fwOutputDir->TextChanged();
+    gClient->NeedRedraw(fwOutputDir);
+
+    doRefreshWindowTitle();
+}
+
+
+// ----------------------------------------------------------------------
+// Streaming readout: a CDaqDrain empties the DTB while the triggers run
+// and the samples go to mtb.bin as they arrive, so the run length is no
+// longer limited by the board memory. FillMem runs follow each other
+// without stopping the DAQ, a run ends at the first readout header after
+// dataBuffer_numWords samples. With fMonitorFraction > 0 an OnlineMonitor
+// decodes that fraction of the readouts on its own thread, the hit maps
+// and pulse heights are redrawn once per second.
+// The file holds the deser160 samples as read from the DAQ, not the records
+// of the board memory readout. Its header says so (MTB_DESER160), UsbDaq and
+// BinaryFileReader refuse it; DecodeReadouts (interface/analyzer.h) reads it.
+void daqFrame::streamRuns(CMtbWriter * f, int nRuns) {
+
+    static const size_t chunkSize = 1 << 20; // samples per write
+
+    CTestboard * tb = fTB->getCTestboard();
+    if (fFillMem) {
+        fpLM->setupRun();
+        fpLM->dumpHardwareConfiguration(0, fCN, fTB);
+        f = openMtbFile(0, MTB_DESER160);
+        if (f == NULL) return;
+    }
+
+    OnlineMonitor * monitor = 0;
+    if (fMonitorFraction > 0.) {
+        monitor = new OnlineMonitor(fMonitorFraction, 1000);
+        monitor->start();
+        drawMonitor(1);
+    }
+
+    runStart();
+    CDaqDrain drain(*tb);
+    drain.Start();
+
+    std::vector<uint16_t> data;
+    time_t startTime = time(0);
+    int seconds = 0, run = 0;
+    uint32_t runWords = 0, lastWords = 0;
+    bool overflowWarned = false;
+    bool failed = false;
+    CRpcError error;
+    while (fRunning) {
+        drain.WaitFor(chunkSize, 200);
+        try {
+            drain.Take(data);
+        }
+        catch (CRpcError & e) {
+            // the DAQ is stopped and the file finished below
+            error = e;
+            failed = true;
+            break;
+        }
+        if (monitor) monitor->offer(data, data.size());
+
+        size_t n = data.size();
+        if (fFillMem && runWords + n >= (uint32_t)dataBuffer_numWords) {
+            n = runWords < (uint32_t)dataBuffer_numWords ? dataBuffer_numWords - runWords : 0;
+            while (n < data.size() && !(data[n] & 0x8000)) n++;
+        }
+        if (n > 0) f->Write(&data[0], n * sizeof(uint16_t));
+        runWords += n;
+
+        if (n < data.size()) {
+            // next FillMem run, the DAQ keeps going
+            closeMtbFile(f);
+            f = NULL;
+            fpLM->log(Form("==>daqf: streamed Run %i, words = %lu", fpLM->getRunNumber(), (unsigned long)runWords));
+            fpLM->incrementRunNumber();
+            if (++run == nRuns) break;
+            fpLM->setupRun();
+            fpLM->dumpHardwareConfiguration(0, fCN, fTB);
+            f = openMtbFile(0, MTB_DESER160);
+            if (f == NULL) break;
+            f->Write(&data[n], (data.size() - n) * sizeof(uint16_t));
+            runWords = data.size() - n;
+            lastWords = 0;
+        }
+
+        if (time(0) - startTime > seconds) {
+            seconds = time(0) - startTime;
+            fpLM->log(Form("==>daqf: %4i: streamed %8lu  last sec %6lu",
+                           seconds, (unsigned long)runWords, (unsigned long)(runWords - lastWords)));
+            lastWords = runWords;
+            fwMemMtb->SetText(Form("%8i", runWords));
+        }
+        if (drain.Overflow() && !overflowWarned) {
+            fpLM->log(" ERROR: DTB DROPPED DATA, THE STREAM IS INCOMPLETE!");
+            std::cout << '\a';
+            overflowWarned = true;
+        }
+        if (monitor && monitor->publish(fpDAQ->getHistogrammer())) drawMonitor(0);
+        gSystem->ProcessEvents();
+
+        if (!fFillMem && seconds >= fRunDuration) break;
+    }
+
+    // Only the triggers are stopped here: doBreak() flushes and calls the
+    // legacy DAQ stubs, which must not run next to the drain. The DAQ is
+    // stopped and read to the end before anything else goes to the board.
+    fReg41 &= ~0x8;
+    fpLM->log(Form("==>daqf: MTB disable; writing reg41: %02x", fReg41));
+    data.clear();
+    try {
+        fTB->SetReg(41, fReg41);
+        tb->Daq_Stop();
+        drain.Stop();
+        drain.Take(data);
+        tb->Daq_Close();
+        tb->Flush();
+    }
+    catch (CRpcError & e) {
+        // what the drain has is lost, the file keeps what was written
+        if (!failed) error = e;
+        failed = true;
+        data.clear();
+    }
+    if (failed)
+        fpLM->log(Form(" ERROR: DTB READ FAILED (%s), Run %i stopped, the stream is incomplete",
+                       error.GetMsg(), fpLM->getRunNumber()));
+    else
+        fpLM->log(Form("==>daqf: Run %i stopped. OK", fpLM->getRunNumber()));
+
+    if (monitor) {
+        monitor->offer(data, data.size());
+        monitor->stop();
+        monitor->publish(fpDAQ->getHistogrammer(), true);
+        drawMonitor(0);
+        fpLM->log(Form("==>daqf: monitor decoded %llu of %llu readouts, %llu with errors, %llu of %llu chunks left out",
+                       (unsigned long long)monitor->getSampled(), (unsigned long long)monitor->getEvents(),
+                       (unsigned long long)monitor->getErrors(),
+                       (unsigned long long)monitor->getDropped(), (unsigned long long)monitor->getOffered()));
+        delete monitor;
+    }
+
+    if (f == NULL) return;
+    if (!data.empty()) f->Write(&data[0], data.size() * sizeof(uint16_t));
+    runWords += data.size();
+    fpLM->log(Form("==>daqf: streamed Run %i, words = %lu", fpLM->getRunNumber(), (unsigned long)runWords));
+    if (fFillMem) {
+        // stopped in the middle of a FillMem run
+        closeMtbFile(f);
+        fpLM->incrementRunNumber();
+    }
+    else showRunNumber(fpLM->incrementRunNumber());
+}
+
+
 // ----------------------------------------------------------------------
 void daqFrame::startTriggers() {
 
@@ -1014,11 +1219,19 @@ void daqFrame::doExit() {
 
 
 // ----------------------------------------------------------------------
-void daqFrame::readout(FILE * file, uint32_t filledMem1)
+static void readoutProgress(unsigned int done, unsigned int total, void * lm)
+{
+    ((daqLoggingManager *)lm)->log(Form("==>daqf: read mtb, %u of %u bytes", done, total));
+}
+
+
+// ----------------------------------------------------------------------
+void daqFrame::readout(CMtbWriter * file, uint32_t filledMem1)
 {
 
     fpLM->log(Form("==>daqf: read mtb, words = %d", filledMem1));
-    fTB->Mem_ReadOut(file, dataBuffer_fpga1, filledMem1);
+    if (!fTB->Mem_ReadOutAsync(*file, dataBuffer_fpga1, filledMem1, 50000, 4, readoutProgress, fpLM))
+        fpLM->log(" ERROR: writing the board memory to the raw data file failed!");
   fTB->getCTestboard()->DataCtrl( 0, true, false, false ); // clear FIFO
   fTB->Flush();
   fTB->getCTestboard()->DataCtrl( 0, false, false, false ); // clear FIFO
@@ -1082,6 +1295,54 @@ void daqFrame::doFillMem() {
 }
 
 
+// ----------------------------------------------------------------------
+void daqFrame::doStreaming() {
+    if (fStreaming == 0) fStreaming = 1;
+    else fStreaming = 0;
+    fpLM->log(Form("==>daqf: fStreaming set to  %i", fStreaming));
+}
+
+
+// ----------------------------------------------------------------------
+// the monitor needs the streamed data, see streamRuns()
+void daqFrame::doMonitor() {
+    if (fMonitorFraction > 0.) fMonitorFraction = 0.;
+    else fMonitorFraction = 0.1;
+    fpLM->log(Form("==>daqf: fMonitorFraction set to  %4.2f", fMonitorFraction));
+    if (fMonitorFraction > 0. && !fStreaming) fpLM->log("==>daqf: the monitor only runs with Stream");
+}
+
+
+// ----------------------------------------------------------------------
+// setup 1 splits the canvas for the module hit map and the pulse heights
+void daqFrame::drawMonitor(int setup) {
+
+    histogrammer * h = fpDAQ->getHistogrammer();
+    if (setup) {
+        fCanvas1->cd();
+        fCanvas1->Clear();
+        fCanvas1->Divide(1, 2);
+        fCanvas1->cd(1);
+        h->getHistogram("h300")->Draw("colz");
+        fCanvas1->cd(2);
+        h->getHistogram("h400")->Draw();
+    }
+    for (int i = 1; i <= 2; ++i) fCanvas1->GetPad(i)->Modified();
+    fCanvas1->Update();
+}
+
+
+// ----------------------------------------------------------------------
+// waits about ms milliseconds, the GUI stays responsive meanwhile
+void daqFrame::idle(int ms) {
+
+    for (int t = 0; t < ms; t += 50) {
+        gSystem->ProcessEvents();
+        gSystem->Sleep(ms - t < 50 ? ms - t : 50);
+    }
+}
+
+
 // ----------------------------------------------------------------------
 void daqFrame::doMeasureTemperature() {
     if (fTemperature == 0) fTemperature = 1;
@@ -1341,7 +1602,7 @@ void daqFrame::wbcScan() {
     for( int i = 0; i < fCN->GetModule(0)->NRocs(); i++) fCN->SetDAC(0, i, 27, 2); //Set TempReg DAC
                 fTB->Flush();
     gDelay->Mdelay(50);//milli secs
-    FILE *f;
+    CMtbWriter *f = NULL;
 
     if( !fFillMem) {
       	char fileName[200];
@@ -1349,13 +1610,8 @@ void daqFrame::wbcScan() {
 	psi::LogInfo() << "Opening File " << fpLM->getOutputDir()
 		       << "/" << fileName << psi::endl;
 	
-	f = fopen(fileName, "wb");
-      if( f == NULL) { 
-	psi::LogInfo() << psi::endl
-		       << "Could not open file " << fpLM->getOutputDir()
-		       << "/" << fileName << psi::endl;
-	return;
-            }
+	f = openMtbFile(fileName);
+      if( f == NULL) return;
         }
 
     int nRuns = 1;
@@ -1374,13 +1630,8 @@ void daqFrame::wbcScan() {
 	sprintf(fileName, "%s/scan_wbc_%03d.bin", fpLM->getOutputDir(), thiswbc);
 	psi::LogInfo() << "Opening " << fpLM->getOutputDir()
 		       << "/" << fileName << psi::endl;
-	f = fopen(fileName, "wb");
-	if( f == NULL) { 
-	  psi::LogInfo() << psi::endl
-			 << "Could not open file " << fpLM->getOutputDir()
-			 << "/" << fileName << psi::endl;
-	  return;
-	}
+	f = openMtbFile(fileName);
+	if( f == NULL) return;
       }
         runStart();  // This also starts triggers
 
@@ -1423,14 +1674,14 @@ void daqFrame::wbcScan() {
       readout( f, filledMem1 );
 
       if( fFillMem ) {
-	fclose(f);
+	closeMtbFile(f);
             }
         }
         //fTB->getCTestboard()->Daq_Done();
         //fTB->getCTestboard()->Daq_Disable();
 
     if( !fFillMem) {
-        fclose(f);
+        closeMtbFile(f);
     }
 
     stopTriggers();  // Disable triggers
@@ -32,6 +32,9 @@ typedef char int8_t;
 #include "BasePixel/GlobalConstants.h"
 #include <stdint.h>
 
+class CMtbWriter;
+class OnlineMonitor;
+
 
 class TBInterface;
 class TestControlNetwork;
@@ -56,6 +59,8 @@ public:
     void setRunDuration(int duration);
     void ApplyMaskFile(const char *fileName);
     void setFillMem(int i) {fFillMem = i;};
+    void setStreaming(int i) {fStreaming = i;};
+    void setMonitorFraction(double f) {fMonitorFraction = f;};
 
     void setUsbDAQ(UsbDaq * p) { fpDAQ = p;}
     void setLoggingManager(daqLoggingManager * p) { fpLM = p;}
@@ -73,7 +78,7 @@ public:
     void doExit();
 
     void doDraw();
-    void readout(FILE * file, uint32_t filledMem);
+    void readout(CMtbWriter * file, uint32_t filledMem);
 
     void doVdown(int V);
     void doVup(int V);
@@ -96,6 +101,8 @@ public:
     void doSetManualControlParameter();
     void doSetSysCommand1Text();
     void doFillMem();
+    void doStreaming();
+    void doMonitor();
     void doPON();
     void doPOFF();
     void doHVON();
@@ -142,7 +149,8 @@ private:
 
     TString              fTbParNames[256];
 
-    int                  fRunDuration, fFillMem;
+    int                  fRunDuration, fFillMem, fStreaming;
+    double               fMonitorFraction; // of the readouts histogrammed while streaming, 0 = off
     int                  fMtbLogging, fTemperature;
 
     int fReg21;
@@ -153,6 +161,15 @@ private:
     int vtrim[16], vthrcomp[16];
 
     const TGWindow * fpWindow;
+
+    // dataFormat: MTB_RECORDS (0) for board memory readouts, MTB_DESER160
+    // for the samples streamed from the DTB DAQ, see interface/MtbFile.h
+    CMtbWriter * openMtbFile(const char * fileName = 0, int dataFormat = 0);
+    void closeMtbFile(CMtbWriter * f);
+    void showRunNumber(int run);
+    void streamRuns(CMtbWriter * f, int nRuns);
+    void drawMonitor(int setup);
+    void idle(int ms);
 protected:
 	
     bool pixel[MODULENUMROCS][ROCNUMCOLS][ROCNUMROWS];
@@ -72,6 +72,21 @@ void histogrammer::init(const char * dirname) {
     h1 = new TH1D("h201", Form("%s roLength", dirname), 200, 0., 200.);
     lHistograms->AddLast(h1);
 
+    // -- online monitor
+    const int nRocs = DecodedReadoutConstants::NUM_ROCSMODULE;
+    TH2D * h2 = new TH2D("h300", Form("%s Hits", dirname), nRocs * 52, 0., nRocs * 52., 80, 0., 80.);
+    lHistograms->AddLast(h2);
+    for (int iroc = 0; iroc < nRocs; ++iroc) {
+        h2 = new TH2D(Form("h%d", 301 + iroc), Form("%s Hits ROC %d", dirname, iroc), 52, 0., 52., 80, 0., 80.);
+        lHistograms->AddLast(h2);
+    }
+    h1 = new TH1D("h400", Form("%s PH", dirname), 256, 0., 256.);
+    lHistograms->AddLast(h1);
+    for (int iroc = 0; iroc < nRocs; ++iroc) {
+        h1 = new TH1D(Form("h%d", 401 + iroc), Form("%s PH ROC %d", dirname, iroc), 256, 0., 256.);
+        lHistograms->AddLast(h1);
+    }
+
     fpCurrent = 0;
 
     fRootFile->cd();
@@ -212,6 +227,44 @@ void histogrammer::fillRawDataHistograms(int nRawData, int header) {
 }
 
 
+// ----------------------------------------------------------------------
+void histogrammer::fillHitHistograms(int nRocs, const unsigned int * hits, int nPH, const unsigned int * ph) {
+    const char * pwd = gDirectory->GetName();
+    fRootFile->cd(fDir.Data());
+
+    TH2D * hModule = (TH2D *)gDirectory->Get("h300");
+    TH1D * hPH = (TH1D *)gDirectory->Get("h400");
+    for (int iroc = 0; iroc < nRocs; ++iroc) {
+        TH2D * h2 = (TH2D *)gDirectory->Get(Form("h%d", 301 + iroc));
+        TH1D * h1 = (TH1D *)gDirectory->Get(Form("h%d", 401 + iroc));
+        if (!h2 || !h1) break;
+
+        const unsigned int * n = hits + iroc * 52 * 80;
+        for (int icol = 0; icol < 52; ++icol) {
+            for (int irow = 0; irow < 80; ++irow, ++n) {
+                if (*n == 0) continue;
+                h2->Fill(icol, irow, *n);
+                hModule->Fill(iroc * 52 + icol, irow, *n);
+            }
+        }
+
+        n = ph + iroc * nPH;
+        for (int i = 0; i < nPH; ++i) {
+            if (n[i] == 0) continue;
+            h1->Fill(i, n[i]);
+            hPH->Fill(i, n[i]);
+        }
+    }
+
+    // -- Move back to where you came from
+    if (!strcmp(pwd, fRootFile->GetName())) {
+        fRootFile->cd();
+    } else {
+        fRootFile->cd(pwd);
+    }
+}
+
+
 // ----------------------------------------------------------------------
 void histogrammer::fillPixelHistograms(int nPixel) {
     fRootFile->cd();
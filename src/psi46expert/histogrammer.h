@@ -32,6 +32,9 @@ public:
     void   reset();                                // Reset all histograms in list
     void   fillRawDataHistograms(int n, int header = -1); // fill  histograms on raw data structure
     void   fillPixelHistograms(int n);                    // fill  histograms on pixel structure
+    // add hit counts hits[roc][col][row] and pulse height counts ph[roc][nPH]
+    // to the hit maps (h300 module, h301.. per ROC) and pulse heights (h400, h401..)
+    void   fillHitHistograms(int nRocs, const unsigned int * hits, int nPH, const unsigned int * ph);
 
     TH1  * getNextHistogram();
     TH1  * getHistogram(const char * hist = "h0");
@@ -509,6 +509,7 @@ int main(int argc, char * argv[])
     else
         configParameters->SetLogFileName("log.txt");
     configParameters->SetDebugFileName("debug.log");
+    configParameters->SetRpcCallIdCacheFileName("rpcCallIds.dat");
 
     psi::LogInfo().setOutput(configParameters->GetLogFileName());
     psi::LogDebug().setOutput(configParameters->GetDebugFileName());
@@ -46,7 +46,8 @@ int main(int argc, char * argv[])
   sigemptyset(&act.sa_mask);
   act.sa_flags = 0;
   sigaction(SIGINT, &act, 0);
-    int mode(7), runnumber(0), localtrigger(0);
+    int mode(7), runnumber(0), localtrigger(0), streaming(0);
+  double monitorFraction = 0.;
   int secondBoard = 0;
   int duration = -1;
     bool batchMode = false, trimArg = false, dacArg = false, maskArg = false;
@@ -67,6 +68,11 @@ int main(int argc, char * argv[])
         if (!strcmp(argv[i], "-V")) V = atoi(argv[++i]);
         if (!strcmp(argv[i], "-numrocs")) numROCs = atoi(argv[++i]);
         if (!strcmp(argv[i], "-l")) localtrigger = 1;
+        if (!strcmp(argv[i], "-stream")) streaming = 1;
+        if (!strcmp(argv[i], "-monitor")) { // fraction of the readouts, implies -stream
+            monitorFraction = atof(argv[++i]);
+            streaming = 1;
+        }
 	if (!strcmp(argv[i],"-s")) secondBoard = 1;
         if (!strcmp(argv[i], "-m")) mode = atoi(argv[++i]);
 	if (!strcmp(argv[i],"-r")) runnumber = atoi(argv[++i]);
@@ -121,6 +127,8 @@ int main(int argc, char * argv[])
     if (localtrigger) dF->fLocalTrigger = 1;
     //  if(V>0)dF->doVup(V);
     if( duration > 0 ) dF->setRunDuration(duration);
+    if (streaming) dF->setStreaming(1);
+    if (monitorFraction > 0.) dF->setMonitorFraction(monitorFraction);
 
     if (batchMode) {
         dF->setFillMem(0);
@@ -0,0 +1,355 @@
+// psi46usbbench: throughput and latency of the link to the testboard
+//
+// Measures the round trip time of a small command, the rate of commands
+// that need no reply and the Daq_Read bandwidth for several block sizes.
+// The host side readout scan (interface/ReadoutScanner.h) is timed on a
+// generated buffer for each available implementation, "-scan" runs only
+// this part.
+// Works with the USB testboard (libftdi or ftd2xx build) as well as with
+// the emulator ("-t emulator") or a recorded session ("-t replay:<file>").
+//
+// Each result is one line of "name key=value ..." so that runs on
+// different hosts and library versions can be collected and compared:
+//
+//   info link=DTB_WRQ2J1 backend=libftdi fwVersion=0x0103 ...
+//   latency call=GetBoardId n=1000 min_us=92.1 p50_us=118.3 ...
+//   cmdrate call=roc_SetDAC burst=1000 n=50 cmd_per_s=1.9e+06 ...
+//   daqread blocksize=16384 samples=1000000 reads=123 MB_per_s=30.1 ...
+//   scan impl=avx2 samples=4000000 events=1000000 MB_per_s=5230.2 ...
+
+#include "BasePixel/pixel_dtb.h"
+#include "BasePixel/ConfigParameters.h"
+#include "interface/ReadoutScanner.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+static FILE * outFile = 0;
+
+static void Report(const char * format, ...) __attribute__((format(printf, 1, 2)));
+
+static void Report(const char * format, ...)
+{
+    char line[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    fputs(line, stdout);
+    if (outFile) fputs(line, outFile);
+}
+
+
+static double Percentile(const vector<double> & sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    unsigned int i = (unsigned int)(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+
+static double Microseconds(uint64_t t0, uint64_t t1) { return (t1 - t0) * 1e-3; }
+
+
+// round trip of a command with a two byte reply
+static void BenchLatency(CTestboard & tb, unsigned int n)
+{
+    vector<double> t(n);
+    double sum = 0;
+    tb.GetBoardId(); // warm up
+    for (unsigned int i = 0; i < n; i++)
+    {
+        uint64_t t0 = rpcProfiler::Now();
+        tb.GetBoardId();
+        t[i] = Microseconds(t0, rpcProfiler::Now());
+        sum += t[i];
+    }
+    sort(t.begin(), t.end());
+    Report("latency call=GetBoardId n=%u min_us=%.1f p50_us=%.1f p90_us=%.1f p99_us=%.1f max_us=%.1f mean_us=%.1f\n",
+           n, t[0], Percentile(t, 0.5), Percentile(t, 0.9), Percentile(t, 0.99), t[n - 1], sum / n);
+}
+
+
+// bursts of commands without reply, each burst ends with Flush. The
+// rate includes the execution on the board, a GetBoardId after the last
+// burst waits for it.
+static void BenchCommandRate(CTestboard & tb, unsigned int burst, unsigned int n)
+{
+    tb.roc_I2cAddr(0);
+    uint64_t tx = tb.GetIo().m_txBytes;
+    double flushSum = 0;
+    uint64_t t0 = rpcProfiler::Now();
+    for (unsigned int k = 0; k < n; k++)
+    {
+        for (unsigned int i = 0; i < burst; i++) tb.roc_SetDAC(Vcal, uint8_t(i));
+        uint64_t t1 = rpcProfiler::Now();
+        tb.Flush();
+        flushSum += Microseconds(t1, rpcProfiler::Now());
+    }
+    tb.GetBoardId();
+    double t = Microseconds(t0, rpcProfiler::Now()) * 1e-6;
+    double bytes = tb.GetIo().m_txBytes - tx;
+    Report("cmdrate call=roc_SetDAC burst=%u n=%u cmd_per_s=%.4g MB_per_s=%.3f flush_mean_us=%.1f\n",
+           burst, n, burst * double(n) / t, bytes / t * 1e-6, flushSum / n);
+}
+
+
+// fills the DAQ buffer of the board with triggered readouts of ROC 0,
+// returns the number of samples taken. The pattern generator loops a
+// reset, calibrate, trigger and token sequence, without the token a real
+// ROC doesn't read out. The sequence set before is loaded again.
+static uint32_t FillDaq(CTestboard & tb, uint32_t samples, unsigned int timeout)
+{
+    const vector<uint16_t> previous = tb.Pg_GetSequence();
+    uint16_t pg[] = { PG_RESR + 25, PG_CAL + 106, PG_TRG + 16, PG_TOK };
+    tb.Pg_SetSequence(vector<uint16_t>(pg, pg + 4));
+    uint16_t period = 25 + 106 + 16 + PG_BURSTSPACING; // the readout ends before the next reset
+
+    tb.Daq_Open(samples + samples / 4); // room for the triggers before Pg_Stop
+    tb.Daq_Select_Deser160(tb.deserAdjust);
+    tb.Daq_Start();
+    tb.Pg_Loop(period);
+    uint32_t size = 0;
+    for (unsigned int ms = 0; ms < timeout; ms += 10)
+    {
+        size = tb.Daq_GetSize();
+        if (size >= samples) break;
+        usleep(10000);
+    }
+    tb.Pg_Stop();
+    tb.Daq_Stop();
+    if (!previous.empty()) tb.Pg_SetSequence(previous);
+    return tb.Daq_GetSize();
+}
+
+
+static void BenchDaqRead(CTestboard & tb, uint16_t blockSize, uint32_t samples, unsigned int timeout)
+{
+    uint32_t filled = FillDaq(tb, samples, timeout);
+    if (filled == 0)
+    {
+        Report("daqread blocksize=%u samples=0 error=no_data\n", blockSize);
+        tb.Daq_Close();
+        return;
+    }
+
+    vector<uint16_t> data(filled + blockSize);
+    size_t size = 0;
+    uint32_t avail = 0;
+    unsigned int reads = 0;
+    uint8_t status = 0;
+    uint64_t t0 = rpcProfiler::Now();
+    do
+    {
+        status |= tb.Daq_ReadAppend(data, size, blockSize, avail);
+        reads++;
+    } while (avail > 0 && size < filled);
+    double t = Microseconds(t0, rpcProfiler::Now());
+    tb.Daq_Close();
+
+    Report("daqread blocksize=%u samples=%u reads=%u MB_per_s=%.3f us_per_read=%.1f status=%u\n",
+           blockSize, (unsigned int)size, reads, 2.0 * size / t, t / reads, status);
+}
+
+
+// readouts of one ROC with on average 1.5 hits, the hit words are random
+// but never look like a header
+static void MakeReadouts(vector<uint16_t> & data, uint32_t samples)
+{
+    uint64_t r = 88172645463325252ULL;
+    data.clear();
+    data.reserve(samples + 16);
+    while (data.size() < samples)
+    {
+        r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+        data.push_back(0x87f8 | (r & 3));
+        for (unsigned int h = (r >> 8) % 4; h > 0; h--)
+        {
+            r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+            for (unsigned int k = 0; k < 2; k++)
+            {
+                uint16_t w = (r >> (16 + 12 * k)) & 0xfff;
+                if ((w & 0x0ffc) == 0x07f8) w ^= 0x100;
+                data.push_back(w);
+            }
+        }
+    }
+}
+
+
+static void BenchScan(uint32_t samples)
+{
+    vector<uint16_t> data;
+    MakeReadouts(data, samples);
+    const unsigned int nRuns = 20;
+    ReadoutScanImpl impl[] = { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+    ReadoutIndex reference, index;
+    double scalarRate = 0;
+    for (unsigned int k = 0; k < sizeof(impl) / sizeof(impl[0]); k++)
+    {
+        if (!ReadoutScanAvailable(impl[k])) continue;
+        ScanReadouts(&data[0], data.size(), index, impl[k]); // warm up
+        double best = 1e30;
+        for (unsigned int i = 0; i < nRuns; i++)
+        {
+            uint64_t t0 = rpcProfiler::Now();
+            ScanReadouts(&data[0], data.size(), index, impl[k]);
+            best = min(best, Microseconds(t0, rpcProfiler::Now()));
+        }
+        if (impl[k] == SCAN_SCALAR) reference = index;
+        bool ok = index.event == reference.event && index.roc == reference.roc
+                  && index.eventRoc == reference.eventRoc;
+        double rate = 2.0 * data.size() / best;
+        if (impl[k] == SCAN_SCALAR) scalarRate = rate;
+        Report("scan impl=%s samples=%u events=%u rocs=%u MB_per_s=%.1f speedup=%.2f ok=%i\n",
+               ReadoutScanName(impl[k]), (unsigned int)data.size(), index.Events(),
+               (unsigned int)index.roc.size(), rate, rate / scalarRate, ok);
+    }
+}
+
+
+static void Info(const char * link, const char * backend, const char * more)
+{
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+    time_t now = time(0);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    Report("info date=%s host=%s link=%s backend=%s%s\n", date, host, link, backend, more);
+}
+
+
+static void Usage()
+{
+    printf("usage: psi46usbbench [-t testboard] [-dir config directory] [-o file]\n"
+           "                     [-n round trips] [-burst commands] [-bursts n]\n"
+           "                     [-blocks size,size,...] [-samples n] [-timeout ms]\n"
+           "  -t       testboard name, '*' to search (default), 'emulator[:...]'\n"
+           "           or 'replay:<session file>'\n"
+           "  -dir     take the testboard name and USB read queue settings\n"
+           "           from configParameters.dat in this directory\n"
+           "  -o       also append the results to this file\n"
+           "  -scan    only time the readout scan, no testboard needed\n");
+}
+
+
+int main(int argc, char * argv[])
+{
+    string tbName("*");
+    const char * outName = 0;
+    unsigned int nLatency = 1000, burst = 1000, nBursts = 50, timeout = 5000;
+    uint32_t samples = 1000000, scanSamples = 4000000;
+    bool scanOnly = false;
+    vector<uint16_t> blockSizes;
+    ConfigParameters * configParameters = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "-t") && more) tbName = argv[++i];
+        else if (!strcmp(argv[i], "-o") && more) outName = argv[++i];
+        else if (!strcmp(argv[i], "-n") && more) nLatency = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-burst") && more) burst = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-bursts") && more) nBursts = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-samples") && more) samples = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-timeout") && more) timeout = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-scan")) scanOnly = true;
+        else if (!strcmp(argv[i], "-blocks") && more)
+        {
+            for (char * s = strtok(argv[++i], ","); s; s = strtok(0, ","))
+                blockSizes.push_back(uint16_t(atoi(s)));
+        }
+        else if (!strcmp(argv[i], "-dir") && more)
+        {
+            configParameters = new ConfigParameters();
+            strcpy(configParameters->directory, argv[++i]);
+            string file = string(configParameters->directory) + "/configParameters.dat";
+            if (!configParameters->ReadConfigParameterFile(file.c_str())) return 1;
+            tbName = configParameters->testboardName;
+        }
+        else { Usage(); return 1; }
+    }
+    if (blockSizes.empty())
+    {
+        uint16_t defaultSizes[] = { 256, 1024, 4096, 16384, 32767, 65535 };
+        blockSizes.assign(defaultSizes, defaultSizes + sizeof(defaultSizes) / sizeof(defaultSizes[0]));
+    }
+    if (nLatency == 0) nLatency = 1;
+
+    if (outName && !(outFile = fopen(outName, "a")))
+    {
+        printf("could not open %s\n", outName);
+        return 1;
+    }
+    if (scanOnly)
+    {
+        Info("none", "none", "");
+        BenchScan(scanSamples);
+        if (outFile) fclose(outFile);
+        return 0;
+    }
+
+    CTestboard tb;
+    if (configParameters)
+        tb.SetUsbReadQueue(configParameters->usbReadTransfers, configParameters->usbReadTransferSize);
+    if (tbName == "*" && !tb.FindDTB(tbName)) return 1;
+    if (!tb.Open(tbName, false))
+    {
+        printf("could not open %s: %s\n", tbName.c_str(), tb.ConnectionError());
+        return 1;
+    }
+
+    try
+    {
+#ifdef HAVE_LIBFTDI
+        const char * backend = "libftdi";
+#else
+        const char * backend = "ftd2xx";
+#endif
+        if (tb.IsEmulated()) backend = "emulator";
+        if (tb.IsReplayed()) backend = "replay";
+
+        string hwVersion;
+        tb.GetHWVersion(hwVersion);
+        for (unsigned int i = 0; i < hwVersion.size(); i++) if (hwVersion[i] == ' ') hwVersion[i] = '_';
+        char versions[256];
+        snprintf(versions, sizeof(versions), " hw=%s fwVersion=0x%04X swVersion=0x%04X",
+                 hwVersion.c_str(), tb.GetFWVersion(), tb.GetSWVersion());
+        Info(tbName.c_str(), backend, versions);
+
+        tb.Init();
+        tb.Pon();
+        tb.Flush();
+        usleep(100000);
+
+        BenchLatency(tb, nLatency);
+        BenchCommandRate(tb, burst, nBursts);
+        for (unsigned int i = 0; i < blockSizes.size(); i++)
+            BenchDaqRead(tb, blockSizes[i], samples, timeout);
+
+        tb.Poff();
+        tb.Flush();
+        BenchScan(scanSamples);
+    }
+    catch (CRpcError & e)
+    {
+        e.What();
+        if (outFile) fclose(outFile);
+        tb.Close();
+        return 1;
+    }
+
+    if (outFile) fclose(outFile);
+    tb.Close();
+    return 0;
+}
@@ -121,6 +121,38 @@ void CDataType::WriteRecvDat(FILE *f)
 }
 
 
+// --- deferred call: output references are kept as pointers in the reply object
+
+void CDataType::WriteAsyncMember(FILE *f)
+{
+	if (!IsReturn() && (comp == REFERENCE || comp == VECTORR || comp == STRINGR))
+		fprintf(f, "		%s *rpc_par%u;\n", GetCTypeName(), id);
+}
+
+void CDataType::WriteAsyncInit(FILE *f)
+{
+	if (!IsReturn() && (comp == REFERENCE || comp == VECTORR || comp == STRINGR))
+		fprintf(f, "	rpc_reply->rpc_par%u = &rpc_par%u;\n", id, id);
+}
+
+void CDataType::WriteAsyncRecvPar(FILE *f)
+{
+	if (retByteCount)
+	{
+		if (IsReturn())
+			fprintf(f, "			value = msg.Get_%s();\n", GetTypeName());
+		else
+			fprintf(f, "			*rpc_par%u = msg.Get_%s();\n", id, GetTypeName());
+	}
+}
+
+void CDataType::WriteAsyncRecvDat(FILE *f)
+{
+	if (comp == VECTORR || comp == STRINGR)
+		fprintf(f, "			rpc_Receive(rpc_io, *rpc_par%u);\n", id);
+}
+
+
 void CDataType::WriteDtbSendPar(FILE *f)
 {
 	if (parByteCount)
@@ -205,6 +237,43 @@ void CParameterList::WriteCDeclaration(FILE *f, const char *fname)
 }
 
 
+const char* CParameterList::GetAsyncReplyType()
+{
+	if (begin()->type == CDataType::VOID) return "rpcDeferred";
+	asyncType = string("rpcReply<") + begin()->GetCTypeName() + ">";
+	return asyncType.c_str();
+}
+
+
+const char* CParameterList::GetAsyncFutureType()
+{
+	if (begin()->type == CDataType::VOID) return "rpcPending";
+	asyncType = string("rpcFuture<") + begin()->GetCTypeName() + ">";
+	return asyncType.c_str();
+}
+
+
+void CParameterList::WriteAsyncDeclaration(FILE *f, const char *fname, bool definition)
+{
+	unsigned int i;
+	parIterator p;
+	if (definition)
+		fprintf(f, "%s CTestboard::%s_Async(", GetAsyncFutureType(), fname);
+	else
+		fprintf(f, "	%s %s_Async(", GetAsyncFutureType(), fname);
+	for (p = begin(), i = 0; p != end(); p++, i++)
+	{
+		if (i == 0) continue;
+		if (i > 1) fputs(", ", f);
+		if (p->IsSimpleType())
+			fprintf(f, "%s rpc_par%u", p->GetCTypeName(), i);
+		else
+			fprintf(f, "%s &rpc_par%u", p->GetCTypeName(), i);
+	}
+	fputs(definition ? ")\n" : ");\n", f);
+}
+
+
 void CParameterList::WriteDtbFunctCall(FILE *f, const char *fname)
 {
 	unsigned int i;
@@ -252,6 +321,30 @@ void CParameterList::WriteAllRecvDat(FILE *f)
 }
 
 
+void CParameterList::WriteAllAsyncMember(FILE *f)
+{
+	for (parIterator p = begin(); p != end(); p++) p->WriteAsyncMember(f);
+}
+
+
+void CParameterList::WriteAllAsyncInit(FILE *f)
+{
+	for (parIterator p = begin(); p != end(); p++) p->WriteAsyncInit(f);
+}
+
+
+void CParameterList::WriteAllAsyncRecvPar(FILE *f)
+{
+	for (parIterator p = begin(); p != end(); p++) p->WriteAsyncRecvPar(f);
+}
+
+
+void CParameterList::WriteAllAsyncRecvDat(FILE *f)
+{
+	for (parIterator p = begin(); p != end(); p++) p->WriteAsyncRecvDat(f);
+}
+
+
 void CParameterList::WriteAllDtbSendPar(FILE *f)
 {
 	for (parIterator p = begin(); p != end(); p++) p->WriteDtbSendPar(f);
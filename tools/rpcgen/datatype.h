@@ -36,6 +36,11 @@ public:
 	void WriteRecvPar(FILE *f);
 	void WriteRecvDat(FILE *f);
 
+	void WriteAsyncMember(FILE *f);
+	void WriteAsyncInit(FILE *f);
+	void WriteAsyncRecvPar(FILE *f);
+	void WriteAsyncRecvDat(FILE *f);
+
 	void WriteDtbSendPar(FILE *f);
 	void WriteDtbSendDat(FILE *f);
 	void WriteDtbRecvPar(FILE *f);
@@ -65,6 +70,7 @@ class CParameterList
 	unsigned int retCount;
 	bool retValues;
 	list<CDataType> par;
+	string asyncType;
 public:
 	unsigned short GetTotalParBytes() { return parCount; }
 	unsigned short GetTotalRetBytes() { return retCount; }
@@ -75,6 +81,9 @@ public:
 	void Read(const char *s);
 
 	void WriteCDeclaration(FILE *f, const char *fname);
+	void WriteAsyncDeclaration(FILE *f, const char *fname, bool definition);
+	const char* GetAsyncReplyType();
+	const char* GetAsyncFutureType();
 	void WriteDtbFunctCall(FILE *f, const char *fname);
 
 	void WriteAllSendPar(FILE *f);
@@ -82,6 +91,11 @@ public:
 	void WriteAllRecvPar(FILE *f);
 	void WriteAllRecvDat(FILE *f);
 
+	void WriteAllAsyncMember(FILE *f);
+	void WriteAllAsyncInit(FILE *f);
+	void WriteAllAsyncRecvPar(FILE *f);
+	void WriteAllAsyncRecvDat(FILE *f);
+
 	void WriteAllDtbSendPar(FILE *f);
 	void WriteAllDtbSendDat(FILE *f);
 	void WriteAllDtbRecvPar(FILE *f);
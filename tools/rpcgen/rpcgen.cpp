@@ -170,7 +170,7 @@ void GenerateClientEntry(FILE *f, unsigned int cmd, const char *fname, const cha
 
 	plist.WriteCDeclaration(f, fname);
 	fprintf(f,
-		"{ RPC_PROFILING\n");
+		"{ RPC_PROFILING(%u, %s)\n", cmd, plist.HasRetValues() ? "true" : "false");
 	if (plist.begin()->HasRetValue())
 		fprintf(f, "\t%s rpc_par0;\n", plist.begin()->GetCTypeName());
 	fprintf(f,
@@ -188,7 +188,7 @@ void GenerateClientEntry(FILE *f, unsigned int cmd, const char *fname, const cha
 	if (plist.HasRetValues())
 	{
 		fprintf(f,
-			"\trpc_io->Flush();\n"
+			"\trpc_Sync();\n"
 			"\tmsg.Receive(*rpc_io);\n"
 			"\tmsg.Check(rpc_clientCallId,%u);\n",
 			plist.GetTotalRetBytes());
@@ -203,6 +203,68 @@ void GenerateClientEntry(FILE *f, unsigned int cmd, const char *fname, const cha
 }
 
 
+void GenerateClientAsyncEntry(FILE *f, unsigned int cmd, const char *fname, const char *parameter)
+{
+	// read parameter list
+	CParameterList plist;
+	plist.Read(parameter);
+	if (!plist.HasRetValues()) return;
+
+	plist.WriteAsyncDeclaration(f, fname, true);
+	fprintf(f, "{ RPC_PROFILING(%u, false)\n", cmd);
+
+	// reply object, filled in when the answer is read from the queue
+	fprintf(f,
+		"\tstruct rpc_Reply : public %s\n"
+		"\t{\n",
+		plist.GetAsyncReplyType());
+	plist.WriteAllAsyncMember(f);
+	fprintf(f,
+		"\t\tvoid Receive(CRpcIo &rpc_io)\n"
+		"\t\t{\n"
+		"\t\t\trpcMessage msg;\n"
+		"\t\t\tmsg.Receive(rpc_io);\n"
+		"\t\t\tmsg.Check(m_callId,%u);\n",
+		plist.GetTotalRetBytes());
+	plist.WriteAllAsyncRecvPar(f);
+	plist.WriteAllAsyncRecvDat(f);
+	fputs(
+		"\t\t}\n"
+		"\t} *rpc_reply = new rpc_Reply;\n", f);
+	plist.WriteAllAsyncInit(f);
+
+	// send the request without waiting for the answer
+	fprintf(f,
+		"\ttry {\n"
+		"\tuint16_t rpc_clientCallId = rpc_GetCallId(%u);\n"
+		"\tRPC_THREAD_LOCK\n"
+		"\trpcMessage msg;\n"
+		"\tmsg.Create(rpc_clientCallId);\n",
+		cmd
+	);
+	plist.WriteAllSendPar(f);
+	fputs("\tmsg.Send(*rpc_io);\n", f);
+	plist.WriteAllSendDat(f);
+	fprintf(f,
+		"\trpc_reply->m_callId = rpc_clientCallId;\n"
+		"\trpc_reply->m_functionId = %u;\n"
+		"\trpc_queue.Push(rpc_reply);\n"
+		"\tRPC_THREAD_UNLOCK\n"
+		"\t} catch (CRpcError &e) { delete rpc_reply; e.SetFunction(%u); throw; };\n"
+		"\treturn %s(rpc_reply, rpc_queue, *rpc_io);\n"
+		"}\n\n",
+		cmd, cmd, plist.GetAsyncFutureType());
+}
+
+
+void GenerateClientAsyncDecl(FILE *f, const char *fname, const char *parameter)
+{
+	CParameterList plist;
+	plist.Read(parameter);
+	if (plist.HasRetValues()) plist.WriteAsyncDeclaration(f, fname, false);
+}
+
+
 void GenerateClientCodeHeader(functList &fl, FILE *f)
 {
 	fprintf(f,
@@ -247,6 +309,7 @@ bool GenerateClientCode(functList &fl, FILE *f)
 			name = i->substr(0,found);
 			parameter = i->substr(found+1);
 			GenerateClientEntry(f, cmd, name.c_str(), parameter.c_str());
+			GenerateClientAsyncEntry(f, cmd, name.c_str(), parameter.c_str());
 			cmd++;
 		}
 	}
@@ -257,10 +320,40 @@ bool GenerateClientCode(functList &fl, FILE *f)
 
 
 
+bool GenerateClientAsyncHeader(functList &fl, FILE *f)
+{
+	string name;
+	string parameter;
+
+	fprintf(f,
+		"// Deferred RPC functions, included in the %s class declaration\n"
+		"// This is an auto generated file\n"
+		"// *** DO NOT EDIT THIS FILE ***\n\n",
+		className
+	);
+
+	try
+	{
+		list<string>::iterator i;
+		for (i = fl.begin(); i != fl.end(); i++)
+		{
+			unsigned int found = i->find_last_of('$');
+			name = i->substr(0,found);
+			parameter = i->substr(found+1);
+			GenerateClientAsyncDecl(f, name.c_str(), parameter.c_str());
+		}
+	}
+	catch(const char*e) { printf("ERROR: %s\n", e); }
+
+	return true;
+}
+
+
+
 void Help(const char *msg = 0)
 {
 	if (msg) printf("%s!\n", msg);
-	printf("rpcgen <source> -h<host rpc> -d<dtb rpc>");
+	printf("rpcgen <source> -h<host rpc> -a<host deferred rpc declarations> -d<dtb rpc>");
 }
 
 
@@ -269,9 +362,10 @@ int main(int argc, char* argv[])
 	char *srcFileName = 0;
 	char *dtbFileName = 0;
 	char *hstFileName = 0;
+	char *asyFileName = 0;
 
 	// --- read command line parameter --------------------------------------
-	if (argc < 2 || argc > 4) { Help("Wong number of arguments"); return 1; }
+	if (argc < 2 || argc > 5) { Help("Wong number of arguments"); return 1; }
 	srcFileName = argv[1];
 	if (srcFileName == 0) { Help(); return 1; }
 	for (int i=2; i<argc; i++)
@@ -281,6 +375,7 @@ int main(int argc, char* argv[])
 		{
 			case 'd': dtbFileName = &(argv[i][2]); break;
 			case 'h': hstFileName = &(argv[i][2]); break;
+			case 'a': asyFileName = &(argv[i][2]); break;
 			default: Help("Wong argument opti"); return 1;
 		}
 	}
@@ -331,6 +426,15 @@ int main(int argc, char* argv[])
 		fclose(f);
 	}
 
+	// declarations of the deferred host functions
+	if (asyFileName)
+	{
+		f = fopen(asyFileName, "wt");
+		if (!f) { printf("ERROR: could not create deferred declarations file\n"); return 3; }
+		GenerateClientAsyncHeader(cmdList, f);
+		fclose(f);
+	}
+
 	//	system("pause");
 	return 0;
 }